@@ -0,0 +1,273 @@
+#pragma once
+#include<iostream>
+#include <stdexcept>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "perf_counters.hpp"
+
+// 微基准测试框架
+// 每个用例先执行 warmup 次预热（不计入结果），再执行 repetitions 次测量。
+// 一次测量 = 运行 batch 遍 “setup() 建立夹具 -> body(夹具)”，只对 body 计时，
+// batch 按 ops 自动放大，使每次测量至少覆盖 min_ops 次操作，小规模用例也不至于只测到计时器噪声。
+// 每次测量得到一个 “纳秒/操作” 样本，汇总为 min / median / mean / stddev / p90 / max。
+// 结果逐行打印为文本，并可写成 JSON 文件：
+//     bench_runner runner(options);
+//     runner.run(bench_case{"push_back", "vector", 16, n}, n, setup, body);
+//     runner.write_json("out.json");
+// options.counters 打开时，另用 perf_counters 统计测量阶段 body 内的硬件事件，
+// 按 “事件数/操作” 附在结果后面；计数器不可用时在 stderr 提示一次，其余照常。
+
+struct bench_options
+{
+    size_t warmup = 1;
+    size_t repetitions = 5;
+    size_t min_ops = 100000;        //每次测量至少覆盖的操作数
+    std::string filter;             //只运行名称中包含该子串的用例（匹配 “容器/用例”）
+    bool counters = false;          //采集硬件性能计数器
+};
+
+//用例描述
+struct bench_case
+{
+    std::string name;          //操作，如 push_back
+    std::string container;     //容器，如 vector、std::deque
+    size_t elem_size;          //元素字节数
+    size_t n;                  //容器规模
+};
+
+struct bench_summary
+{
+    double min = 0;
+    double median = 0;
+    double mean = 0;
+    double stddev = 0;
+    double p90 = 0;
+    double max = 0;
+};
+
+struct bench_result
+{
+    bench_case info;
+    size_t ops = 0;             //每遍的操作数
+    size_t batch = 0;           //每次测量运行的遍数
+    std::vector<double> samples;   //纳秒/操作
+    bench_summary ns_per_op;
+    std::vector<std::string> counter_names;   //可用的硬件事件
+    std::vector<double> counters_per_op;      //与 counter_names 对应，所有测量合计后的 事件数/操作
+};
+
+//阻止编译器把结果当作无用代码删掉
+template <class T>
+inline void do_not_optimize(const T& value)
+{
+#if defined(__GNUC__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const T* sink;
+    sink = &value;
+#endif
+}
+
+inline void clobber_memory()
+{
+#if defined(__GNUC__)
+    asm volatile("" : : : "memory");
+#endif
+}
+
+class bench_runner
+{
+private:
+    bench_options m_options;
+    std::vector<bench_result> m_results;
+    perf_counters m_counters;
+
+public:
+    explicit bench_runner(const bench_options& options);
+
+    bool selected(const bench_case& c) const;
+
+    //ops：body 每执行一遍完成的操作数；setup() 返回夹具，body(夹具&) 是被测代码
+    //max_batch：单遍很慢的用例（如大容器的头部插入）用它限制每次测量的遍数
+    template <class Setup, class Body>
+    void run(const bench_case& c, size_t ops, Setup setup, Body body, size_t max_batch = size_t(-1));
+
+    const std::vector<bench_result>& results() const { return m_results; }
+
+    //输出
+    static void print_header(std::ostream& os);
+    static void print_result(std::ostream& os, const bench_result& r);
+    void write_json(std::ostream& os) const;
+    void write_json(const std::string& path) const;
+
+    static bench_summary summarize(std::vector<double> samples);
+};
+
+
+inline bench_runner::bench_runner(const bench_options& options) : m_options(options)
+{
+    if (m_options.counters && m_counters.open() == 0) {
+        std::cerr << "bench: hardware counters unavailable (perf_event_open failed, "
+                  << "check /proc/sys/kernel/perf_event_paranoid); timing only" << std::endl;
+    }
+}
+
+inline bool bench_runner::selected(const bench_case& c) const
+{
+    if (m_options.filter.empty()) {
+        return true;
+    }
+    return (c.container + "/" + c.name).find(m_options.filter) != std::string::npos;
+}
+
+template <class Setup, class Body>
+void bench_runner::run(const bench_case& c, size_t ops, Setup setup, Body body, size_t max_batch)
+{
+    if (!selected(c)) {
+        return;
+    }
+    if (ops == 0) {
+        throw std::invalid_argument("bench_runner::run: ops must be positive");
+    }
+
+    bench_result result;
+    result.info = c;
+    result.ops = ops;
+    result.batch = std::max<size_t>(1, std::min(m_options.min_ops / ops, max_batch));
+
+    //计数器只在测量阶段读取，预热不计入
+    const bool counting = m_counters.available();
+    uint64_t before[perf_counters::EVENT_COUNT];
+    uint64_t after[perf_counters::EVENT_COUNT];
+    double totals[perf_counters::EVENT_COUNT] = {};
+
+    for (size_t rep = 0; rep < m_options.warmup + m_options.repetitions; ++rep) {
+        const bool measured = rep >= m_options.warmup;
+        std::chrono::steady_clock::duration elapsed{0};
+        for (size_t b = 0; b < result.batch; ++b) {
+            auto fixture = setup();
+            clobber_memory();
+            if (counting && measured) {
+                m_counters.read(before);
+            }
+            auto start = std::chrono::steady_clock::now();
+            body(fixture);
+            clobber_memory();
+            elapsed += std::chrono::steady_clock::now() - start;
+            if (counting && measured) {
+                m_counters.read(after);
+                for (size_t e = 0; e < perf_counters::EVENT_COUNT; ++e) {
+                    totals[e] += double(after[e] - before[e]);
+                }
+            }
+        }
+        if (measured) {
+            double ns = std::chrono::duration<double, std::nano>(elapsed).count();
+            result.samples.push_back(ns / double(result.batch * ops));
+        }
+    }
+
+    result.ns_per_op = summarize(result.samples);
+    if (counting && m_options.repetitions > 0) {
+        double total_ops = double(m_options.repetitions * result.batch * ops);
+        for (size_t e = 0; e < perf_counters::EVENT_COUNT; ++e) {
+            if (m_counters.available(e)) {
+                result.counter_names.push_back(perf_counters::name(e));
+                result.counters_per_op.push_back(totals[e] / total_ops);
+            }
+        }
+    }
+    print_result(std::cout, result);
+    m_results.push_back(result);
+}
+
+inline bench_summary bench_runner::summarize(std::vector<double> samples)
+{
+    bench_summary s;
+    if (samples.empty()) {
+        return s;
+    }
+    std::sort(samples.begin(), samples.end());
+    size_t n = samples.size();
+    s.min = samples.front();
+    s.max = samples.back();
+    s.median = (n % 2 == 1) ? samples[n / 2] : (samples[n / 2 - 1] + samples[n / 2]) / 2;
+    double sum = 0;
+    for (double v : samples) {
+        sum += v;
+    }
+    s.mean = sum / double(n);
+    double sq = 0;
+    for (double v : samples) {
+        sq += (v - s.mean) * (v - s.mean);
+    }
+    s.stddev = n > 1 ? std::sqrt(sq / double(n - 1)) : 0;
+    //最近秩法
+    size_t rank = static_cast<size_t>(std::ceil(0.9 * double(n)));
+    s.p90 = samples[std::max<size_t>(rank, 1) - 1];
+    return s;
+}
+
+inline void bench_runner::print_header(std::ostream& os)
+{
+    os << "container\toperation\telem\tn\tmedian(ns/op)\tmin\tp90\tstddev" << std::endl;
+}
+
+inline void bench_runner::print_result(std::ostream& os, const bench_result& r)
+{
+    os << r.info.container << "\t" << r.info.name << "\t" << r.info.elem_size << "\t" << r.info.n
+       << "\t" << r.ns_per_op.median << "\t" << r.ns_per_op.min << "\t" << r.ns_per_op.p90
+       << "\t" << r.ns_per_op.stddev;
+    for (size_t e = 0; e < r.counter_names.size(); ++e) {
+        os << "\t" << r.counter_names[e] << "=" << r.counters_per_op[e];
+    }
+    os << std::endl;
+}
+
+inline void bench_runner::write_json(std::ostream& os) const
+{
+    os << "{\n  \"config\": {\"warmup\": " << m_options.warmup
+       << ", \"repetitions\": " << m_options.repetitions
+       << ", \"min_ops\": " << m_options.min_ops << "},\n  \"benchmarks\": [";
+    for (size_t i = 0; i < m_results.size(); ++i) {
+        const bench_result& r = m_results[i];
+        os << (i == 0 ? "\n" : ",\n")
+           << "    {\"name\": \"" << r.info.name << "\", \"container\": \"" << r.info.container
+           << "\", \"elem_size\": " << r.info.elem_size << ", \"n\": " << r.info.n
+           << ", \"ops\": " << r.ops << ", \"batch\": " << r.batch
+           << ", \"ns_per_op\": {\"min\": " << r.ns_per_op.min
+           << ", \"median\": " << r.ns_per_op.median
+           << ", \"mean\": " << r.ns_per_op.mean
+           << ", \"stddev\": " << r.ns_per_op.stddev
+           << ", \"p90\": " << r.ns_per_op.p90
+           << ", \"max\": " << r.ns_per_op.max << "}, \"samples\": [";
+        for (size_t k = 0; k < r.samples.size(); ++k) {
+            os << (k == 0 ? "" : ", ") << r.samples[k];
+        }
+        os << "]";
+        if (!r.counter_names.empty()) {
+            os << ", \"counters_per_op\": {";
+            for (size_t e = 0; e < r.counter_names.size(); ++e) {
+                os << (e == 0 ? "" : ", ") << "\"" << r.counter_names[e] << "\": " << r.counters_per_op[e];
+            }
+            os << "}";
+        }
+        os << "}";
+    }
+    os << "\n  ]\n}\n";
+}
+
+inline void bench_runner::write_json(const std::string& path) const
+{
+    std::ofstream out(path.c_str());
+    if (!out) {
+        throw std::runtime_error("bench_runner::write_json: cannot open " + path);
+    }
+    write_json(out);
+}
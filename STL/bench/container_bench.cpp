@@ -0,0 +1,281 @@
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include <deque>
+#include "vector.hpp"
+#include "deque.hpp"
+#include "bench_harness.hpp"
+
+// vector / deque 与 std::vector / std::deque 的对比基准
+// 操作：push/pop（两端）、随机访问、顺序遍历、头/中/尾插入删除、拷贝构造、拷贝赋值
+// 元素大小 4 B ~ 1 KB，容器规模 1K ~ 100M；n * 元素大小超过 --max-bytes 的组合会跳过。
+// 用法：bench [--reps N] [--warmup N] [--min-ops N] [--filter 子串] [--json 文件]
+//             [--max-bytes 字节数] [--sizes 1000,1000000] [--elems 4,64] [--counters]
+// --counters 额外输出每操作的 cycles / instructions / 缓存、分支、dTLB 缺失（需要 perf_event_open 权限）。
+// 完整矩阵耗时较长，日常对比建议配合 --sizes / --elems / --filter 缩小范围。
+
+template <size_t N>
+struct blob
+{
+    unsigned char bytes[N];
+};
+
+template <size_t N>
+static blob<N> make_blob(size_t seed)
+{
+    blob<N> b;
+    std::memset(b.bytes, int(seed & 0xff), N);
+    return b;
+}
+
+//容器名称，以及是否参与头部操作
+template <class C> struct container_traits;
+
+template <class T> struct container_traits<vector<T> >
+{
+    static const char* name() { return "vector"; }
+    static const bool FRONT_OPS = false;
+};
+template <class T> struct container_traits<deque<T> >
+{
+    static const char* name() { return "deque"; }
+    static const bool FRONT_OPS = true;
+};
+template <class T> struct container_traits<std::vector<T> >
+{
+    static const char* name() { return "std::vector"; }
+    static const bool FRONT_OPS = false;
+};
+template <class T> struct container_traits<std::deque<T> >
+{
+    static const char* name() { return "std::deque"; }
+    static const bool FRONT_OPS = true;
+};
+
+template <class C, class T>
+static std::unique_ptr<C> make_filled(size_t n, size_t seed)
+{
+    std::unique_ptr<C> c(new C());
+    for (size_t i = 0; i < n; ++i) {
+        c->push_back(make_blob<sizeof(T)>(seed + i));
+    }
+    return c;
+}
+
+//插入删除位置
+enum where { AT_FRONT, AT_MIDDLE, AT_BACK };
+
+template <class C>
+static size_t position_of(const C& c, where w)
+{
+    return w == AT_FRONT ? 0 : (w == AT_MIDDLE ? c.size() / 2 : c.size());
+}
+
+//拷贝用例的夹具：源容器共享，结果放在夹具里，析构发生在计时之外
+template <class C>
+struct copy_fixture
+{
+    const C* src;
+    std::unique_ptr<C> dst;
+};
+
+template <class C, class T>
+static void bench_front(bench_runner& runner, size_t n, const T& proto)
+{
+    typedef container_traits<C> traits;
+    runner.run(bench_case{"push_front", traits::name(), sizeof(T), n}, n,
+               []() { return std::unique_ptr<C>(new C()); },
+               [&](std::unique_ptr<C>& c) {
+        for (size_t i = 0; i < n; ++i) {
+            c->push_front(proto);
+        }
+    });
+    runner.run(bench_case{"pop_front", traits::name(), sizeof(T), n}, n,
+               [n]() { return make_filled<C, T>(n, 0); },
+               [n](std::unique_ptr<C>& c) {
+        for (size_t i = 0; i < n; ++i) {
+            c->pop_front();
+        }
+    });
+}
+
+template <class C, class T>
+static void bench_container(bench_runner& runner, size_t n, const std::vector<size_t>& indices)
+{
+    typedef container_traits<C> traits;
+    const size_t elem = sizeof(T);
+    const T proto = make_blob<sizeof(T)>(7);
+    auto make_case = [&](const char* op) { return bench_case{op, traits::name(), elem, n}; };
+    auto empty = []() { return std::unique_ptr<C>(new C()); };
+    auto filled = [n]() { return make_filled<C, T>(n, 0); };
+
+    //两端增删
+    runner.run(make_case("push_back"), n, empty, [&](std::unique_ptr<C>& c) {
+        for (size_t i = 0; i < n; ++i) {
+            c->push_back(proto);
+        }
+    });
+    runner.run(make_case("pop_back"), n, filled, [n](std::unique_ptr<C>& c) {
+        for (size_t i = 0; i < n; ++i) {
+            c->pop_back();
+        }
+    });
+    if constexpr (traits::FRONT_OPS) {
+        bench_front<C, T>(runner, n, proto);
+    }
+
+    //只读用例共享同一个容器
+    std::unique_ptr<C> shared = make_filled<C, T>(n, 0);
+    C* shared_ptr = shared.get();
+    auto use_shared = [shared_ptr]() { return shared_ptr; };
+
+    runner.run(make_case("random_access"), indices.size(), use_shared, [&indices](C*& c) {
+        size_t sum = 0;
+        for (size_t i = 0; i < indices.size(); ++i) {
+            sum += (*c)[indices[i]].bytes[0];
+        }
+        do_not_optimize(sum);
+    });
+    runner.run(make_case("iterate"), n, use_shared, [](C*& c) {
+        size_t sum = 0;
+        for (auto it = c->begin(); it != c->end(); ++it) {
+            sum += (*it).bytes[0];
+        }
+        do_not_optimize(sum);
+    });
+
+    //插入删除：每遍在新建的 n 元素容器上做 k 次。大容器上头部/中部插入是 O(n) 的，
+    //所以 k 和每次测量的遍数都随 n 缩小
+    const size_t k = std::max<size_t>(1, std::min<size_t>(std::min<size_t>(n, 1000), (size_t(1) << 26) / n));
+    const size_t max_batch = std::max<size_t>(1, (size_t(1) << 26) / (n * k));
+    const char* insert_names[] = {"insert_front", "insert_middle", "insert_back"};
+    const char* erase_names[] = {"erase_front", "erase_middle", "erase_back"};
+    for (int w = AT_FRONT; w <= AT_BACK; ++w) {
+        runner.run(make_case(insert_names[w]), k, filled, [&](std::unique_ptr<C>& c) {
+            for (size_t i = 0; i < k; ++i) {
+                c->insert(c->begin() + position_of(*c, where(w)), proto);
+            }
+        }, max_batch);
+        runner.run(make_case(erase_names[w]), k, filled, [&](std::unique_ptr<C>& c) {
+            for (size_t i = 0; i < k; ++i) {
+                size_t pos = std::min(position_of(*c, where(w)), c->size() - 1);
+                c->erase(c->begin() + pos);
+            }
+        }, max_batch);
+    }
+
+    //拷贝构造和拷贝赋值
+    runner.run(make_case("copy"), n, [shared_ptr]() {
+        return copy_fixture<C>{shared_ptr, std::unique_ptr<C>()};
+    }, [](copy_fixture<C>& f) {
+        f.dst.reset(new C(*f.src));
+    });
+    runner.run(make_case("assign"), n, [shared_ptr, n]() {
+        return copy_fixture<C>{shared_ptr, make_filled<C, T>(n, 1)};
+    }, [](copy_fixture<C>& f) {
+        *f.dst = *f.src;
+    });
+}
+
+template <size_t ELEM>
+static void bench_element_size(bench_runner& runner, size_t n)
+{
+    typedef blob<ELEM> T;
+    //随机下标最多 1M 个，避免 100M 规模时下标数组本身比容器还大
+    std::vector<size_t> indices(std::min<size_t>(n, size_t(1) << 20));
+    std::mt19937_64 rng(42);
+    for (size_t& i : indices) {
+        i = static_cast<size_t>(rng() % n);
+    }
+    bench_container<vector<T>, T>(runner, n, indices);
+    bench_container<std::vector<T>, T>(runner, n, indices);
+    bench_container<deque<T>, T>(runner, n, indices);
+    bench_container<std::deque<T>, T>(runner, n, indices);
+}
+
+static std::vector<size_t> parse_list(const char* text)
+{
+    std::vector<size_t> values;
+    const char* p = text;
+    while (*p) {
+        char* end = nullptr;
+        values.push_back(std::strtoull(p, &end, 10));
+        if (end == p) {
+            throw std::invalid_argument(std::string("bad list: ") + text);
+        }
+        p = (*end == ',') ? end + 1 : end;
+    }
+    return values;
+}
+
+int main(int argc, char** argv)
+{
+    bench_options options;
+    std::string json_path;
+    size_t max_bytes = size_t(256) << 20;
+    std::vector<size_t> sizes = {1000, 10000, 100000, 1000000, 10000000, 100000000};
+    std::vector<size_t> elems = {4, 16, 64, 256, 1024};
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--counters") {
+            options.counters = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            std::cerr << "missing value for " << arg << std::endl;
+            return 1;
+        }
+        const char* value = argv[++i];
+        if (arg == "--reps") {
+            options.repetitions = std::strtoull(value, nullptr, 10);
+        } else if (arg == "--warmup") {
+            options.warmup = std::strtoull(value, nullptr, 10);
+        } else if (arg == "--min-ops") {
+            options.min_ops = std::strtoull(value, nullptr, 10);
+        } else if (arg == "--filter") {
+            options.filter = value;
+        } else if (arg == "--json") {
+            json_path = value;
+        } else if (arg == "--max-bytes") {
+            max_bytes = std::strtoull(value, nullptr, 10);
+        } else if (arg == "--sizes") {
+            sizes = parse_list(value);
+        } else if (arg == "--elems") {
+            elems = parse_list(value);
+        } else {
+            std::cerr << "unknown option " << arg << std::endl;
+            return 1;
+        }
+    }
+
+    bench_runner runner(options);
+    bench_runner::print_header(std::cout);
+    for (size_t elem : elems) {
+        for (size_t n : sizes) {
+            if (n == 0 || n * elem > max_bytes) {
+                continue;
+            }
+            switch (elem) {
+            case 4:    bench_element_size<4>(runner, n); break;
+            case 16:   bench_element_size<16>(runner, n); break;
+            case 64:   bench_element_size<64>(runner, n); break;
+            case 256:  bench_element_size<256>(runner, n); break;
+            case 1024: bench_element_size<1024>(runner, n); break;
+            default:
+                std::cerr << "unsupported element size " << elem << " (use 4/16/64/256/1024)" << std::endl;
+                return 1;
+            }
+        }
+    }
+
+    if (!json_path.empty()) {
+        runner.write_json(json_path);
+    }
+    return 0;
+}
@@ -0,0 +1,140 @@
+#include <iostream>
+#include <chrono>
+#include <cstdlib>
+#include <cstdint>
+#include <random>
+#include <vector>
+#include "deque.hpp"
+#include "perf_counters.hpp"
+
+// deque 软件预取的效果：在远大于 LLC 的 deque 上做顺序扫描（每个元素只做一次加法），
+// 对比迭代器（编译期距离 STL_PREFETCH_BLOCKS）以及 for_each / for_each_reverse 在不同预取距离下的耗时。
+// 构造时每写满一块就穿插一次随机大小的分配，让块在堆上分散开，接近长期运行后的内存布局；
+// 每种扫描前先顺序写一遍 4 倍 LLC 大小的缓冲区，把缓存里的数据冲掉。
+// 能打开硬件计数器时同时给出每个元素的 LLC 缺失和 dTLB 缺失。
+// 用法：deque_prefetch_bench [deque 大小 MB] [LLC 大小 MB] [重复次数]
+
+typedef uint64_t elem_t;
+static const size_t BLOCK_ELEMS = 512;   //与 deque 的块大小一致
+
+struct scan_stats
+{
+    double ns;
+    double llc;
+    double dtlb;
+};
+
+static std::vector<char> g_flush;
+
+static void flush_caches()
+{
+    for (size_t i = 0; i < g_flush.size(); i += 64) {
+        g_flush[i] = static_cast<char>(g_flush[i] + 1);
+    }
+}
+
+//重复 reps 次取最快的一次
+template <class Scan>
+static scan_stats measure(perf_counters& counters, size_t n, size_t reps, Scan scan)
+{
+    scan_stats best = {0, 0, 0};
+    for (size_t r = 0; r < reps; ++r) {
+        flush_caches();
+        uint64_t before[perf_counters::EVENT_COUNT];
+        uint64_t after[perf_counters::EVENT_COUNT];
+        counters.read(before);
+        auto t0 = std::chrono::steady_clock::now();
+        uint64_t sum = scan();
+        auto t1 = std::chrono::steady_clock::now();
+        counters.read(after);
+        if (sum != uint64_t(n) * (n - 1) / 2) {
+            std::cerr << "checksum mismatch" << std::endl;
+            std::exit(1);
+        }
+        double ns = std::chrono::duration<double, std::nano>(t1 - t0).count() / double(n);
+        if (r == 0 || ns < best.ns) {
+            best.ns = ns;
+            best.llc = double(after[3] - before[3]) / double(n);
+            best.dtlb = double(after[5] - before[5]) / double(n);
+        }
+    }
+    return best;
+}
+
+static void print(const char* name, const scan_stats& s, bool with_counters)
+{
+    std::cout << name << "\t" << s.ns;
+    if (with_counters) {
+        std::cout << "\t\t" << s.llc << "\t\t" << s.dtlb;
+    }
+    std::cout << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+    size_t megabytes = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 512;
+    size_t llc_megabytes = (argc > 2) ? std::strtoull(argv[2], nullptr, 10) : 32;
+    size_t reps = (argc > 3) ? std::strtoull(argv[3], nullptr, 10) : 3;
+    size_t n = (megabytes << 20) / sizeof(elem_t);
+    if (n == 0 || reps == 0) {
+        return 1;
+    }
+    g_flush.assign((llc_megabytes << 20) * 4, 0);
+
+    deque<elem_t> d;
+    {
+        std::mt19937 rng(42);
+        std::vector<void*> holes;
+        for (size_t i = 0; i < n; ++i) {
+            if (i % BLOCK_ELEMS == 0) {
+                holes.push_back(std::malloc(rng() % 8192 + 16));
+            }
+            d.push_back(elem_t(i));
+        }
+        for (void* p : holes) {
+            std::free(p);
+        }
+    }
+
+    perf_counters counters;
+    bool with_counters = counters.open() > 0 && counters.available(3) && counters.available(5);
+
+    std::cout << "deque: " << megabytes << " MB (" << n << " elements), cache flush: "
+              << (g_flush.size() >> 20) << " MB, iterator prefetch distance: " << STL_PREFETCH_BLOCKS
+              << " blocks" << std::endl;
+    std::cout << "scan\t\t\tns/elem" << (with_counters ? "\t\tLLC miss/elem\tdTLB miss/elem" : "") << std::endl;
+
+    print("iterator ++\t", measure(counters, n, reps, [&d]() {
+        uint64_t sum = 0;
+        for (deque<elem_t>::iterator it = d.begin(); it != d.end(); ++it) {
+            sum += *it;
+        }
+        return sum;
+    }), with_counters);
+    print("iterator --\t", measure(counters, n, reps, [&d]() {
+        uint64_t sum = 0;
+        for (deque<elem_t>::iterator it = d.end(); it != d.begin();) {
+            sum += *--it;
+        }
+        return sum;
+    }), with_counters);
+
+    const size_t distances[] = {0, 1, 2, 4, 8, 16};
+    for (size_t distance : distances) {
+        std::string name = "for_each(" + std::to_string(distance) + ")\t";
+        print(name.c_str(), measure(counters, n, reps, [&d, distance]() {
+            uint64_t sum = 0;
+            d.for_each([&sum](elem_t x) { sum += x; }, distance);
+            return sum;
+        }), with_counters);
+    }
+    for (size_t distance : distances) {
+        std::string name = "for_each_reverse(" + std::to_string(distance) + ")";
+        print(name.c_str(), measure(counters, n, reps, [&d, distance]() {
+            uint64_t sum = 0;
+            d.for_each_reverse([&sum](elem_t x) { sum += x; }, distance);
+            return sum;
+        }), with_counters);
+    }
+    return 0;
+}
@@ -0,0 +1,104 @@
+#include <iostream>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <cstdlib>
+#include <cstdint>
+#include "lockfree_stack.hpp"
+#include "vector.hpp"
+
+// 无锁栈压力 + 吞吐测试
+// 每个线程交替执行 push / try_pop（每 64 次操作做一次 push_batch / pop_all），
+// 结束后校验：压入值之和 == 弹出值之和 + 剩余值之和。
+// 用法：lockfree_stack_bench [每线程操作数] [消除槽数量]
+
+struct run_result
+{
+    double mops;
+    bool ok;
+};
+
+static run_result run(size_t threads, size_t ops_per_thread, size_t elimination_slots)
+{
+    lockfree_stack<uint64_t> stack(elimination_slots);
+    std::atomic<uint64_t> pushed_sum{0};
+    std::atomic<uint64_t> popped_sum{0};
+    std::atomic<bool> go{false};
+
+    vector<std::thread*> workers;
+    for (size_t t = 0; t < threads; ++t) {
+        workers.push_back(new std::thread([&, t]() {
+            uint64_t local_pushed = 0;
+            uint64_t local_popped = 0;
+            uint64_t batch[16];
+            vector<uint64_t> drained;
+            while (!go.load(std::memory_order_acquire)) {
+                std::this_thread::yield();
+            }
+            for (size_t i = 0; i < ops_per_thread; ++i) {
+                uint64_t value = (uint64_t(t) << 32) | i;
+                if (i % 64 == 63) {
+                    for (size_t k = 0; k < 16; ++k) {
+                        batch[k] = value + k;
+                        local_pushed += batch[k];
+                    }
+                    stack.push_batch(batch, batch + 16);
+                    drained.clear();
+                    stack.pop_all(drained);
+                    for (size_t k = 0; k < drained.size(); ++k) {
+                        local_popped += drained[k];
+                    }
+                } else if (i % 2 == 0) {
+                    stack.push(value);
+                    local_pushed += value;
+                } else {
+                    uint64_t out;
+                    if (stack.try_pop(out)) {
+                        local_popped += out;
+                    }
+                }
+            }
+            pushed_sum.fetch_add(local_pushed);
+            popped_sum.fetch_add(local_popped);
+        }));
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    go.store(true, std::memory_order_release);
+    for (size_t t = 0; t < workers.size(); ++t) {
+        workers[t]->join();
+        delete workers[t];
+    }
+    auto stop = std::chrono::steady_clock::now();
+
+    uint64_t remaining = 0;
+    uint64_t out;
+    while (stack.try_pop(out)) {
+        remaining += out;
+    }
+
+    double seconds = std::chrono::duration<double>(stop - start).count();
+    run_result result;
+    result.mops = double(threads * ops_per_thread) / seconds / 1e6;
+    result.ok = (pushed_sum.load() == popped_sum.load() + remaining);
+    return result;
+}
+
+int main(int argc, char** argv)
+{
+    size_t ops_per_thread = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 200000;
+    size_t elimination_slots = (argc > 2) ? std::strtoull(argv[2], nullptr, 10) : 16;
+    const size_t thread_counts[] = {1, 2, 4, 8, 16, 32, 64};
+
+    std::cout << "threads\tplain(Mops/s)\telimination(Mops/s)\tcheck" << std::endl;
+    bool all_ok = true;
+    for (size_t threads : thread_counts) {
+        run_result plain = run(threads, ops_per_thread, 0);
+        run_result elim = run(threads, ops_per_thread, elimination_slots);
+        bool ok = plain.ok && elim.ok;
+        all_ok = all_ok && ok;
+        std::cout << threads << "\t" << plain.mops << "\t\t" << elim.mops
+             << "\t\t\t" << (ok ? "ok" : "FAILED") << std::endl;
+    }
+    return all_ok ? 0 : 1;
+}
@@ -0,0 +1,157 @@
+#pragma once
+#include<iostream>
+#include <stdexcept>
+#include <cstdint>
+#include <cstring>
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// 基于 Linux perf_event_open 的硬件性能计数器
+// 统计当前线程在用户态的 cycles、instructions、L1D 读缺失、LLC 读缺失、分支预测失败、dTLB 读缺失。
+// 每个事件单独打开，某个事件不被硬件或内核支持（虚拟机、容器、perf_event_paranoid 限制等）时
+// 只是跳过它；一个都打不开时 available() 为 false，调用方照常只统计时间。
+// 计数器被复用（多路复用）时按 time_enabled / time_running 放大，读数是估计值。
+//     perf_counters counters;
+//     counters.read(before); ...被测代码...; counters.read(after);
+
+class perf_counters
+{
+public:
+    static const size_t EVENT_COUNT = 6;
+
+private:
+    int m_fds[EVENT_COUNT];
+
+public:
+    perf_counters();
+    ~perf_counters();
+    perf_counters(const perf_counters&) = delete;
+    perf_counters& operator=(const perf_counters&) = delete;
+
+    static const char* name(size_t event);
+
+    //打开计数器，返回成功打开的事件个数
+    size_t open();
+    void close();
+
+    bool available() const;
+    bool available(size_t event) const { return m_fds[event] >= 0; }
+
+    //读取所有事件的累计值（已按复用比例放大），不可用的事件读作 0
+    void read(uint64_t values[EVENT_COUNT]) const;
+};
+
+inline perf_counters::perf_counters()
+{
+    for (size_t i = 0; i < EVENT_COUNT; ++i) {
+        m_fds[i] = -1;
+    }
+}
+
+inline perf_counters::~perf_counters()
+{
+    close();
+}
+
+inline const char* perf_counters::name(size_t event)
+{
+    static const char* const NAMES[EVENT_COUNT] = {
+        "cycles", "instructions", "l1d_misses", "llc_misses", "branch_misses", "dtlb_misses"
+    };
+    return event < EVENT_COUNT ? NAMES[event] : "unknown";
+}
+
+inline bool perf_counters::available() const
+{
+    for (size_t i = 0; i < EVENT_COUNT; ++i) {
+        if (m_fds[i] >= 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+#if defined(__linux__)
+
+inline size_t perf_counters::open()
+{
+    close();
+    const uint64_t READ_MISS = PERF_COUNT_HW_CACHE_OP_READ << 8 | PERF_COUNT_HW_CACHE_RESULT_MISS << 16;
+    const uint32_t types[EVENT_COUNT] = {
+        PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE,
+        PERF_TYPE_HW_CACHE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE
+    };
+    const uint64_t configs[EVENT_COUNT] = {
+        PERF_COUNT_HW_CPU_CYCLES,
+        PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_CACHE_L1D | READ_MISS,
+        PERF_COUNT_HW_CACHE_LL | READ_MISS,
+        PERF_COUNT_HW_BRANCH_MISSES,
+        PERF_COUNT_HW_CACHE_DTLB | READ_MISS
+    };
+
+    size_t opened = 0;
+    for (size_t i = 0; i < EVENT_COUNT; ++i) {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = types[i];
+        attr.config = configs[i];
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        //只统计调用线程，任意 CPU
+        long fd = syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+        if (fd >= 0) {
+            m_fds[i] = static_cast<int>(fd);
+            ++opened;
+        }
+    }
+    return opened;
+}
+
+inline void perf_counters::close()
+{
+    for (size_t i = 0; i < EVENT_COUNT; ++i) {
+        if (m_fds[i] >= 0) {
+            ::close(m_fds[i]);
+            m_fds[i] = -1;
+        }
+    }
+}
+
+inline void perf_counters::read(uint64_t values[EVENT_COUNT]) const
+{
+    for (size_t i = 0; i < EVENT_COUNT; ++i) {
+        values[i] = 0;
+        if (m_fds[i] < 0) {
+            continue;
+        }
+        uint64_t data[3];   //value, time_enabled, time_running
+        if (::read(m_fds[i], data, sizeof(data)) != static_cast<ssize_t>(sizeof(data))) {
+            continue;
+        }
+        if (data[2] == 0) {
+            continue;
+        }
+        values[i] = data[2] < data[1]
+                    ? static_cast<uint64_t>(double(data[0]) * double(data[1]) / double(data[2]))
+                    : data[0];
+    }
+}
+
+#else
+
+inline size_t perf_counters::open() { return 0; }
+inline void perf_counters::close() {}
+inline void perf_counters::read(uint64_t values[EVENT_COUNT]) const
+{
+    for (size_t i = 0; i < EVENT_COUNT; ++i) {
+        values[i] = 0;
+    }
+}
+
+#endif
@@ -0,0 +1,121 @@
+#include <iostream>
+#include <chrono>
+#include <cstdlib>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <fcntl.h>
+#include <unistd.h>
+#include "vector.hpp"
+#include "deque.hpp"
+#include "serialize.hpp"
+
+// 序列化吞吐：对比手写的逐元素循环（ofstream::write / ifstream::read + push_back）
+// 与 serialize / deserialize（writev 整块写出、直接读进容器存储）。
+// 文件写在 $TMPDIR（默认 /tmp），不做 fsync，测的是到页缓存的速度；读之前文件通常还在页缓存里。
+// 用法：serialize_bench [数据 MB]
+
+struct record
+{
+    uint64_t key;
+    uint32_t value;
+    uint32_t flags;
+};
+
+static double seconds_since(std::chrono::steady_clock::time_point t0)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+static void report(const char* name, size_t bytes, double save_s, double load_s)
+{
+    double mb = double(bytes) / double(1 << 20);
+    std::cout << name << "\t" << (mb / save_s) << "\t\t" << (mb / load_s) << std::endl;
+}
+
+template <class C>
+static void hand_rolled(const char* name, const C& c, const std::string& path)
+{
+    auto t0 = std::chrono::steady_clock::now();
+    {
+        std::ofstream out(path.c_str(), std::ios::binary | std::ios::trunc);
+        uint64_t n = c.size();
+        out.write(reinterpret_cast<const char*>(&n), sizeof(n));
+        for (size_t i = 0; i < c.size(); ++i) {
+            out.write(reinterpret_cast<const char*>(&c[i]), sizeof(record));
+        }
+    }
+    double save_s = seconds_since(t0);
+
+    t0 = std::chrono::steady_clock::now();
+    C loaded;
+    {
+        std::ifstream in(path.c_str(), std::ios::binary);
+        uint64_t n = 0;
+        in.read(reinterpret_cast<char*>(&n), sizeof(n));
+        record r;
+        for (uint64_t i = 0; i < n && in.read(reinterpret_cast<char*>(&r), sizeof(r)); ++i) {
+            loaded.push_back(r);
+        }
+    }
+    double load_s = seconds_since(t0);
+    if (loaded.size() != c.size()) {
+        std::cerr << name << ": reload mismatch" << std::endl;
+    }
+    report(name, c.size() * sizeof(record), save_s, load_s);
+}
+
+template <class C>
+static void streamed(const char* name, const C& c, const std::string& path, bool checksum)
+{
+    serialize_options options;
+    options.checksum = checksum;
+    auto t0 = std::chrono::steady_clock::now();
+    {
+        int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        serialize(fd, c, options);
+        ::close(fd);
+    }
+    double save_s = seconds_since(t0);
+
+    t0 = std::chrono::steady_clock::now();
+    C loaded;
+    {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        deserialize(fd, loaded);
+        ::close(fd);
+    }
+    double load_s = seconds_since(t0);
+    if (loaded.size() != c.size()) {
+        std::cerr << name << ": reload mismatch" << std::endl;
+    }
+    report(name, c.size() * sizeof(record), save_s, load_s);
+}
+
+int main(int argc, char** argv)
+{
+    size_t megabytes = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 512;
+    size_t n = (megabytes << 20) / sizeof(record);
+    const char* tmp = std::getenv("TMPDIR");
+    std::string path = std::string(tmp != nullptr && *tmp != '\0' ? tmp : "/tmp") + "/serialize_bench.bin";
+
+    vector<record> v;
+    deque<record> d;
+    for (size_t i = 0; i < n; ++i) {
+        record r = {i, uint32_t(i * 2654435761u), 0};
+        v.push_back(r);
+        d.push_back(r);
+    }
+
+    std::cout << "data: " << megabytes << " MB (" << n << " records)" << std::endl;
+    std::cout << "method\t\t\tsave(MB/s)\tload(MB/s)" << std::endl;
+    hand_rolled("vector loop\t", v, path);
+    hand_rolled("deque loop\t", d, path);
+    streamed("vector serialize", v, path, true);
+    streamed("vector no checksum", v, path, false);
+    streamed("deque serialize\t", d, path, true);
+    streamed("deque no checksum", d, path, false);
+    std::remove(path.c_str());
+    return 0;
+}
@@ -0,0 +1,92 @@
+#include <iostream>
+#include <chrono>
+#include <cstdlib>
+#include <cstdint>
+#include "vector.hpp"
+#include "soa_vector.hpp"
+
+// 列扫描对比：vector<Particle>（AoS，每个元素 64 字节）与同样字段的 soa_vector（SoA）
+//   scan  ：对 x 求和，只读一个字段
+//   update：x += vx * dt，读两个字段写一个字段
+// 用法：soa_vector_bench [元素个数] [重复次数]
+
+struct Particle
+{
+    float x, y, z;
+    float vx, vy, vz;
+    float mass, charge;
+    uint64_t id;
+    double energy;
+    uint32_t flags;
+    uint32_t group;
+    uint64_t reserved;
+};
+static_assert(sizeof(Particle) == 64, "Particle 应为 64 字节");
+
+typedef soa_vector<float, float, float, float, float, float, float, float,
+                   uint64_t, double, uint32_t, uint32_t, uint64_t> particle_columns;
+
+template <class F>
+static double time_ms(size_t repeat, F f)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (size_t r = 0; r < repeat; ++r) {
+        f();
+    }
+    auto stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(stop - start).count() / double(repeat);
+}
+
+int main(int argc, char** argv)
+{
+    size_t n = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : (size_t(4) << 20);
+    size_t repeat = (argc > 2) ? std::strtoull(argv[2], nullptr, 10) : 10;
+    const float dt = 0.01f;
+
+    vector<Particle> aos;
+    particle_columns soa;
+    aos.reserve(n);
+    soa.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        Particle p = {float(i), 0, 0, 1.0f, 0, 0, 1.0f, 0, i, 0.0, 0, 0, 0};
+        aos.push_back(p);
+        soa.push_back(p.x, p.y, p.z, p.vx, p.vy, p.vz, p.mass, p.charge,
+                      p.id, p.energy, p.flags, p.group, p.reserved);
+    }
+
+    volatile double sink = 0;
+    double aos_scan = time_ms(repeat, [&]() {
+        double sum = 0;
+        for (size_t i = 0; i < aos.size(); ++i) {
+            sum += aos[i].x;
+        }
+        sink = sum;
+    });
+    double soa_scan = time_ms(repeat, [&]() {
+        soa_span<float> xs = soa.column<0>();
+        double sum = 0;
+        for (size_t i = 0; i < xs.size(); ++i) {
+            sum += xs[i];
+        }
+        sink = sum;
+    });
+    double aos_update = time_ms(repeat, [&]() {
+        for (size_t i = 0; i < aos.size(); ++i) {
+            aos[i].x += aos[i].vx * dt;
+        }
+    });
+    double soa_update = time_ms(repeat, [&]() {
+        soa_span<float> xs = soa.column<0>();
+        soa_span<float> vxs = soa.column<3>();
+        for (size_t i = 0; i < xs.size(); ++i) {
+            xs[i] += vxs[i] * dt;
+        }
+    });
+    (void)sink;
+
+    std::cout << "elements: " << n << ", repeat: " << repeat << std::endl;
+    std::cout << "workload\tAoS(ms)\t\tSoA(ms)\t\tspeedup" << std::endl;
+    std::cout << "scan x\t\t" << aos_scan << "\t\t" << soa_scan << "\t\t" << aos_scan / soa_scan << "x" << std::endl;
+    std::cout << "x += vx*dt\t" << aos_update << "\t\t" << soa_update << "\t\t" << aos_update / soa_update << "x" << std::endl;
+    return 0;
+}
@@ -0,0 +1,143 @@
+#include <iostream>
+#include <chrono>
+#include <cstdlib>
+#include <cstdint>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "deque.hpp"
+#include "spill_deque.hpp"
+
+// 积压队列场景：先 push_back 攒到指定大小，再 pop_front 全部取出（每个元素读一次 front）
+// 混合场景：每轮 push_back 3 倍驻留上限的块再 pop_back 1 倍，攒满后同样全部取出；pop_back 退进已换出的区域时
+// 会触发尾部预读，随后的 push 把预读块推出窗口，用来检查这种情况下驻留上限依然有效（fill 列为攒数据阶段的耗时）
+// 对比全内存的 deque 和 spill_deque（不预读 / 预读），每种配置在单独 fork 出的子进程里跑，
+// 内存峰值取子进程的 ru_maxrss。spill_deque 的换出文件放在 $TMPDIR（默认 /tmp），注意磁盘空间。
+// 用法：spill_deque_bench [积压 MB] [驻留块上限] [预读块数]
+
+struct record
+{
+    uint64_t id;
+    unsigned char payload[56];
+};
+
+//pop_front 取出 n 个元素，返回 id 之和
+template <class Q>
+static uint64_t drain(Q& q, size_t n, std::chrono::steady_clock::time_point t1, double& drain_ms)
+{
+    uint64_t sum = 0;
+    for (size_t i = 0; i < n; ++i) {
+        sum += q.front().id;
+        q.pop_front();
+    }
+    auto t2 = std::chrono::steady_clock::now();
+    drain_ms = std::chrono::duration<double, std::milli>(t2 - t1).count();
+    return sum;
+}
+
+template <class Q>
+static uint64_t fill_and_drain(Q& q, size_t n, double& fill_ms, double& drain_ms)
+{
+    record r = record();
+    auto t0 = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < n; ++i) {
+        r.id = i;
+        q.push_back(r);
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    fill_ms = std::chrono::duration<double, std::milli>(t1 - t0).count();
+    return drain(q, n, t1, drain_ms);
+}
+
+//弹出的 id 下一轮重新压入，最后队列里仍是 0 .. n-1
+template <class Q>
+static uint64_t mixed_and_drain(Q& q, size_t n, size_t max_resident, double& fill_ms, double& drain_ms)
+{
+    const size_t chunk = spill_deque<record>::BLOCK_SIZE * max_resident;
+    record r = record();
+    auto t0 = std::chrono::steady_clock::now();
+    size_t next = 0;
+    for (;;) {
+        for (size_t i = 0; i < 3 * chunk && next < n; ++i) {
+            r.id = next++;
+            q.push_back(r);
+        }
+        if (next == n) {
+            break;
+        }
+        for (size_t i = 0; i < chunk; ++i) {
+            q.pop_back();
+            --next;
+        }
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    fill_ms = std::chrono::duration<double, std::milli>(t1 - t0).count();
+    return drain(q, n, t1, drain_ms);
+}
+
+//在子进程里跑 body，打印耗时和子进程内存峰值
+template <class Body>
+static void run(const char* name, size_t n, Body body)
+{
+    std::cout.flush();
+    pid_t pid = fork();
+    if (pid < 0) {
+        std::cerr << "fork failed" << std::endl;
+        return;
+    }
+    if (pid == 0) {
+        double fill_ms = 0, drain_ms = 0;
+        uint64_t sum = body(fill_ms, drain_ms);
+        bool ok = sum == uint64_t(n) * (n - 1) / 2;
+        std::cout << name << "\t" << fill_ms << "\t\t" << drain_ms << "\t\t"
+                  << (double(n) / drain_ms / 1e3) << (ok ? "" : "\t(checksum mismatch)") << "\t";
+        std::cout.flush();
+        _exit(ok ? 0 : 1);
+    }
+    int status = 0;
+    struct rusage usage;
+    if (wait4(pid, &status, 0, &usage) < 0 || !WIFEXITED(status)) {
+        std::cout << name << "\tfailed" << std::endl;
+        return;
+    }
+    std::cout << (usage.ru_maxrss / 1024) << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+    size_t megabytes = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 1024;
+    size_t max_resident = (argc > 2) ? std::strtoull(argv[2], nullptr, 10) : 64;
+    size_t readahead = (argc > 3) ? std::strtoull(argv[3], nullptr, 10) : 4;
+    size_t n = (megabytes << 20) / sizeof(record);
+    if (n == 0 || max_resident < 2 * (2 + readahead)) {
+        std::cerr << "usage: spill_deque_bench [backlog MB] [max resident blocks >= 2 * (2 + read-ahead)] [read-ahead blocks]"
+                  << std::endl;
+        return 1;
+    }
+
+    std::cout << "backlog: " << megabytes << " MB (" << n << " records), resident cap: " << max_resident
+              << " blocks (" << (max_resident * spill_deque<record>::BLOCK_SIZE * sizeof(record) >> 20)
+              << " MB)" << std::endl;
+    std::cout << "container\t\tfill(ms)\tdrain(ms)\tdrain(Mops/s)\tpeak RSS(MB)" << std::endl;
+    run("deque\t\t", n, [n](double& fill_ms, double& drain_ms) {
+        deque<record> q;
+        return fill_and_drain(q, n, fill_ms, drain_ms);
+    });
+    run("spill_deque\t", n, [n, max_resident](double& fill_ms, double& drain_ms) {
+        spill_deque<record> q(max_resident, 2, 0);
+        return fill_and_drain(q, n, fill_ms, drain_ms);
+    });
+    run("spill_deque+readahead", n, [n, max_resident, readahead](double& fill_ms, double& drain_ms) {
+        spill_deque<record> q(max_resident, 2, readahead);
+        return fill_and_drain(q, n, fill_ms, drain_ms);
+    });
+    run("deque mixed\t", n, [n, max_resident](double& fill_ms, double& drain_ms) {
+        deque<record> q;
+        return mixed_and_drain(q, n, max_resident, fill_ms, drain_ms);
+    });
+    run("spill_deque mixed+readahead", n, [n, max_resident, readahead](double& fill_ms, double& drain_ms) {
+        spill_deque<record> q(max_resident, 2, readahead);
+        return mixed_and_drain(q, n, max_resident, fill_ms, drain_ms);
+    });
+    return 0;
+}
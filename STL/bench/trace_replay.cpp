@@ -0,0 +1,405 @@
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <fstream>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include <deque>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "vector.hpp"
+#include "deque.hpp"
+#include "trace.hpp"
+#include "bench_harness.hpp"
+
+// 轨迹重放：把 trace_recorder 录下的操作序列在 vector / deque / std::vector / std::deque 上重放
+// 每个容器在单独 fork 出的子进程里跑，内存峰值互不干扰：
+//   吞吐   ：整条轨迹连续重放 --reps 次，取耗时中位数
+//   延迟   ：再重放一遍，逐个操作计时，给出 p50 / p90 / p99 / p99.9 / max（含约 20ns 的计时开销）
+//   内存峰值：子进程最大 RSS 减去重放前的 RSS，包含分配器自身的开销
+// 没有 push_front / pop_front 的容器（vector、std::vector）用头部 insert / erase 代替。
+// 用法：trace_replay 轨迹文件 [--containers vector,deque,std::vector,std::deque] [--reps N] [--json 文件]
+//       trace_replay --generate 轨迹文件 [--ops N] [--elem 字节数]   生成一条队列为主的示例轨迹
+
+template <size_t N>
+struct blob
+{
+    unsigned char bytes[N];
+};
+
+//子进程通过管道交回的结果
+struct replay_result
+{
+    int ok;
+    double seconds;        //吞吐测量的耗时中位数
+    double p50, p90, p99, p999, max;
+    long peak_kb;
+};
+
+struct named_result
+{
+    std::string container;
+    replay_result r;
+};
+
+template <class C, class = void>
+struct has_front_ops : std::false_type {};
+template <class C>
+struct has_front_ops<C, decltype(std::declval<C&>().pop_front())> : std::true_type {};
+
+template <class C, class T>
+static inline void apply(C& c, const trace_event& e, const T& proto, size_t& sink)
+{
+    switch (e.op) {
+    case trace_op::push_back:
+        c.push_back(proto);
+        break;
+    case trace_op::push_front:
+        if constexpr (has_front_ops<C>::value) {
+            c.push_front(proto);
+        } else {
+            c.insert(c.begin(), proto);
+        }
+        break;
+    case trace_op::pop_back:
+        c.pop_back();
+        break;
+    case trace_op::pop_front:
+        if constexpr (has_front_ops<C>::value) {
+            c.pop_front();
+        } else {
+            c.erase(c.begin());
+        }
+        break;
+    case trace_op::insert:
+        c.insert(c.begin() + e.arg, proto);
+        break;
+    case trace_op::erase:
+        c.erase(c.begin() + e.arg);
+        break;
+    case trace_op::index:
+        sink += c[e.arg].bytes[0];
+        break;
+    case trace_op::clear:
+        c.clear();
+        break;
+    }
+}
+
+static long current_rss_kb()
+{
+    std::ifstream statm("/proc/self/statm");
+    long pages = 0, resident = 0;
+    statm >> pages >> resident;
+    return resident * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+template <class C, class T>
+static replay_result replay(const std::vector<trace_event>& events, size_t reps)
+{
+    replay_result result = {};
+    const T proto = T();
+    size_t sink = 0;
+
+    //延迟数组先写一遍，让它的页计入基线 RSS
+    std::vector<uint32_t> latencies(events.size(), 1);
+    long baseline_kb = current_rss_kb();
+
+    std::vector<double> runs;
+    for (size_t rep = 0; rep < std::max<size_t>(reps, 1); ++rep) {
+        C c;
+        auto start = std::chrono::steady_clock::now();
+        for (const trace_event& e : events) {
+            apply(c, e, proto, sink);
+        }
+        runs.push_back(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    }
+    std::sort(runs.begin(), runs.end());
+    result.seconds = runs[runs.size() / 2];
+
+    {
+        C c;
+        for (size_t i = 0; i < events.size(); ++i) {
+            auto start = std::chrono::steady_clock::now();
+            apply(c, events[i], proto, sink);
+            auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+            latencies[i] = static_cast<uint32_t>(std::min<long long>(ns, UINT32_MAX));
+        }
+    }
+    if (!latencies.empty()) {
+        std::sort(latencies.begin(), latencies.end());
+        //最近秩法
+        auto percentile = [&latencies](double p) {
+            size_t rank = static_cast<size_t>(p * double(latencies.size()) + 0.999999);
+            return double(latencies[std::min(std::max<size_t>(rank, 1), latencies.size()) - 1]);
+        };
+        result.p50 = percentile(0.50);
+        result.p90 = percentile(0.90);
+        result.p99 = percentile(0.99);
+        result.p999 = percentile(0.999);
+        result.max = double(latencies.back());
+    }
+
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    result.peak_kb = std::max<long>(0, usage.ru_maxrss - baseline_kb);
+    do_not_optimize(sink);
+    result.ok = 1;
+    return result;
+}
+
+//在子进程里重放，父进程只收结果
+template <class C, class T>
+static replay_result replay_isolated(const std::vector<trace_event>& events, size_t reps)
+{
+    int fds[2];
+    if (pipe(fds) != 0) {
+        throw std::runtime_error("trace_replay: pipe failed");
+    }
+    std::cout.flush();
+    pid_t pid = fork();
+    if (pid < 0) {
+        throw std::runtime_error("trace_replay: fork failed");
+    }
+    if (pid == 0) {
+        close(fds[0]);
+        replay_result r = {};
+        try {
+            r = replay<C, T>(events, reps);
+        } catch (const std::exception& e) {
+            std::cerr << "replay failed: " << e.what() << std::endl;
+        }
+        ssize_t written = write(fds[1], &r, sizeof(r));
+        _exit(written == ssize_t(sizeof(r)) && r.ok ? 0 : 1);
+    }
+    close(fds[1]);
+    replay_result r = {};
+    ssize_t got = read(fds[0], &r, sizeof(r));
+    close(fds[0]);
+    int status = 0;
+    waitpid(pid, &status, 0);
+    if (got != ssize_t(sizeof(r))) {
+        r.ok = 0;
+    }
+    return r;
+}
+
+//检查轨迹里的位置和下标都落在当时的容器范围内，损坏的轨迹不至于在重放时越界
+static void validate(const std::vector<trace_event>& events)
+{
+    size_t size = 0;
+    for (size_t i = 0; i < events.size(); ++i) {
+        const trace_event& e = events[i];
+        bool ok = true;
+        switch (e.op) {
+        case trace_op::push_back:
+        case trace_op::push_front: ++size; break;
+        case trace_op::pop_back:
+        case trace_op::pop_front: ok = size > 0; size -= ok ? 1 : 0; break;
+        case trace_op::insert: ok = e.arg <= size; size += ok ? 1 : 0; break;
+        case trace_op::erase: ok = e.arg < size; size -= ok ? 1 : 0; break;
+        case trace_op::index: ok = e.arg < size; break;
+        case trace_op::clear: size = 0; break;
+        }
+        if (!ok) {
+            throw std::runtime_error("trace_replay: event " + std::to_string(i) + " (" +
+                                     trace_op_name(e.op) + ") is out of range");
+        }
+    }
+}
+
+template <class T>
+static std::vector<named_result> replay_all(const std::vector<trace_event>& events,
+                                            const std::vector<std::string>& containers, size_t reps)
+{
+    std::vector<named_result> results;
+    for (const std::string& name : containers) {
+        replay_result r;
+        if (name == "vector") {
+            r = replay_isolated<vector<T>, T>(events, reps);
+        } else if (name == "deque") {
+            r = replay_isolated<deque<T>, T>(events, reps);
+        } else if (name == "std::vector") {
+            r = replay_isolated<std::vector<T>, T>(events, reps);
+        } else if (name == "std::deque") {
+            r = replay_isolated<std::deque<T>, T>(events, reps);
+        } else {
+            throw std::invalid_argument("unknown container " + name);
+        }
+        if (!r.ok) {
+            std::cout << name << "\tfailed" << std::endl;
+            continue;
+        }
+        double mops = r.seconds > 0 ? double(events.size()) / r.seconds / 1e6 : 0;
+        std::cout << name << "\t" << events.size() << "\t" << mops << "\t" << r.p50 << "\t" << r.p90
+                  << "\t" << r.p99 << "\t" << r.p999 << "\t" << r.max << "\t" << r.peak_kb << std::endl;
+        results.push_back(named_result{name, r});
+    }
+    return results;
+}
+
+//示例轨迹：以队列为主（尾进头出），夹杂随机读、少量中间插入删除和偶尔的 clear
+template <class T>
+static void generate(const std::string& path, size_t ops)
+{
+    trace_writer writer(path, sizeof(T));
+    trace_recorder<deque<T> > rec(writer);
+    std::mt19937_64 rng(42);
+    size_t sink = 0;
+    for (size_t i = 0; i < ops; ++i) {
+        unsigned roll = static_cast<unsigned>(rng() % 1000);
+        size_t n = rec.size();
+        if (roll < 1 && n > 0) {
+            rec.clear();
+        } else if (roll < 450 || n == 0) {
+            rec.push_back(T());
+        } else if (roll < 850) {
+            rec.pop_front();
+        } else if (roll < 980) {
+            sink += rec[rng() % n].bytes[0];
+        } else if (roll < 990) {
+            rec.insert(rng() % (n + 1), T());
+        } else {
+            rec.erase(rng() % n);
+        }
+    }
+    writer.flush();
+    do_not_optimize(sink);
+    std::cout << "wrote " << writer.events() << " events to " << path << std::endl;
+}
+
+static std::vector<std::string> split(const std::string& text)
+{
+    std::vector<std::string> parts;
+    size_t start = 0;
+    while (start <= text.size()) {
+        size_t comma = text.find(',', start);
+        if (comma == std::string::npos) {
+            comma = text.size();
+        }
+        if (comma > start) {
+            parts.push_back(text.substr(start, comma - start));
+        }
+        start = comma + 1;
+    }
+    return parts;
+}
+
+//把元素大小映射到最近的不小于它的占位类型
+template <class F>
+static void with_elem_size(size_t elem, F f)
+{
+    if (elem <= 4) {
+        f(blob<4>());
+    } else if (elem <= 16) {
+        f(blob<16>());
+    } else if (elem <= 64) {
+        f(blob<64>());
+    } else if (elem <= 256) {
+        f(blob<256>());
+    } else if (elem <= 1024) {
+        f(blob<1024>());
+    } else {
+        throw std::invalid_argument("element size " + std::to_string(elem) + " is larger than 1024");
+    }
+}
+
+static void write_json(const std::string& path, const std::string& trace, size_t events,
+                       const std::vector<named_result>& results)
+{
+    std::ofstream out(path.c_str());
+    if (!out) {
+        throw std::runtime_error("trace_replay: cannot open " + path);
+    }
+    out << "{\n  \"trace\": \"" << trace << "\", \"events\": " << events << ",\n  \"results\": [";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const replay_result& r = results[i].r;
+        out << (i == 0 ? "\n" : ",\n")
+            << "    {\"container\": \"" << results[i].container << "\", \"seconds\": " << r.seconds
+            << ", \"latency_ns\": {\"p50\": " << r.p50 << ", \"p90\": " << r.p90 << ", \"p99\": " << r.p99
+            << ", \"p999\": " << r.p999 << ", \"max\": " << r.max << "}, \"peak_rss_kb\": " << r.peak_kb << "}";
+    }
+    out << "\n  ]\n}\n";
+}
+
+int main(int argc, char** argv)
+{
+    std::string trace_path;
+    std::string generate_path;
+    std::string json_path;
+    std::vector<std::string> containers = {"vector", "deque", "std::vector", "std::deque"};
+    size_t reps = 3;
+    size_t ops = 1000000;
+    size_t elem = 16;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.compare(0, 2, "--") != 0) {
+            trace_path = arg;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            std::cerr << "missing value for " << arg << std::endl;
+            return 1;
+        }
+        const char* value = argv[++i];
+        if (arg == "--containers") {
+            containers = split(value);
+        } else if (arg == "--reps") {
+            reps = std::strtoull(value, nullptr, 10);
+        } else if (arg == "--json") {
+            json_path = value;
+        } else if (arg == "--generate") {
+            generate_path = value;
+        } else if (arg == "--ops") {
+            ops = std::strtoull(value, nullptr, 10);
+        } else if (arg == "--elem") {
+            elem = std::strtoull(value, nullptr, 10);
+        } else {
+            std::cerr << "unknown option " << arg << std::endl;
+            return 1;
+        }
+    }
+
+    try {
+        if (!generate_path.empty()) {
+            with_elem_size(elem, [&](auto tag) { generate<decltype(tag)>(generate_path, ops); });
+            return 0;
+        }
+        if (trace_path.empty()) {
+            std::cerr << "usage: trace_replay TRACE [--containers a,b] [--reps N] [--json FILE]\n"
+                      << "       trace_replay --generate TRACE [--ops N] [--elem BYTES]" << std::endl;
+            return 1;
+        }
+
+        //先整体解码，重放时不含解码开销
+        trace_reader reader(trace_path);
+        std::vector<trace_event> events;
+        trace_event e;
+        while (reader.next(e)) {
+            events.push_back(e);
+        }
+        validate(events);
+
+        std::cout << "trace " << trace_path << ": " << events.size() << " events, element "
+                  << reader.elem_size() << " bytes" << std::endl;
+        std::cout << "container\tops\tthroughput(Mops/s)\tp50(ns)\tp90\tp99\tp99.9\tmax\tpeak_rss(KiB)" << std::endl;
+        std::vector<named_result> results;
+        with_elem_size(reader.elem_size(), [&](auto tag) {
+            results = replay_all<decltype(tag)>(events, containers, reps);
+        });
+        if (!json_path.empty()) {
+            write_json(json_path, trace_path, events.size(), results);
+        }
+    } catch (const std::exception& ex) {
+        std::cerr << ex.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,54 @@
+#include <iostream>
+#include <chrono>
+#include <cstdlib>
+#include <cstdint>
+#include "vector.hpp"
+#include "mmap_storage.hpp"
+
+// 大 vector 的存储后端对比：malloc / mmap（普通页）/ mmap + MADV_HUGEPAGE
+// 对每种后端测量：push_back 逐个追加 n 个元素的耗时，以及随机下标读取的吞吐。
+// 随机访问使用与数据无关的线性同余序列生成下标，主要受 TLB 和缓存缺失影响。
+// 用法：vector_hugepage_bench [元素个数] [随机访问次数]
+
+typedef uint64_t elem_t;
+
+template <class Vec>
+static void run(const char* name, size_t n, size_t accesses)
+{
+    auto t0 = std::chrono::steady_clock::now();
+    Vec v;
+    for (size_t i = 0; i < n; ++i) {
+        v.push_back(elem_t(i));
+    }
+    auto t1 = std::chrono::steady_clock::now();
+
+    uint64_t x = 88172645463325252ull;
+    uint64_t sum = 0;
+    for (size_t i = 0; i < accesses; ++i) {
+        x = x * 6364136223846793005ull + 1442695040888963407ull;
+        sum += v[(x >> 17) % n];
+    }
+    auto t2 = std::chrono::steady_clock::now();
+
+    double append_ms = std::chrono::duration<double, std::milli>(t1 - t0).count();
+    double access_ns = std::chrono::duration<double, std::nano>(t2 - t1).count() / double(accesses);
+    std::cout << name << "\t" << append_ms << "\t\t" << access_ns
+              << "\t\t" << (1e3 / access_ns) << "\t(checksum " << (sum & 0xffff) << ")" << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+    size_t n = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : (size_t(16) << 20);
+    size_t accesses = (argc > 2) ? std::strtoull(argv[2], nullptr, 10) : (size_t(20) << 20);
+    if (n == 0) {
+        return 1;
+    }
+
+    std::cout << "elements: " << n << " (" << (n * sizeof(elem_t) >> 20) << " MB), random reads: "
+              << accesses << std::endl;
+    std::cout << "storage\t\tappend(ms)\taccess(ns/op)\tthroughput(Mops/s)" << std::endl;
+    run<vector<elem_t> >("malloc\t", n, accesses);
+    run<vector<elem_t, growth_double, mmap_storage<false> > >("mmap\t", n, accesses);
+    run<vector<elem_t, growth_double, mmap_storage<true> > >("mmap+huge", n, accesses);
+    return 0;
+}
@@ -0,0 +1,127 @@
+#pragma once
+#include<iostream>
+#include <algorithm>
+#include <utility>
+
+// 分块双端容器共用的块指针数组：Slot 数组 + 首元素位置 (m_start_block, m_start_index) + 元素个数 m_size。
+// 只负责逻辑位置到槽位的换算，以及指针数组的分配、扩大和重新居中；
+// 块本身怎么分配、共享、换出和释放由派生容器决定（cow_deque 的 Slot 是带引用计数的块指针，
+// spill_deque 的 Slot 记录驻留数据或文件位置）。Slot 值初始化后表示空槽，并且可以直接拷贝。
+// 派生容器的析构函数要先释放所有块，指针数组本身由这里释放。
+template <class Slot, size_t BlockSize>
+class block_map
+{
+protected:
+    static const size_t BLOCK_SIZE = BlockSize;
+    static const size_t MAP_INIT_SIZE = 8;
+
+    Slot* m_map = nullptr;
+    size_t m_map_size = 0;
+    size_t m_start_block = 0;   //第一个元素所在块
+    size_t m_start_index = 0;   //第一个元素在块内的位置
+    size_t m_size = 0;
+
+    block_map() = default;
+    block_map(const block_map&) = delete;
+    block_map& operator=(const block_map&) = delete;
+    ~block_map() { delete[] m_map; }
+
+    //最后一个元素所在块（空时为 m_start_block）
+    size_t last_block() const {
+        return m_size == 0 ? m_start_block : m_start_block + (m_start_index + m_size - 1) / BLOCK_SIZE;
+    }
+
+    //尾部下一个元素的槽位，必要时分配或扩大指针数组；index 返回块内位置。
+    //调用方放好元素后自己 ++m_size
+    size_t back_slot(size_t& index);
+    //头部前一个元素的槽位和块内位置；调用方放好元素后调用 commit_front
+    size_t front_slot(size_t& index);
+    void commit_front(size_t slot, size_t index) {
+        m_start_block = slot;
+        m_start_index = index;
+        ++m_size;
+    }
+    //所有块释放之后回到指针数组中部
+    void reset_position() {
+        m_size = 0;
+        m_start_block = m_map_size / 2;
+        m_start_index = 0;
+    }
+
+    void allocate_map(size_t map_size);
+    //指针数组两端没有空槽时扩大或重新居中；m_start_block 随之改变
+    void reallocate_map(bool add_at_front);
+    void swap_map(block_map& other) noexcept;
+};
+template <class Slot, size_t BlockSize>
+const size_t block_map<Slot, BlockSize>::BLOCK_SIZE;
+template <class Slot, size_t BlockSize>
+const size_t block_map<Slot, BlockSize>::MAP_INIT_SIZE;
+
+
+template <class Slot, size_t BlockSize>
+size_t block_map<Slot, BlockSize>::back_slot(size_t& index)
+{
+    if (m_map == nullptr) {
+        allocate_map(MAP_INIT_SIZE);
+        m_start_block = MAP_INIT_SIZE / 2;
+    }
+    size_t pos = m_start_index + m_size;
+    if (m_start_block + pos / BLOCK_SIZE >= m_map_size) {
+        reallocate_map(false);
+    }
+    index = pos % BLOCK_SIZE;
+    return m_start_block + pos / BLOCK_SIZE;
+}
+
+template <class Slot, size_t BlockSize>
+size_t block_map<Slot, BlockSize>::front_slot(size_t& index)
+{
+    if (m_map == nullptr) {
+        allocate_map(MAP_INIT_SIZE);
+        m_start_block = MAP_INIT_SIZE / 2;
+    }
+    if (m_start_index == 0 && m_start_block == 0) {
+        reallocate_map(true);
+    }
+    index = m_start_index == 0 ? BLOCK_SIZE - 1 : m_start_index - 1;
+    return m_start_index == 0 ? m_start_block - 1 : m_start_block;
+}
+
+template <class Slot, size_t BlockSize>
+void block_map<Slot, BlockSize>::allocate_map(size_t map_size)
+{
+    m_map = new Slot[map_size]();
+    m_map_size = map_size;
+}
+
+template <class Slot, size_t BlockSize>
+void block_map<Slot, BlockSize>::reallocate_map(bool add_at_front)
+{
+    //保留 [m_start_block, 尾后位置所在块]，并在需要的一端至少空出一个槽位
+    size_t used_blocks = (m_start_index + m_size) / BLOCK_SIZE + 1;
+    size_t needed_blocks = used_blocks + 1;
+    size_t new_map_size = m_map_size;
+    if (needed_blocks * 2 > m_map_size) {
+        new_map_size = std::max(m_map_size * 2, needed_blocks * 2);
+    }
+    size_t new_start_block = (new_map_size - needed_blocks) / 2 + (add_at_front ? 1 : 0);
+
+    Slot* new_map = new Slot[new_map_size]();
+    std::copy(m_map + m_start_block, m_map + std::min(m_start_block + used_blocks, m_map_size),
+              new_map + new_start_block);
+    delete[] m_map;
+    m_map = new_map;
+    m_map_size = new_map_size;
+    m_start_block = new_start_block;
+}
+
+template <class Slot, size_t BlockSize>
+void block_map<Slot, BlockSize>::swap_map(block_map& other) noexcept
+{
+    std::swap(m_map, other.m_map);
+    std::swap(m_map_size, other.m_map_size);
+    std::swap(m_start_block, other.m_start_block);
+    std::swap(m_start_index, other.m_start_index);
+    std::swap(m_size, other.m_size);
+}
@@ -0,0 +1,333 @@
+#pragma once
+#include<iostream>
+#include <stdexcept>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <utility>
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include "deque.hpp"
+
+// 分块字节流缓冲区：按 deque 的思路把字节放在固定大小的块里，块指针存在一个 deque<char*> 中。
+// 可读区域和可写区域都以 iovec 数组的形式给出，readv / writev 直接在块里读写，不需要先拼成连续数组：
+//     byte_buffer<> buf;
+//     buf.read_from(fd);                         //readv 进缓冲区尾部
+//     iovec iov[8];
+//     size_t k = buf.peek(0, 64, iov, 8);        //零拷贝查看前 64 字节（可以跨块）
+//     buf.write_to(fd);                          //writev 发出，发出多少就 consume 多少
+// 手动读写使用 prepare / commit / consume：
+//     size_t k = buf.prepare(4096, iov, 8);     //保证尾部至少有 4096 字节可写，返回可写区域
+//     ssize_t n = readv(fd, iov, k);
+//     if (n > 0) buf.commit(n);                  //把写进去的 n 字节变成可读
+//     buf.consume(m);                            //丢掉开头 m 个已处理的字节
+// prepare 返回的可写区域在下一次 prepare / commit / consume 之前有效；peek 返回的可读区域在下一次 consume 之前有效。
+// 读空的块在尾部的备用容量不足 MAX_SPARE_BLOCKS 块时挪到尾部复用，否则释放。
+// read_from / write_to 的返回值与 readv / writev 相同：出错返回 -1 并保留 errno（EAGAIN 等由调用方处理）。
+
+template <size_t BlockBytes = 16 * 1024>
+class byte_buffer
+{
+    static_assert(BlockBytes > 0, "byte_buffer: 块大小至少为 1");
+
+public:
+    static const size_t BLOCK_BYTES = BlockBytes;
+    //尾部最多保留的空闲块数
+    static const size_t MAX_SPARE_BLOCKS = 4;
+    //read_from / write_to 一次最多使用的 iovec 个数
+    static const size_t MAX_IOV = 64;
+
+private:
+    deque<char*> m_blocks;
+    size_t m_begin = 0;     //第一个可读字节在 m_blocks[0] 中的偏移
+    size_t m_size = 0;      //可读字节数
+
+public:
+    byte_buffer() = default;
+    byte_buffer(byte_buffer&& other) noexcept;
+    byte_buffer& operator=(byte_buffer&& other) noexcept;
+    byte_buffer(const byte_buffer&) = delete;
+    byte_buffer& operator=(const byte_buffer&) = delete;
+    ~byte_buffer();
+
+    //大小
+    bool empty() const { return m_size == 0; }
+    size_t size() const { return m_size; }
+    //不再分配就能写入的字节数
+    size_t writable() const { return m_blocks.size() * BLOCK_BYTES - (m_begin + m_size); }
+
+    //写入：保证至少 n 字节可写，把可写区域（可能多于 n）填进 iov，返回用到的 iovec 个数
+    size_t prepare(size_t n, iovec* iov, size_t max_iov);
+    //把可写区域开头的 n 字节变为可读，n 不能超过 writable()
+    void commit(size_t n);
+    //拷贝写入
+    void append(const void* data, size_t n);
+
+    //读取：从可读区域第 offset 字节开始的至多 n 字节填进 iov，不拷贝、不消费，返回用到的 iovec 个数
+    size_t peek(size_t offset, size_t n, iovec* iov, size_t max_iov) const;
+    //拷贝出从 offset 开始的至多 n 字节，不消费，返回拷贝的字节数
+    size_t copy_out(void* dest, size_t n, size_t offset = 0) const;
+    //丢掉开头的 n 字节，n 不能超过 size()
+    void consume(size_t n);
+    //拷贝出开头的至多 n 字节并消费，返回字节数
+    size_t read(void* dest, size_t n);
+    //单个字节
+    char operator[](size_t index) const;
+    void clear();
+
+    //与文件描述符之间的分散 / 聚集 I/O
+    //readv 最多 max_bytes 字节到尾部
+    ssize_t read_from(int fd, size_t max_bytes = BLOCK_BYTES * 4);
+    //writev 最多 max_bytes 字节，写出的部分被消费
+    ssize_t write_to(int fd, size_t max_bytes = size_t(-1));
+
+    void swap(byte_buffer& other) noexcept;
+
+private:
+    //保证至少 n 字节可写
+    void reserve(size_t n);
+    //把读空的 m_blocks[0] 挪到尾部备用或释放
+    void retire_front_block();
+};
+template <size_t BlockBytes>
+const size_t byte_buffer<BlockBytes>::BLOCK_BYTES;
+template <size_t BlockBytes>
+const size_t byte_buffer<BlockBytes>::MAX_SPARE_BLOCKS;
+template <size_t BlockBytes>
+const size_t byte_buffer<BlockBytes>::MAX_IOV;
+
+
+template <size_t BlockBytes>
+byte_buffer<BlockBytes>::byte_buffer(byte_buffer&& other) noexcept
+{
+    swap(other);
+}
+
+template <size_t BlockBytes>
+byte_buffer<BlockBytes>& byte_buffer<BlockBytes>::operator=(byte_buffer&& other) noexcept
+{
+    if (this != &other) {
+        byte_buffer temp(std::move(other));
+        swap(temp);
+    }
+    return *this;
+}
+
+template <size_t BlockBytes>
+byte_buffer<BlockBytes>::~byte_buffer()
+{
+    for (size_t i = 0; i < m_blocks.size(); ++i) {
+        delete[] m_blocks[i];
+    }
+}
+
+template <size_t BlockBytes>
+void byte_buffer<BlockBytes>::swap(byte_buffer& other) noexcept
+{
+    m_blocks.swap(other.m_blocks);
+    std::swap(m_begin, other.m_begin);
+    std::swap(m_size, other.m_size);
+}
+
+
+//写入
+template <size_t BlockBytes>
+size_t byte_buffer<BlockBytes>::prepare(size_t n, iovec* iov, size_t max_iov)
+{
+    reserve(n);
+    size_t end = m_begin + m_size;
+    size_t count = 0;
+    for (size_t block = end / BLOCK_BYTES; block < m_blocks.size() && count < max_iov; ++block) {
+        size_t offset = block == end / BLOCK_BYTES ? end % BLOCK_BYTES : 0;
+        iov[count].iov_base = m_blocks[block] + offset;
+        iov[count].iov_len = BLOCK_BYTES - offset;
+        ++count;
+    }
+    return count;
+}
+
+template <size_t BlockBytes>
+void byte_buffer<BlockBytes>::commit(size_t n)
+{
+    if (n > writable()) {
+        throw std::out_of_range("byte_buffer::commit: more bytes than prepared");
+    }
+    m_size += n;
+}
+
+template <size_t BlockBytes>
+void byte_buffer<BlockBytes>::append(const void* data, size_t n)
+{
+    reserve(n);
+    const char* src = static_cast<const char*>(data);
+    size_t end = m_begin + m_size;
+    while (n > 0) {
+        size_t offset = end % BLOCK_BYTES;
+        size_t len = std::min(n, BLOCK_BYTES - offset);
+        std::memcpy(m_blocks[end / BLOCK_BYTES] + offset, src, len);
+        src += len;
+        end += len;
+        n -= len;
+        m_size += len;
+    }
+}
+
+
+//读取
+template <size_t BlockBytes>
+size_t byte_buffer<BlockBytes>::peek(size_t offset, size_t n, iovec* iov, size_t max_iov) const
+{
+    if (offset >= m_size) {
+        return 0;
+    }
+    n = std::min(n, m_size - offset);
+    size_t pos = m_begin + offset;
+    size_t count = 0;
+    while (n > 0 && count < max_iov) {
+        size_t in_block = pos % BLOCK_BYTES;
+        size_t len = std::min(n, BLOCK_BYTES - in_block);
+        iov[count].iov_base = m_blocks[pos / BLOCK_BYTES] + in_block;
+        iov[count].iov_len = len;
+        ++count;
+        pos += len;
+        n -= len;
+    }
+    return count;
+}
+
+template <size_t BlockBytes>
+size_t byte_buffer<BlockBytes>::copy_out(void* dest, size_t n, size_t offset) const
+{
+    if (offset >= m_size) {
+        return 0;
+    }
+    n = std::min(n, m_size - offset);
+    char* out = static_cast<char*>(dest);
+    size_t pos = m_begin + offset;
+    for (size_t remaining = n; remaining > 0;) {
+        size_t in_block = pos % BLOCK_BYTES;
+        size_t len = std::min(remaining, BLOCK_BYTES - in_block);
+        std::memcpy(out, m_blocks[pos / BLOCK_BYTES] + in_block, len);
+        out += len;
+        pos += len;
+        remaining -= len;
+    }
+    return n;
+}
+
+template <size_t BlockBytes>
+void byte_buffer<BlockBytes>::consume(size_t n)
+{
+    if (n > m_size) {
+        throw std::out_of_range("byte_buffer::consume: more bytes than readable");
+    }
+    m_size -= n;
+    m_begin += n;
+    while (m_begin >= BLOCK_BYTES) {
+        retire_front_block();
+        m_begin -= BLOCK_BYTES;
+    }
+    //读空后从块开头重新写，让下一次可写区域尽量连续
+    if (m_size == 0) {
+        m_begin = 0;
+    }
+}
+
+template <size_t BlockBytes>
+size_t byte_buffer<BlockBytes>::read(void* dest, size_t n)
+{
+    n = copy_out(dest, n);
+    consume(n);
+    return n;
+}
+
+template <size_t BlockBytes>
+char byte_buffer<BlockBytes>::operator[](size_t index) const
+{
+    STL_ACCESS_CHECK(index < m_size, "byte_buffer::operator[]: index out of range");
+    size_t pos = m_begin + index;
+    return m_blocks[pos / BLOCK_BYTES][pos % BLOCK_BYTES];
+}
+
+template <size_t BlockBytes>
+void byte_buffer<BlockBytes>::clear()
+{
+    consume(m_size);
+}
+
+
+//分散 / 聚集 I/O
+template <size_t BlockBytes>
+ssize_t byte_buffer<BlockBytes>::read_from(int fd, size_t max_bytes)
+{
+    iovec iov[MAX_IOV];
+    size_t count = prepare(std::min(max_bytes, MAX_IOV * BLOCK_BYTES), iov, MAX_IOV);
+    //只读 max_bytes：截短最后用到的 iovec
+    size_t total = 0;
+    size_t used = 0;
+    while (used < count && total < max_bytes) {
+        iov[used].iov_len = std::min(iov[used].iov_len, max_bytes - total);
+        total += iov[used].iov_len;
+        ++used;
+    }
+    ssize_t n;
+    do {
+        n = readv(fd, iov, static_cast<int>(used));
+    } while (n < 0 && errno == EINTR);
+    if (n > 0) {
+        commit(static_cast<size_t>(n));
+    }
+    return n;
+}
+
+template <size_t BlockBytes>
+ssize_t byte_buffer<BlockBytes>::write_to(int fd, size_t max_bytes)
+{
+    iovec iov[MAX_IOV];
+    size_t count = peek(0, max_bytes, iov, MAX_IOV);
+    if (count == 0) {
+        return 0;
+    }
+    ssize_t n;
+    do {
+        n = writev(fd, iov, static_cast<int>(count));
+    } while (n < 0 && errno == EINTR);
+    if (n > 0) {
+        consume(static_cast<size_t>(n));
+    }
+    return n;
+}
+
+
+//辅助函数
+template <size_t BlockBytes>
+void byte_buffer<BlockBytes>::reserve(size_t n)
+{
+    while (writable() < n) {
+        char* block = new char[BLOCK_BYTES];
+        try {
+            m_blocks.push_back(block);
+        } catch (...) {
+            delete[] block;
+            throw;
+        }
+    }
+}
+
+template <size_t BlockBytes>
+void byte_buffer<BlockBytes>::retire_front_block()
+{
+    char* block = m_blocks.front();
+    m_blocks.pop_front();
+    size_t end = m_begin - BLOCK_BYTES + m_size;    //挪走后尾部位置相对新的 m_blocks[0]
+    size_t spare_blocks = m_blocks.size() - end / BLOCK_BYTES;
+    if (spare_blocks <= MAX_SPARE_BLOCKS) {
+        try {
+            m_blocks.push_back(block);
+            return;
+        } catch (...) {
+        }
+    }
+    delete[] block;
+}
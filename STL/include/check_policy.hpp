@@ -0,0 +1,27 @@
+#pragma once
+#include <cassert>
+#include <stdexcept>
+
+// 容器访问检查策略，由构建宏 STL_CHECK_LEVEL 统一控制：
+//   STL_CHECK_NONE   (0)：不检查，operator[]、front()、back() 和迭代器解引用只做地址计算
+//   STL_CHECK_ASSERT (1)：用 assert 检查，定义 NDEBUG 的发布构建中与 NONE 相同（默认）
+//   STL_CHECK_THROW  (2)：总是检查，失败时抛出 out_of_range
+// at() 不受此策略影响，始终检查并抛出异常。
+// 同一程序的所有翻译单元必须使用相同的级别。
+
+#define STL_CHECK_NONE   0
+#define STL_CHECK_ASSERT 1
+#define STL_CHECK_THROW  2
+
+#ifndef STL_CHECK_LEVEL
+#define STL_CHECK_LEVEL STL_CHECK_ASSERT
+#endif
+
+#if STL_CHECK_LEVEL == STL_CHECK_THROW
+#define STL_ACCESS_CHECK(cond, msg) \
+    do { if (!(cond)) { throw std::out_of_range(msg); } } while (0)
+#elif STL_CHECK_LEVEL == STL_CHECK_ASSERT
+#define STL_ACCESS_CHECK(cond, msg) assert((cond) && msg)
+#else
+#define STL_ACCESS_CHECK(cond, msg) ((void)0)
+#endif
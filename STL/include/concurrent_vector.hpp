@@ -0,0 +1,251 @@
+#pragma once
+#include<iostream>
+#include <stdexcept>
+#include <atomic>
+#include <cstdint>
+#include <utility>
+#include <new>
+
+// 支持多线程并发追加的分段 vector
+// 与 deque 的 m_map 类似，元素存放在一组数据块（段）中，但段的大小按 2 的幂递增：
+// 第 k 段容纳 FIRST_SEGMENT << k 个元素，段指针表大小固定，永远不需要重新分配。
+//   - push_back 用 fetch_add 原子地预留下标，再在对应位置构造元素，多个写线程互不阻塞；
+//   - 元素构造后永不移动，引用和指针在容器销毁前一直有效；
+//   - operator[] 只做两次内存读取（段指针 + 元素），无等待。
+// 读线程只能访问已经发布的元素：push_back 返回的下标，或 ready(i) 为 true 的下标。
+// 析构、clear() 不能与其他操作并发。
+template <class T>
+class concurrent_vector
+{
+private:
+
+    static const size_t FIRST_SEGMENT_BITS = 6;
+    static const size_t FIRST_SEGMENT = size_t(1) << FIRST_SEGMENT_BITS;   //第 0 段的元素个数
+    static const size_t MAX_SEGMENTS = 48;
+
+    //每个段是一块内存：[元素区 | 发布标记区]
+    std::atomic<char*> m_segments[MAX_SEGMENTS];
+    alignas(64) std::atomic<size_t> m_reserved{0};   //已预留的下标个数
+
+public:
+
+    //构造
+    concurrent_vector();
+    concurrent_vector(const concurrent_vector&) = delete;
+    concurrent_vector& operator=(const concurrent_vector&) = delete;
+
+    //析构
+    ~concurrent_vector();
+
+    //尾插，返回新元素的下标
+    size_t push_back(const T& val);
+    size_t push_back(T&& val);
+    template <class... Args>
+    size_t emplace_back(Args&&... args);
+
+    //大小：已预留的下标个数，其中可能有元素仍在构造中
+    size_t size() const { return m_reserved.load(std::memory_order_acquire); }
+    bool empty() const { return size() == 0; }
+    //下标 index 处的元素是否已构造完成并发布
+    bool ready(size_t index) const;
+
+    //数据存取
+    const T& operator[](size_t index) const;
+    T& operator[](size_t index);
+    const T& at(size_t index) const;
+    T& at(size_t index);
+
+    //清空（非并发）
+    void clear();
+
+private:
+    //下标 -> (段号, 段内偏移)
+    static size_t segment_of(size_t index, size_t& offset);
+    static size_t segment_capacity(size_t segment) { return FIRST_SEGMENT << segment; }
+    static std::atomic<unsigned char>* flags_of(char* segment_mem, size_t segment) {
+        return reinterpret_cast<std::atomic<unsigned char>*>(segment_mem + segment_capacity(segment) * sizeof(T));
+    }
+
+    char* ensure_segment(size_t segment);
+    char* allocate_segment(size_t segment);
+    void free_segment(char* mem, size_t segment, bool destroy_values);
+
+    template <class... Args>
+    size_t construct_back(Args&&... args);
+};
+
+template <class T>
+const size_t concurrent_vector<T>::FIRST_SEGMENT;
+
+//构造
+template <class T>
+concurrent_vector<T>::concurrent_vector()
+{
+    for (size_t i = 0; i < MAX_SEGMENTS; ++i) {
+        m_segments[i].store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+//析构
+template <class T>
+concurrent_vector<T>::~concurrent_vector()
+{
+    clear();
+}
+
+//尾插
+template <class T>
+size_t concurrent_vector<T>::push_back(const T& val)
+{
+    return construct_back(val);
+}
+
+template <class T>
+size_t concurrent_vector<T>::push_back(T&& val)
+{
+    return construct_back(std::move(val));
+}
+
+template <class T>
+template <class... Args>
+size_t concurrent_vector<T>::emplace_back(Args&&... args)
+{
+    return construct_back(std::forward<Args>(args)...);
+}
+
+//预留下标 -> 确保段存在 -> 构造 -> 发布
+//构造抛出异常时该下标永远不会发布，ready() 一直返回 false
+template <class T>
+template <class... Args>
+size_t concurrent_vector<T>::construct_back(Args&&... args)
+{
+    size_t index = m_reserved.fetch_add(1, std::memory_order_relaxed);
+    size_t offset;
+    size_t segment = segment_of(index, offset);
+    if (segment >= MAX_SEGMENTS) {
+        throw std::length_error("concurrent_vector::push_back: too many elements");
+    }
+    char* mem = ensure_segment(segment);
+    new (reinterpret_cast<T*>(mem) + offset) T(std::forward<Args>(args)...);
+    flags_of(mem, segment)[offset].store(1, std::memory_order_release);
+    return index;
+}
+
+template <class T>
+bool concurrent_vector<T>::ready(size_t index) const
+{
+    size_t offset;
+    size_t segment = segment_of(index, offset);
+    if (segment >= MAX_SEGMENTS) {
+        return false;
+    }
+    char* mem = m_segments[segment].load(std::memory_order_acquire);
+    return mem != nullptr && flags_of(mem, segment)[offset].load(std::memory_order_acquire) != 0;
+}
+
+//数据存取
+template <class T>
+const T& concurrent_vector<T>::operator[](size_t index) const
+{
+    size_t offset;
+    size_t segment = segment_of(index, offset);
+    return reinterpret_cast<const T*>(m_segments[segment].load(std::memory_order_acquire))[offset];
+}
+
+template <class T>
+T& concurrent_vector<T>::operator[](size_t index)
+{
+    size_t offset;
+    size_t segment = segment_of(index, offset);
+    return reinterpret_cast<T*>(m_segments[segment].load(std::memory_order_acquire))[offset];
+}
+
+template <class T>
+const T& concurrent_vector<T>::at(size_t index) const
+{
+    if (index >= size()) {
+        throw std::out_of_range("concurrent_vector::at: index out of range");
+    }
+    if (!ready(index)) {
+        throw std::logic_error("concurrent_vector::at: element not yet published");
+    }
+    return (*this)[index];
+}
+
+template <class T>
+T& concurrent_vector<T>::at(size_t index)
+{
+    return const_cast<T&>(static_cast<const concurrent_vector&>(*this).at(index));
+}
+
+//清空
+template <class T>
+void concurrent_vector<T>::clear()
+{
+    for (size_t i = 0; i < MAX_SEGMENTS; ++i) {
+        char* mem = m_segments[i].load(std::memory_order_acquire);
+        if (mem) {
+            free_segment(mem, i, true);
+            m_segments[i].store(nullptr, std::memory_order_relaxed);
+        }
+    }
+    m_reserved.store(0, std::memory_order_release);
+}
+
+//辅助函数实现
+//前 k 段共容纳 FIRST_SEGMENT * (2^k - 1) 个元素，所以段号是 index / FIRST_SEGMENT + 1 的最高位
+template <class T>
+size_t concurrent_vector<T>::segment_of(size_t index, size_t& offset)
+{
+    size_t scaled = (index >> FIRST_SEGMENT_BITS) + 1;
+    size_t segment = 63 - static_cast<size_t>(__builtin_clzll(static_cast<unsigned long long>(scaled)));
+    offset = index - ((size_t(1) << segment) - 1) * FIRST_SEGMENT;
+    return segment;
+}
+
+//段由第一个需要它的写线程分配；同时分配的线程中只有一个 CAS 成功，其余释放自己的那一块
+template <class T>
+char* concurrent_vector<T>::ensure_segment(size_t segment)
+{
+    char* mem = m_segments[segment].load(std::memory_order_acquire);
+    if (mem) {
+        return mem;
+    }
+    char* fresh = allocate_segment(segment);
+    if (m_segments[segment].compare_exchange_strong(mem, fresh,
+                                                    std::memory_order_acq_rel,
+                                                    std::memory_order_acquire)) {
+        return fresh;
+    }
+    free_segment(fresh, segment, false);
+    return mem;
+}
+
+template <class T>
+char* concurrent_vector<T>::allocate_segment(size_t segment)
+{
+    size_t capacity = segment_capacity(segment);
+    //按 alignof(T) 分配，对齐要求超过 operator new 默认对齐的元素也能放
+    char* mem = static_cast<char*>(::operator new(capacity * sizeof(T) + capacity, std::align_val_t(alignof(T))));
+    std::atomic<unsigned char>* flags = flags_of(mem, segment);
+    for (size_t i = 0; i < capacity; ++i) {
+        new (flags + i) std::atomic<unsigned char>(0);
+    }
+    return mem;
+}
+
+template <class T>
+void concurrent_vector<T>::free_segment(char* mem, size_t segment, bool destroy_values)
+{
+    size_t capacity = segment_capacity(segment);
+    std::atomic<unsigned char>* flags = flags_of(mem, segment);
+    if (destroy_values) {
+        T* elems = reinterpret_cast<T*>(mem);
+        for (size_t i = 0; i < capacity; ++i) {
+            if (flags[i].load(std::memory_order_relaxed)) {
+                elems[i].~T();
+            }
+        }
+    }
+    ::operator delete(mem, std::align_val_t(alignof(T)));
+}
@@ -0,0 +1,509 @@
+#pragma once
+#include<iostream>
+#include <stdexcept>
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "check_policy.hpp"
+#include "block_map.hpp"
+
+// 写时复制（copy-on-write）的分块双端队列，用于频繁给大队列拍只读快照：
+// 数据块带引用计数，拷贝构造只复制块指针数组并给每块加一次引用，代价 O(块数)；
+// 之后任何一方要修改某个共享块（两端增删、非 const 的元素访问）时才把这一块克隆一份，
+// 所以快照占用的额外内存与快照之后实际改动过的块数成正比。
+//     cow_deque<record> log;
+//     ...
+//     cow_deque<record> snapshot(log);   //O(块数)，之后 log 可以继续在两端增删
+// 与 deque 的区别：
+//   - 只支持两端增删和按下标读写，不支持中间插入删除，只提供 const 迭代器；
+//   - 非 const 的 operator[] / at / front / back 会把所在块当作 “要写” 处理，
+//     块被共享时即使只是读也会触发克隆，只读访问请通过 const 引用；
+//   - 不保留备用块，元素离开一个块时就释放这个块。
+// 线程：同一个对象不能并发修改；但快照可以交给别的线程只读访问或析构，
+// 同时原对象继续修改——共享块从不被原地修改，引用计数是原子的。
+
+//带引用计数的数据块
+template <class T, size_t BlockSize>
+struct cow_deque_block
+{
+    std::atomic<size_t> refs{1};
+    alignas(T) unsigned char storage[BlockSize * sizeof(T)];
+
+    T* data() { return reinterpret_cast<T*>(storage); }
+};
+
+//块指针数组中只有含有元素的块非空
+template <class T>
+class cow_deque : private block_map<cow_deque_block<T, 512>*, 512>
+{
+private:
+    typedef cow_deque_block<T, 512> block;
+    typedef block_map<block*, 512> base;
+    using base::BLOCK_SIZE;
+    using base::m_map;
+    using base::m_map_size;
+    using base::m_start_block;
+    using base::m_start_index;
+    using base::m_size;
+    using base::last_block;
+    using base::allocate_map;
+
+public:
+    class const_iterator;
+
+    //构造
+    cow_deque() = default;
+    cow_deque(std::initializer_list<T> init);
+    //快照：共享所有数据块
+    cow_deque(const cow_deque& other);
+    cow_deque(cow_deque&& other) noexcept;
+    ~cow_deque();
+
+    cow_deque& operator=(const cow_deque& other);
+    cow_deque& operator=(cow_deque&& other) noexcept;
+
+    //两端增删
+    void push_back(const T& val);
+    void push_back(T&& val);
+    void push_front(const T& val);
+    void push_front(T&& val);
+    void pop_back();
+    void pop_front();
+    void clear();
+
+    //大小
+    bool empty() const { return m_size == 0; }
+    size_t size() const { return m_size; }
+
+    //只读访问不会克隆
+    const T& operator[](size_t index) const;
+    const T& at(size_t index) const;
+    const T& front() const;
+    const T& back() const;
+    //可写访问：所在块被共享时先克隆
+    T& operator[](size_t index);
+    T& at(size_t index);
+    T& front();
+    T& back();
+
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, m_size); }
+    const_iterator cbegin() const { return begin(); }
+    const_iterator cend() const { return end(); }
+
+    //当前持有的块数，以及其中与其他对象共享的块数
+    size_t block_count() const;
+    size_t shared_block_count() const;
+
+    void swap(cow_deque& other) noexcept;
+
+private:
+    T* element_at(size_t index) const {
+        size_t pos = m_start_index + index;
+        return m_map[m_start_block + pos / BLOCK_SIZE]->data() + pos % BLOCK_SIZE;
+    }
+    //本对象在 slot 块中占用的块内区间 [lo, hi)
+    void block_range(size_t slot, size_t& lo, size_t& hi) const;
+
+    //放弃对一个块的引用，最后一个引用者负责析构 [lo, hi) 并释放
+    static void release_block(block* b, size_t lo, size_t hi);
+    //保证 slot 块只被本对象持有，必要时克隆，返回块数据
+    T* writable(size_t slot);
+    //slot 为空时分配新块，否则同 writable；new_block 返回是否新分配
+    T* prepare_slot(size_t slot, bool& new_block);
+
+    template <class U>
+    void emplace_back_value(U&& val);
+    template <class U>
+    void emplace_front_value(U&& val);
+};
+
+
+//只读迭代器：按下标定位，解引用不会触发克隆
+template <class T>
+class cow_deque<T>::const_iterator
+{
+private:
+    const cow_deque<T>* m_owner = nullptr;
+    size_t m_index = 0;
+
+    friend class cow_deque<T>;
+    const_iterator(const cow_deque<T>* owner, size_t index) : m_owner(owner), m_index(index) {}
+
+public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = T;
+    using difference_type = ptrdiff_t;
+    using pointer = const T*;
+    using reference = const T&;
+
+    const_iterator() = default;
+
+    reference operator*() const {
+        STL_ACCESS_CHECK(m_index < m_owner->m_size, "cow_deque::const_iterator: dereference out of range");
+        return *m_owner->element_at(m_index);
+    }
+    pointer operator->() const { return &**this; }
+    reference operator[](difference_type n) const { return *(*this + n); }
+
+    const_iterator& operator++() { ++m_index; return *this; }
+    const_iterator operator++(int) { const_iterator temp = *this; ++m_index; return temp; }
+    const_iterator& operator--() { --m_index; return *this; }
+    const_iterator operator--(int) { const_iterator temp = *this; --m_index; return temp; }
+    const_iterator& operator+=(difference_type n) { m_index += n; return *this; }
+    const_iterator& operator-=(difference_type n) { m_index -= n; return *this; }
+    const_iterator operator+(difference_type n) const { return const_iterator(m_owner, m_index + n); }
+    const_iterator operator-(difference_type n) const { return const_iterator(m_owner, m_index - n); }
+    difference_type operator-(const const_iterator& other) const {
+        return static_cast<difference_type>(m_index) - static_cast<difference_type>(other.m_index);
+    }
+
+    bool operator==(const const_iterator& other) const { return m_index == other.m_index; }
+    bool operator!=(const const_iterator& other) const { return m_index != other.m_index; }
+    bool operator<(const const_iterator& other) const { return m_index < other.m_index; }
+    bool operator>(const const_iterator& other) const { return m_index > other.m_index; }
+    bool operator<=(const const_iterator& other) const { return m_index <= other.m_index; }
+    bool operator>=(const const_iterator& other) const { return m_index >= other.m_index; }
+};
+
+
+//构造
+template <class T>
+cow_deque<T>::cow_deque(std::initializer_list<T> init)
+{
+    try {
+        for (const T& val : init) {
+            push_back(val);
+        }
+    } catch (...) {
+        clear();
+        throw;
+    }
+}
+
+template <class T>
+cow_deque<T>::cow_deque(const cow_deque& other)
+{
+    if (other.m_map == nullptr) {
+        return;
+    }
+    allocate_map(other.m_map_size);
+    m_start_block = other.m_start_block;
+    m_start_index = other.m_start_index;
+    m_size = other.m_size;
+    if (m_size == 0) {
+        return;
+    }
+    for (size_t slot = m_start_block; slot <= last_block(); ++slot) {
+        other.m_map[slot]->refs.fetch_add(1, std::memory_order_relaxed);
+        m_map[slot] = other.m_map[slot];
+    }
+}
+
+template <class T>
+cow_deque<T>::cow_deque(cow_deque&& other) noexcept
+{
+    this->swap_map(other);
+}
+
+//指针数组由 block_map 释放
+template <class T>
+cow_deque<T>::~cow_deque()
+{
+    clear();
+}
+
+template <class T>
+cow_deque<T>& cow_deque<T>::operator=(const cow_deque& other)
+{
+    if (this != &other) {
+        cow_deque temp(other);
+        swap(temp);
+    }
+    return *this;
+}
+
+template <class T>
+cow_deque<T>& cow_deque<T>::operator=(cow_deque&& other) noexcept
+{
+    if (this != &other) {
+        cow_deque temp(std::move(other));
+        swap(temp);
+    }
+    return *this;
+}
+
+template <class T>
+void cow_deque<T>::swap(cow_deque& other) noexcept
+{
+    this->swap_map(other);
+}
+
+
+//两端增删
+template <class T>
+void cow_deque<T>::push_back(const T& val)
+{
+    emplace_back_value(val);
+}
+
+template <class T>
+void cow_deque<T>::push_back(T&& val)
+{
+    emplace_back_value(std::move(val));
+}
+
+template <class T>
+void cow_deque<T>::push_front(const T& val)
+{
+    emplace_front_value(val);
+}
+
+template <class T>
+void cow_deque<T>::push_front(T&& val)
+{
+    emplace_front_value(std::move(val));
+}
+
+template <class T>
+template <class U>
+void cow_deque<T>::emplace_back_value(U&& val)
+{
+    size_t index;
+    size_t slot = this->back_slot(index);
+    bool new_block = false;
+    T* data = prepare_slot(slot, new_block);
+    try {
+        new (data + index) T(std::forward<U>(val));
+    } catch (...) {
+        if (new_block) {
+            delete m_map[slot];
+            m_map[slot] = nullptr;
+        }
+        throw;
+    }
+    ++m_size;
+}
+
+template <class T>
+template <class U>
+void cow_deque<T>::emplace_front_value(U&& val)
+{
+    size_t index;
+    size_t slot = this->front_slot(index);
+    bool new_block = false;
+    T* data = prepare_slot(slot, new_block);
+    try {
+        new (data + index) T(std::forward<U>(val));
+    } catch (...) {
+        if (new_block) {
+            delete m_map[slot];
+            m_map[slot] = nullptr;
+        }
+        throw;
+    }
+    this->commit_front(slot, index);
+}
+
+//弹出后块空了就直接放弃引用，不必克隆；
+//元素可平凡析构时即使块还被共享也只需缩小本对象的区间，快照里的那份不受影响
+template <class T>
+void cow_deque<T>::pop_back()
+{
+    if (empty()) {
+        throw std::out_of_range("cow_deque::pop_back: cow_deque is empty");
+    }
+    size_t slot = last_block();
+    size_t pos = (m_start_index + m_size - 1) % BLOCK_SIZE;
+    size_t lo, hi;
+    block_range(slot, lo, hi);
+    if (hi - lo == 1) {
+        release_block(m_map[slot], lo, hi);
+        m_map[slot] = nullptr;
+    } else if (!std::is_trivially_destructible<T>::value) {
+        writable(slot)[pos].~T();
+    }
+    --m_size;
+}
+
+template <class T>
+void cow_deque<T>::pop_front()
+{
+    if (empty()) {
+        throw std::out_of_range("cow_deque::pop_front: cow_deque is empty");
+    }
+    size_t slot = m_start_block;
+    size_t lo, hi;
+    block_range(slot, lo, hi);
+    if (hi - lo == 1) {
+        release_block(m_map[slot], lo, hi);
+        m_map[slot] = nullptr;
+    } else if (!std::is_trivially_destructible<T>::value) {
+        writable(slot)[m_start_index].~T();
+    }
+    if (++m_start_index == BLOCK_SIZE) {
+        m_start_index = 0;
+        ++m_start_block;
+    }
+    --m_size;
+}
+
+template <class T>
+void cow_deque<T>::clear()
+{
+    if (m_size == 0) {
+        return;
+    }
+    for (size_t slot = m_start_block; slot <= last_block(); ++slot) {
+        size_t lo, hi;
+        block_range(slot, lo, hi);
+        release_block(m_map[slot], lo, hi);
+        m_map[slot] = nullptr;
+    }
+    this->reset_position();
+}
+
+
+//数据存取
+template <class T>
+const T& cow_deque<T>::operator[](size_t index) const
+{
+    STL_ACCESS_CHECK(index < m_size, "cow_deque::operator[]: index out of range");
+    return *element_at(index);
+}
+
+template <class T>
+const T& cow_deque<T>::at(size_t index) const
+{
+    if (index >= m_size) {
+        throw std::out_of_range("cow_deque::at: index out of range");
+    }
+    return *element_at(index);
+}
+
+template <class T>
+const T& cow_deque<T>::front() const
+{
+    STL_ACCESS_CHECK(m_size > 0, "cow_deque::front: cow_deque is empty");
+    return *element_at(0);
+}
+
+template <class T>
+const T& cow_deque<T>::back() const
+{
+    STL_ACCESS_CHECK(m_size > 0, "cow_deque::back: cow_deque is empty");
+    return *element_at(m_size - 1);
+}
+
+template <class T>
+T& cow_deque<T>::operator[](size_t index)
+{
+    STL_ACCESS_CHECK(index < m_size, "cow_deque::operator[]: index out of range");
+    size_t pos = m_start_index + index;
+    return writable(m_start_block + pos / BLOCK_SIZE)[pos % BLOCK_SIZE];
+}
+
+template <class T>
+T& cow_deque<T>::at(size_t index)
+{
+    if (index >= m_size) {
+        throw std::out_of_range("cow_deque::at: index out of range");
+    }
+    return (*this)[index];
+}
+
+template <class T>
+T& cow_deque<T>::front()
+{
+    STL_ACCESS_CHECK(m_size > 0, "cow_deque::front: cow_deque is empty");
+    return (*this)[0];
+}
+
+template <class T>
+T& cow_deque<T>::back()
+{
+    STL_ACCESS_CHECK(m_size > 0, "cow_deque::back: cow_deque is empty");
+    return (*this)[m_size - 1];
+}
+
+template <class T>
+size_t cow_deque<T>::block_count() const
+{
+    return m_size == 0 ? 0 : last_block() - m_start_block + 1;
+}
+
+template <class T>
+size_t cow_deque<T>::shared_block_count() const
+{
+    size_t shared = 0;
+    for (size_t slot = m_start_block; slot < m_start_block + block_count(); ++slot) {
+        if (m_map[slot]->refs.load(std::memory_order_acquire) > 1) {
+            ++shared;
+        }
+    }
+    return shared;
+}
+
+
+//辅助函数
+template <class T>
+void cow_deque<T>::block_range(size_t slot, size_t& lo, size_t& hi) const
+{
+    size_t begin = m_start_index;                    //相对 m_start_block 第 0 个位置
+    size_t end = m_start_index + m_size;
+    size_t slot_begin = (slot - m_start_block) * BLOCK_SIZE;
+    lo = std::max(begin, slot_begin) - slot_begin;
+    hi = std::min(end, slot_begin + BLOCK_SIZE) - slot_begin;
+}
+
+template <class T>
+void cow_deque<T>::release_block(block* b, size_t lo, size_t hi)
+{
+    if (b->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        T* data = b->data();
+        for (size_t i = lo; i < hi; ++i) {
+            data[i].~T();
+        }
+        delete b;
+    }
+}
+
+template <class T>
+T* cow_deque<T>::writable(size_t slot)
+{
+    block* shared = m_map[slot];
+    if (shared->refs.load(std::memory_order_acquire) == 1) {
+        return shared->data();
+    }
+    size_t lo, hi;
+    block_range(slot, lo, hi);
+    block* copy = new block;
+    try {
+        std::uninitialized_copy(shared->data() + lo, shared->data() + hi, copy->data() + lo);
+    } catch (...) {
+        delete copy;
+        throw;
+    }
+    m_map[slot] = copy;
+    //其他持有者可能在此期间放弃了引用，所以这里也可能是最后一个
+    release_block(shared, lo, hi);
+    return copy->data();
+}
+
+template <class T>
+T* cow_deque<T>::prepare_slot(size_t slot, bool& new_block)
+{
+    if (m_map[slot] == nullptr) {
+        m_map[slot] = new block;
+        new_block = true;
+        return m_map[slot]->data();
+    }
+    new_block = false;
+    return writable(slot);
+}
@@ -4,10 +4,48 @@
 #include <initializer_list>
 #include <utility>
 #include <algorithm>
+#include <iterator>
+#include <string>
+#include <cstring>
+#include <memory>
+#include <type_traits>
 #include "vector.hpp"
+#include "check_policy.hpp"
+#include "instrument.hpp"
+#include "prefetch.hpp"
+
+
+// 分块存储的双端队列：m_map 是块指针数组，每块容纳 BLOCK_SIZE 个元素。
+// 元素占据从 (m_start_block, m_start_index) 开始的 m_size 个连续逻辑位置。
+// 不变量：
+//   - m_map 不为空时，覆盖 [首元素, 尾后位置] 的所有块都已分配（尾后位置所在的块也已分配，
+//     所以 end() 和迭代器跨块移动永远不会解引用空块）；
+//   - 这个范围之外的块可以是空指针，也可以是留作备用的已分配块；
+//   - m_map 为空当且仅当从未分配过（或已被移走），此时 m_size == 0；
+//   - m_map 两侧各有 MAP_GUARD 个恒为空的保护槽位，迭代器跨块时读前方第 PREFETCH_BLOCKS 块的指针不会越界。
+// 两端的备用块由 ReleasePolicy 决定保留多少，见 deque_spare_policy。
+
+//块释放策略：弹出元素后，某一端的备用块超过 SpareBlocks + SlackBlocks 个时，释放到只剩 SpareBlocks 个。
+//SlackBlocks 是滞后量：队列长度在几个块的范围内来回波动时既不反复申请释放，
+//一次突发之后占用的内存也不会一直停在峰值。默认每端保留两块、无滞后。
+template <size_t SpareBlocks, size_t SlackBlocks = 0>
+struct deque_spare_policy
+{
+    static const size_t SPARE_BLOCKS = SpareBlocks;
+    static const size_t SLACK_BLOCKS = SlackBlocks;
 
+    //某一端已有 spare_blocks 个备用块时是否需要释放
+    static bool should_release_block(size_t spare_blocks)
+    {
+        return spare_blocks > SPARE_BLOCKS + SLACK_BLOCKS;
+    }
+};
+template <size_t SpareBlocks, size_t SlackBlocks>
+const size_t deque_spare_policy<SpareBlocks, SlackBlocks>::SPARE_BLOCKS;
+template <size_t SpareBlocks, size_t SlackBlocks>
+const size_t deque_spare_policy<SpareBlocks, SlackBlocks>::SLACK_BLOCKS;
 
-template <class T>
+template <class T, class ReleasePolicy = deque_spare_policy<2> >
 class deque
 {
 private:
@@ -15,12 +53,20 @@ private:
     //分块参数大小
     static const size_t BLOCK_SIZE = 512;
     static const size_t MAP_INIT_SIZE = 8;
+    //预取距离（块数）和指针数组的保护槽位数，见 prefetch.hpp
+    static const size_t PREFETCH_BLOCKS = STL_PREFETCH_BLOCKS;
+    static const size_t MAP_GUARD = PREFETCH_BLOCKS;
+    //迭代器跨块时预取目标块开头（或结尾）的字节数，之后交给硬件预取器
+    static const size_t PREFETCH_EDGE_BYTES = std::min<size_t>(4 * STL_CACHE_LINE, BLOCK_SIZE * sizeof(T));
 
-    T** m_map ;             //指针数组，每个指向一个数据块；
-    size_t m_map_size;      //指针数组的大小
-    size_t m_start_block;   //第一个有效数据块索引
-    size_t m_start_index;   //第一个有效元素索引；
-    size_t m_size;          //元素总数；
+    T** m_map = nullptr;        //指针数组，每个指向一个数据块；
+    size_t m_map_size = 0;      //指针数组的大小
+    size_t m_start_block = 0;   //第一个有效数据块索引
+    size_t m_start_index = 0;   //第一个有效元素索引；
+    size_t m_size = 0;          //元素总数；
+
+    //可平凡拷贝的类型拷贝和赋值时整段 memmove，并在赋值时复用已有的块
+    static const bool TRIVIAL = std::is_trivially_copyable<T>::value;
 
 public:
 
@@ -31,26 +77,24 @@ public:
     //构造
     deque () = default;
     deque (const size_t n, const T& val);
-    deque (const deque<T>& other);
-
-    
+    deque (const deque<T, ReleasePolicy>& other);
 
     //移动构造
-    deque(deque<T>&& other) noexcept;
+    deque(deque<T, ReleasePolicy>&& other) noexcept;
 
     //初始化列表
     deque(std::initializer_list<T> init);
 
     //析构
-    ~deque ()=default;
-    
+    ~deque ();
+
     //赋值
-    deque<T>& operator =(const deque<T>& other);
-    deque<T>& operator =(deque<T>&& other) noexcept;
-    deque<T>& operator =(std::initializer_list<T> init);
+    deque<T, ReleasePolicy>& operator =(const deque<T, ReleasePolicy>& other);
+    deque<T, ReleasePolicy>& operator =(deque<T, ReleasePolicy>&& other) noexcept;
+    deque<T, ReleasePolicy>& operator =(std::initializer_list<T> init);
 
     void assign(size_t n, const T&val);
-    void assign (T* begin_ptr, T* end_ptr);
+    void assign (const T* begin_ptr, const T* end_ptr);
     void assign(std::initializer_list<T> init);
 
     //尾插和尾删//头插和头删
@@ -67,6 +111,12 @@ public:
     size_t max_size() const {return size_t(-1);};
     void resize (size_t new_size );
     void resize (size_t new_size, const T& val);
+    //预留空间：之后尾部（头部）再放 n 个元素不需要分配块。预留出来的块算作备用块，
+    //在弹出元素时同样受 ReleasePolicy 约束
+    void reserve_back(size_t n);
+    void reserve_front(size_t n);
+    //释放两端所有备用块，并把指针数组缩到刚好容纳现有的块
+    void shrink_to_fit();
 
     //插入和删除
     iterator insert( iterator position , const T& val);
@@ -94,56 +144,116 @@ public:
     const_iterator end() const;
     const_iterator cend() const;
 
+    //按块顺序访问所有元素：f(T&)（const 版本为 f(const T&)）。
+    //每处理一条缓存行，预取前方（for_each_reverse 为后方）第 prefetch_blocks 块中同一位置的缓存行，
+    //0 表示不预取。长扫描且每个元素的计算量很小时可以调大距离
+    template <class F>
+    void for_each(F f, size_t prefetch_blocks = PREFETCH_BLOCKS);
+    template <class F>
+    void for_each(F f, size_t prefetch_blocks = PREFETCH_BLOCKS) const;
+    template <class F>
+    void for_each_reverse(F f, size_t prefetch_blocks = PREFETCH_BLOCKS);
+    template <class F>
+    void for_each_reverse(F f, size_t prefetch_blocks = PREFETCH_BLOCKS) const;
+
+    //按块内连续段依次处理所有元素：f(const T* first, size_t len)，用于批量写出
+    template <class F>
+    void for_each_segment(F f) const;
+    //在尾部预留 n 个元素的空间，按块内连续段依次交给 f(T* dst, size_t len) 填充，
+    //f 返回实际写入的个数；某一段没有填满时停止。返回总共提交的个数，只支持平凡类型
+    template <class F>
+    size_t append_with(size_t n, F f);
+
     //交换
-    void swap(deque<T>& other) noexcept;
+    void swap(deque<T, ReleasePolicy>& other) noexcept;
+
+    //拆分与拼接：整块移交块指针，只有边界上的那一块需要搬动元素（搬较少的一侧）
+    //split_at(k)：返回由 [k, size()) 组成的新 deque，本对象保留 [0, k)，代价 O(块数)
+    deque<T, ReleasePolicy> split_at(size_t k);
+    //把 other 的全部元素接到尾部 / 头部，other 变为空。
+    //两边块内偏移对齐时（例如拼回 split_at 拆出的部分，或一方为空）代价 O(块数)，
+    //否则逐个移动两者中较短的一方
+    void splice_back(deque<T, ReleasePolicy>&& other);
+    void splice_front(deque<T, ReleasePolicy>&& other);
 
 private:
     //重新分配内存辅助函数：
     T* allocate_block() {
-        return reinterpret_cast<T*>(new char[BLOCK_SIZE * sizeof(T)]);
+        T* block = reinterpret_cast<T*>(new char[BLOCK_SIZE * sizeof(T)]);
+        STL_INSTRUMENT_EVENT(deque, on_allocate(BLOCK_SIZE * sizeof(T)));
+        return block;
     }
     void allocate_map(size_t new_map_size);
+    //分配 / 释放带保护槽位的指针数组，槽位全部置空
+    static T** new_map_array(size_t map_size);
+    static void delete_map_array(T** map);
+    //迭代器跨进新块时预取 slot 所指块的开头（向前）或结尾（向后）；slot 可以是保护槽位
+    static void prefetch_block_head(T* const* slot);
+    static void prefetch_block_tail(T* const* slot);
+    //for_each / for_each_reverse 的实现，Elem 为 T 或 const T
+    template <class Elem, class F>
+    void scan_forward(F& f, size_t prefetch_blocks) const;
+    template <class Elem, class F>
+    void scan_backward(F& f, size_t prefetch_blocks) const;
     void allocate_blocks(size_t start, size_t end);
     void destroy_elements();
     void deallocate_blocks(size_t start, size_t end);
     void deallocate_block(T* block);
-    void reallocate_map(size_t new_map_size);
-    void reallocate_map_for_front(size_t new_map_size);
-
-
-    bool should_release_block(size_t block_index)const;
-    
-    //内部迭代器位置计算
-    iterator internal_begin();
-    iterator internal_end();
-
-    //在pos位置之前或之后移动元素
-    void move_elements_forward(iterator pos, size_t n);
-    void move_elements_backward(iterator pos, size_t n);
+    void release_storage();
+    //扩大或重新居中指针数组，保证尾部（或头部）至少还有 blocks_to_add 个槽位
+    void reallocate_map(size_t blocks_to_add, bool add_at_front);
 
-    void ensure_capacity_at_back(size_t n);
-    bool is_range_within_deque(T*begin_ptr, T*end_ptr);
+    //为 n 个元素准备存储，首元素放在指针数组中部、块内偏移 start_index 处
+    void initialize_map(size_t n, size_t start_index = 0);
+    //保证尾部（头部）还能再放 n 个元素，且新的尾后位置所在块已分配
     void ensure_back_capacity(size_t n);
-    
-};
-template<class T>
-const size_t deque<T>::MAP_INIT_SIZE;
-template<class T> 
-const size_t deque<T>::BLOCK_SIZE;
+    void ensure_front_capacity(size_t n);
+    //弹出元素跨过块边界后，按 ReleasePolicy 释放这一端多余的备用块
+    void release_back_spare();
+    void release_front_spare();
+
+    //逻辑下标 -> 元素地址
+    T* element_at(size_t index) const {
+        size_t pos = m_start_index + index;
+        return m_map[m_start_block + pos / BLOCK_SIZE] + pos % BLOCK_SIZE;
+    }
+    //把 src 处的 n 个元素搬到未初始化的 dst 并析构原元素；
+    //移动构造可能抛异常的类型改用拷贝，失败时源不变
+    static void relocate(T* src, size_t n, T* dst);
+
+    //尾后位置所在块的索引
+    size_t finish_block() const { return m_start_block + (m_start_index + m_size) / BLOCK_SIZE; }
+
+    //把连续的 [src, src + n) 按目标块分段拷到逻辑位置 [index, index + n)，目标块必须已分配。
+    //只用于可平凡拷贝的类型；用 memmove 是因为 assign 的源区间可能就在本容器里
+    void copy_trivial(size_t index, const T* src, size_t n);
+    //可平凡拷贝类型的原地赋值：先保证容量（失败时对象不变），再整段覆盖，多出来的块释放掉
+    template <class Copy>
+    void assign_trivial(size_t n, Copy copy);
 
-template<class T>
-class deque<T>::iterator{
+};
+template <class T, class ReleasePolicy>
+const size_t deque<T, ReleasePolicy>::MAP_INIT_SIZE;
+template <class T, class ReleasePolicy>
+const size_t deque<T, ReleasePolicy>::BLOCK_SIZE;
+template <class T, class ReleasePolicy>
+const size_t deque<T, ReleasePolicy>::PREFETCH_BLOCKS;
+template <class T, class ReleasePolicy>
+const size_t deque<T, ReleasePolicy>::MAP_GUARD;
+template <class T, class ReleasePolicy>
+const size_t deque<T, ReleasePolicy>::PREFETCH_EDGE_BYTES;
+
+template <class T, class ReleasePolicy>
+class deque<T, ReleasePolicy>::iterator{
 private:
     T** m_current_block; //当前所在块的指针；
     T* m_current;        //当前元素指针；
     T* m_block_begin;    //当前块起始位置；
     T* m_block_end;      //当前块结束位置；
 
-    friend class deque<T>;
+    friend class deque<T, ReleasePolicy>;
     friend class const_iterator;
 
-    //void set_block(T** new_block);
-
 public:
     using iterator_category = std::random_access_iterator_tag;
     using value_type = T;
@@ -166,22 +276,26 @@ public:
         }
     }
 
-    iterator(const iterator& other) :
-        m_current_block(other.m_current_block),
-        m_current(other.m_current),
-        m_block_begin(other.m_block_begin),
-        m_block_end(other.m_block_end){}
-
     //迭代器操作
-    reference operator*() const{return *m_current;}
-    pointer operator->() const{return m_current;}
+    reference operator*() const{
+        STL_ACCESS_CHECK(m_current >= m_block_begin && m_current < m_block_end,
+                         "deque::iterator: dereferencing invalid iterator");
+        return *m_current;
+    }
+    pointer operator->() const{
+        STL_ACCESS_CHECK(m_current >= m_block_begin && m_current < m_block_end,
+                         "deque::iterator: dereferencing invalid iterator");
+        return m_current;
+    }
+    reference operator[](difference_type n) const{
+        return *(*this + n);
+    }
     iterator& operator++(){
         ++m_current;
         if(m_current == m_block_end){
-            ++m_current_block;
-            m_block_begin= *m_current_block;
-            m_block_end = m_block_begin + BLOCK_SIZE;
+            set_block(m_current_block + 1);
             m_current = m_block_begin;
+            prefetch_block_head(m_current_block + PREFETCH_BLOCKS);
         }
         return *this;
     }
@@ -192,11 +306,10 @@ public:
     }
 
     iterator& operator--(){
-        if(m_current == m_block_end){
-            --m_current_block;
-            m_block_begin = *m_current_block;
-            m_block_end = m_block_begin + BLOCK_SIZE;
+        if(m_current == m_block_begin){
+            set_block(m_current_block - 1);
             m_current = m_block_end;
+            prefetch_block_tail(m_current_block - PREFETCH_BLOCKS);
         }
         --m_current;
         return *this;
@@ -207,53 +320,23 @@ public:
         return tmp;
     }
 
+    //先换算成相对当前块起点的偏移，再一次跳到目标块
     iterator& operator +=(difference_type n){
-        if(n >= 0){
-            while(n > 0){
-                difference_type elements_in_block = m_block_end - m_current;
-                if(n < elements_in_block){
-                    m_current += n;
-                    break;
-                }
-                n -=elements_in_block;
-                ++m_current_block;
-                m_block_begin = *m_current_block;
-                m_block_end = m_block_begin + BLOCK_SIZE;
-                m_current = m_block_begin;
-            }
+        difference_type offset = n + (m_current - m_block_begin);
+        const difference_type block = static_cast<difference_type>(BLOCK_SIZE);
+        if(offset >= 0 && offset < block){
+            m_current += n;
         }
         else{
-            difference_type abs_n = -n;
-            difference_type elements_in_block = m_current - m_block_begin;
-                if(abs_n <= elements_in_block){
-                    m_current -= abs_n;
-                   }
-            abs_n -= elements_in_block + 1;
-            --m_current_block;
-            m_block_begin = *m_current_block;
-            m_block_end = m_block_begin + BLOCK_SIZE;
-            m_current = m_block_end - 1;
+            difference_type block_offset = offset > 0 ? offset / block
+                                                      : -((-offset - 1) / block) - 1;
+            set_block(m_current_block + block_offset);
+            m_current = m_block_begin + (offset - block_offset * block);
         }
         return *this;
     }
     iterator& operator -=(difference_type n){
-        if(n >= 0){
-            while(n > 0){
-                difference_type elements_in_block = m_current - m_block_begin;
-                if(n <= elements_in_block){
-                    m_current -= n;
-                    break;
-                   }
-            n -= elements_in_block + 1;
-            --m_current_block;
-            m_block_begin = *m_current_block;
-            m_block_end = m_block_begin + BLOCK_SIZE;
-            m_current = m_block_end - 1;
-            }
-        }else{
-            this->operator+=(-n);
-        }
-        return *this;
+        return *this += -n;
     }
     iterator operator+(difference_type n)const{
         iterator tmp = *this;
@@ -265,7 +348,7 @@ public:
         tmp -= n;
         return tmp;
     }
-    
+
     friend iterator operator+(difference_type n, const iterator& it){
         return it + n;
     }
@@ -274,7 +357,7 @@ public:
             return m_current - other.m_current;
         }
         difference_type blocks_diff = m_current_block - other.m_current_block;
-        return blocks_diff * BLOCK_SIZE + 
+        return blocks_diff * static_cast<difference_type>(BLOCK_SIZE) +
                (m_current - m_block_begin) -
                (other.m_current - other.m_block_begin);
     }
@@ -298,32 +381,29 @@ public:
         return !(*this > other);
     }
     bool operator >=(const iterator& other) const{
-        return !(*this < other); 
+        return !(*this < other);
     }
 
-
+private:
     // 辅助函数
     void set_block(T** new_block){
         m_current_block = new_block;
-       m_block_begin = *new_block;
-       m_block_end = m_block_begin + BLOCK_SIZE;
+        m_block_begin = *new_block;
+        m_block_end = m_block_begin + BLOCK_SIZE;
     }
 };
 
-template<class T>
-class deque<T>::const_iterator
+template <class T, class ReleasePolicy>
+class deque<T, ReleasePolicy>::const_iterator
 {
 private:
-    T** m_current_block;
+    T* const* m_current_block;
     const T* m_current;
     const T* m_block_begin;
     const T* m_block_end;
 
+    friend class deque<T, ReleasePolicy>;
 
-    friend class deque<T>;
-
-    //void set_block(T** new_block);
-        
 public:
     using iterator_category = std::random_access_iterator_tag;
     using value_type = T;
@@ -333,7 +413,7 @@ public:
 
     const_iterator() : m_current_block(nullptr), m_current(nullptr),
                       m_block_begin(nullptr), m_block_end(nullptr){}
-    const_iterator(T** block_ptr, const T* elem_ptr) :
+    const_iterator(T* const* block_ptr, const T* elem_ptr) :
         m_current_block(block_ptr), m_current(elem_ptr){
         if(block_ptr && *block_ptr){
             m_block_begin = *block_ptr;
@@ -343,23 +423,34 @@ public:
         }
     }
 
-    const_iterator(const const_iterator& other):
+    //iterator 可以隐式转换为 const_iterator
+    const_iterator(const iterator& other):
     m_current_block(other.m_current_block),
     m_current(other.m_current),
     m_block_begin(other.m_block_begin),
     m_block_end(other.m_block_end){}
 
     //迭代器操作
-    reference operator*() const { return *m_current; }
-    pointer operator->() const { return m_current; }
+    reference operator*() const {
+        STL_ACCESS_CHECK(m_current >= m_block_begin && m_current < m_block_end,
+                         "deque::const_iterator: dereferencing invalid iterator");
+        return *m_current;
+    }
+    pointer operator->() const {
+        STL_ACCESS_CHECK(m_current >= m_block_begin && m_current < m_block_end,
+                         "deque::const_iterator: dereferencing invalid iterator");
+        return m_current;
+    }
+    reference operator[](difference_type n) const {
+        return *(*this + n);
+    }
 
     const_iterator& operator++() {
         ++m_current;
         if (m_current == m_block_end) {
-            ++m_current_block;
-            m_block_begin = *m_current_block;
-            m_block_end = m_block_begin + BLOCK_SIZE;
+            set_block(m_current_block + 1);
             m_current = m_block_begin;
+            prefetch_block_head(m_current_block + PREFETCH_BLOCKS);
         }
         return *this;
     }
@@ -372,10 +463,9 @@ public:
 
     const_iterator& operator--() {
         if(m_current == m_block_begin) {
-            --m_current_block;
-            m_block_begin = *m_current_block;
-            m_block_end = m_block_begin + BLOCK_SIZE;
+            set_block(m_current_block - 1);
             m_current = m_block_end;
+            prefetch_block_tail(m_current_block - PREFETCH_BLOCKS);
         }
         --m_current;
         return *this;
@@ -388,39 +478,22 @@ public:
     }
 
     const_iterator& operator+=(difference_type n){
-        if( n>=0 ) {
-            while(n > 0) {
-                difference_type elements_in_block =m_block_end - m_current;
-                if( n < elements_in_block){
-                    m_current +=n;
-                    break;
-                }
-                n -= elements_in_block;
-                ++m_current_block;
-                m_block_begin = *m_current_block;
-                m_block_end = m_block_begin + BLOCK_SIZE;
-                m_current = m_block_begin;
-            }
-        } else{
-            difference_type abs_n = -n;
-            while(abs_n > 0){
-                difference_type elements_in_block = m_current - m_block_begin;
-
-                if(abs_n <= elements_in_block){
-                    m_current -= abs_n;
-                    break;
-                   }
-                   else{
-                    abs_n -= elements_in_block + 1;
-                    --m_current_block;
-                    m_block_begin = *m_current_block;
-                    m_block_end = m_block_begin + BLOCK_SIZE;
-                    m_current = m_block_end - 1;
-                    }
-                }
-            }
+        difference_type offset = n + (m_current - m_block_begin);
+        const difference_type block = static_cast<difference_type>(BLOCK_SIZE);
+        if(offset >= 0 && offset < block){
+            m_current += n;
+        }
+        else{
+            difference_type block_offset = offset > 0 ? offset / block
+                                                      : -((-offset - 1) / block) - 1;
+            set_block(m_current_block + block_offset);
+            m_current = m_block_begin + (offset - block_offset * block);
+        }
         return *this;
     }
+    const_iterator& operator-=(difference_type n){
+        return *this += -n;
+    }
 
     const_iterator operator+(difference_type n) const {
         const_iterator tmp = *this;
@@ -442,7 +515,7 @@ public:
             return m_current - other.m_current;
         }
         difference_type blocks_diff = m_current_block - other.m_current_block;
-        return blocks_diff * BLOCK_SIZE + 
+        return blocks_diff * static_cast<difference_type>(BLOCK_SIZE) +
                (m_current - m_block_begin) -
                (other.m_current - other.m_block_begin);
     }
@@ -466,202 +539,70 @@ public:
         return !(*this > other);
     }
     bool operator >=(const const_iterator& other) const{
-        return !(*this < other); 
+        return !(*this < other);
     }
 
-
+private:
     // 辅助函数
-    void set_block(T** new_block){
+    void set_block(T* const* new_block){
         m_current_block = new_block;
-       m_block_begin = *new_block;
-       m_block_end = m_block_begin + BLOCK_SIZE;
+        m_block_begin = *new_block;
+        m_block_end = m_block_begin + BLOCK_SIZE;
     }
-    
-};
-
-
 
+};
 
-template <class T>
-deque<T>::deque(const size_t n, const T& val)
-:m_map(nullptr),
- m_map_size(0),
- m_start_block(0),
- m_start_index(0),
- m_size(0){
-    
-    if(n == 0){
-        allocate_map(MAP_INIT_SIZE);
-        return;
-    }
-    size_t needed_blocks = (n + BLOCK_SIZE - 1) / BLOCK_SIZE;
-
-    m_map_size = std::max(MAP_INIT_SIZE, needed_blocks + 2);
 
-    allocate_map(m_map_size);
-    
-    m_start_block = (m_map_size - needed_blocks) / 2;
-    m_start_index = 0;
-    m_size = n;
+//构造
+template <class T, class ReleasePolicy>
+deque<T, ReleasePolicy>::deque(const size_t n, const T& val)
+{
+    initialize_map(n);
     try{
-
-        allocate_blocks(m_start_block, m_start_block + needed_blocks);
-
-        size_t current_block = m_start_block;
-        size_t remaining = n;
-        T* block_ptr = m_map[current_block];
-        size_t index_in_block = 0;
-
-        while (remaining > 0) {
-
-            size_t elements_in_this_block = std::min(remaining, BLOCK_SIZE -index_in_block);
-
-            for (size_t i = 0; i < elements_in_this_block; ++i){
-                new (block_ptr + index_in_block + i) T(val);
-            }
-            remaining -= elements_in_this_block;
-            index_in_block += elements_in_this_block;
-
-            if( index_in_block == BLOCK_SIZE && remaining > 0) {
-                ++current_block;
-                block_ptr = m_map[current_block];
-                index_in_block = 0;
-            }
-        }    
-    }
-    catch(...){
-        destroy_elements();
-        deallocate_blocks(m_start_block, m_start_block + (n + BLOCK_SIZE - 1 ) / BLOCK_SIZE);
-
-        if (m_map) {
-            delete[] reinterpret_cast<char*>(m_map);
-            m_map = nullptr;
+        for(size_t i = 0; i < n; ++i){
+            new (element_at(m_size)) T(val);
+            ++m_size;
         }
-        throw;       
     }
-};
-
-template <class T>
-deque<T>::deque (const deque<T>& other){
-    m_map = nullptr;
-    m_map_size = 0;
-    m_size = 0;
-    m_start_block = 0;
-    m_start_index = 0;
-
-    if(other.empty()){
-        allocate_map(MAP_INIT_SIZE);
-        return;
+    catch(...){
+        release_storage();
+        throw;
     }
-    size_t needed_blocks = (other.m_size + BLOCK_SIZE - 1)/ BLOCK_SIZE;
-
-    m_map_size = other.m_map_size;
-    allocate_map(m_map_size);
-
-    m_start_block = other.m_start_block;
-    m_start_index = other.m_start_index;
-    m_size = other.m_size;
+}
 
-    try {
-        // 分配内存块
-        size_t first_used_block = m_start_block;
-        size_t last_used_block = m_start_block + needed_blocks - 1;
-        if (m_start_index > 0 && needed_blocks > 1) {
-            last_used_block++;
-        }
-        
-        for (size_t i = first_used_block; i <= last_used_block; ++i) {
-            if (other.m_map[i]) {
-                m_map[i] = reinterpret_cast<T*>(new char[BLOCK_SIZE * sizeof(T)]);
-            }
-        }
-        
-        // 手动计算迭代位置，而不是调用 begin()
-        size_t src_block = other.m_start_block;
-        size_t src_index = other.m_start_index;
-        size_t dst_block = m_start_block;
-        size_t dst_index = m_start_index;
-        
-        for (size_t i = 0; i < m_size; ++i) {
-            // 获取源元素
-            T* src_ptr = other.m_map[src_block] + src_index;
-            
-            // 获取目标位置
-            T* dst_ptr = m_map[dst_block] + dst_index;
-            
-            // 构造元素
-            new (dst_ptr) T(*src_ptr);
-            
-            // 移动到下一个位置
-            src_index++;
-            if (src_index >= BLOCK_SIZE) {
-                src_index = 0;
-                src_block++;
-            }
-            
-            dst_index++;
-            if (dst_index >= BLOCK_SIZE) {
-                dst_index = 0;
-                dst_block++;
-            }
+//副本的块内偏移与源相同，两边的块一一对应，每块只需一次拷贝
+template <class T, class ReleasePolicy>
+deque<T, ReleasePolicy>::deque (const deque<T, ReleasePolicy>& other)
+{
+    initialize_map(other.m_size, other.m_start_index);
+    if constexpr (TRIVIAL) {
+        other.for_each_segment([this](const T* src, size_t len) {
+            copy_trivial(m_size, src, len);
+            m_size += len;
+        });
+    } else {
+        try{
+            other.for_each_segment([this](const T* src, size_t len) {
+                std::uninitialized_copy(src, src + len, element_at(m_size));
+                m_size += len;
+            });
         }
-    }
-    catch (...) {
-        // 异常安全：清理已构造的元素
-        if (m_map) {
-            size_t dst_block = m_start_block;
-            size_t dst_index = m_start_index;
-            
-            for (size_t i = 0; i < m_size; ++i) {
-                T* ptr = m_map[dst_block] + dst_index;
-                ptr->~T();  // 析构已构造的元素
-                
-                dst_index++;
-                if (dst_index >= BLOCK_SIZE) {
-                    dst_index = 0;
-                    dst_block++;
-                }
-            }
-            
-            // 释放内存块
-            size_t needed_blocks = (m_size + BLOCK_SIZE - 1) / BLOCK_SIZE;
-            size_t first_used_block = m_start_block;
-            size_t last_used_block = m_start_block + needed_blocks - 1;
-            if (m_start_index > 0 && needed_blocks > 1) {
-                last_used_block++;
-            }
-            
-            for (size_t i = first_used_block; i <= last_used_block; ++i) {
-                if (m_map[i]) {
-                    delete[] reinterpret_cast<char*>(m_map[i]);
-                    m_map[i] = nullptr;
-                }
-            }
-            
-            // 释放 map
-            delete[] reinterpret_cast<char*>(m_map);
-            m_map = nullptr;
+        catch(...){
+            release_storage();
+            throw;
         }
-        
-        m_map_size = 0;
-        m_size = 0;
-        m_start_block = 0;
-        m_start_index = 0;
-        
-        throw;
     }
 }
 
-  //移动构造
-template<class T>
-deque<T>::deque(deque<T>&& other)noexcept
-    :m_map(other.m_map),
-     m_map_size(other.m_map_size),
-     m_start_block(other.m_start_block),
-     m_start_index(other.m_start_index),
-     m_size(other.m_size){
-    
-    //将other置为空状态
+//移动构造
+template <class T, class ReleasePolicy>
+deque<T, ReleasePolicy>::deque(deque<T, ReleasePolicy>&& other)noexcept
+:m_map(other.m_map),
+ m_map_size(other.m_map_size),
+ m_start_block(other.m_start_block),
+ m_start_index(other.m_start_index),
+ m_size(other.m_size)
+{
     other.m_map = nullptr;
     other.m_map_size = 0;
     other.m_start_block = 0;
@@ -669,989 +610,618 @@ deque<T>::deque(deque<T>&& other)noexcept
     other.m_size = 0;
 }
 
-template<class T>
-deque<T>::deque(std::initializer_list<T> init)
-: m_map(nullptr),
-  m_map_size(0),
-  m_start_block(0),
-  m_start_index(0),
-  m_size(0){
-    if(init.size()>0){
-        size_t needed_blocks = (init.size() + BLOCK_SIZE - 1) / BLOCK_SIZE;
-        
-        m_map_size = std::max(MAP_INIT_SIZE, needed_blocks + 4);
-        allocate_map(m_map_size);
-
-        m_start_block = m_map_size / 2 - needed_blocks / 2;
-        m_start_index = 0;
-        m_size = init.size();
-
-        for (size_t i = 0; i < needed_blocks; ++i){
-            m_map[m_start_block + i] = reinterpret_cast<T*>(new char[BLOCK_SIZE * sizeof(T)]);
-        }
-
-        auto src =init.begin();
-        for(size_t block =0; block < needed_blocks; ++block){
-            T* block_ptr = m_map[m_start_block + block];
-            size_t elements_in_block = (block == needed_blocks -1)
-            ?(init.size() - block*BLOCK_SIZE)
-            :BLOCK_SIZE;
-
-            for (size_t i = 0; i < elements_in_block; ++i){
-                new(block_ptr + i) T(*src++);
-            }
+//初始化列表
+template <class T, class ReleasePolicy>
+deque<T, ReleasePolicy>::deque(std::initializer_list<T> init)
+{
+    initialize_map(init.size());
+    try{
+        for(const T& val : init){
+            new (element_at(m_size)) T(val);
+            ++m_size;
         }
-    }else{
-        allocate_map(MAP_INIT_SIZE);
     }
-}
-
-//析构函数
-
-//待验证
-template<class T>
-deque<T>& deque<T>::operator =(std::initializer_list<T> init){
-
-    if(init.size() == 0) {
-        clear();
-        return *this;
+    catch(...){
+        release_storage();
+        throw;
     }
+}
 
-    try {
-
-        deque<T> temp;
-
-        size_t needed_blocks = (init.size() + BLOCK_SIZE - 1) / BLOCK_SIZE;
-        size_t new_map_size = std::max(MAP_INIT_SIZE, needed_blocks * 2);
-
-        temp.allocate_map(new_map_size);
-        temp.m_start_block = (new_map_size - needed_blocks) / 2;
-        temp.m_start_index = 0;
-        temp.m_size = init.size();
-        temp.m_map_size = new_map_size;
-
-        temp.allocate_blocks(temp.m_start_block, temp.m_start_block + needed_blocks);
-
-        auto src = init.begin();
-        for (size_t block_idx = 0; block_idx < needed_blocks; ++block_idx){
-            T* block_ptr = temp.m_map[temp.m_start_block +block_idx];
-            size_t elements_in_block = (block_idx == needed_blocks - 1)
-            ? (init.size() - block_idx * BLOCK_SIZE)
-            :BLOCK_SIZE;
+//析构
+template <class T, class ReleasePolicy>
+deque<T, ReleasePolicy>::~deque()
+{
+    release_storage();
+}
 
-        for (size_t i = 0; i < elements_in_block; ++i) {
-            new (block_ptr + i) T(*src++);
-            }
+//赋值：先构造副本再交换，异常时原对象不受影响；
+//可平凡拷贝的类型直接覆盖原有的块，同样只在拷贝之前可能失败
+template <class T, class ReleasePolicy>
+deque<T, ReleasePolicy>& deque<T, ReleasePolicy>::operator =(const deque<T, ReleasePolicy>& other){
+    if(this != &other){
+        if constexpr (TRIVIAL) {
+            assign_trivial(other.m_size, [this, &other]() {
+                size_t index = 0;
+                other.for_each_segment([this, &index](const T* src, size_t len) {
+                    copy_trivial(index, src, len);
+                    index += len;
+                });
+            });
+        } else {
+            deque<T, ReleasePolicy> temp(other);
+            swap(temp);
         }
-        swap(temp);
-    }catch(...){
-        throw;
     }
-    
     return *this;
 }
 
-template<class T>
-deque<T>& deque<T>::operator=(const deque<T>& other) {
-    if (this == &other) {
-        return *this;
+template <class T, class ReleasePolicy>
+deque<T, ReleasePolicy>& deque<T, ReleasePolicy>::operator =(deque<T, ReleasePolicy>&& other) noexcept{
+    if(this != &other){
+        release_storage();
+        swap(other);
     }
-    
-    // 使用拷贝构造函数创建临时副本
-    deque<T> temp(other);
-    
-    // 交换当前对象和临时对象
-    swap(temp);
-    
     return *this;
 }
 
-template<class T>
-deque<T>& deque<T>::operator=(deque<T>&& other)noexcept{
-    if (this != &other) {
-        clear();
-    }
-    if(m_map) {
-        delete[] reinterpret_cast<char*>(m_map);
-    }
-    m_map = other.m_map;
-    m_map_size = other.m_map_size;
-    m_start_index = other.m_start_index;
-    m_size = other.m_size;
+template <class T, class ReleasePolicy>
+deque<T, ReleasePolicy>& deque<T, ReleasePolicy>::operator =(std::initializer_list<T> init){
+    deque<T, ReleasePolicy> temp(init);
+    swap(temp);
+    return *this;
+}
 
-    other.m_map = nullptr;
-    other.m_map_size = 0;
-    other.m_start_block = 0;
-    other.m_start_index = 0;
-    other.m_size = 0;
+template <class T, class ReleasePolicy>
+void deque<T, ReleasePolicy>::assign(size_t n, const T& val){
+    deque<T, ReleasePolicy> temp(n, val);
+    swap(temp);
 }
 
-template<class T>
-void deque<T>::assign(size_t n, const T&val){
-    if( n == 0) {
-        clear();
-        return;
+template <class T, class ReleasePolicy>
+void deque<T, ReleasePolicy>::assign(const T* begin_ptr, const T* end_ptr){
+    if(begin_ptr > end_ptr){
+        throw std::invalid_argument("deque::assign: invalid range");
     }
-
-    deque<T> temp;
-
-    try{
-        size_t needed_blocks = (n+ BLOCK_SIZE - 1) / BLOCK_SIZE;
-        size_t map_size = std::max(MAP_INIT_SIZE, needed_blocks * 2);
-
-        temp.allocate_map(map_size);
-        temp.m_start_block = (map_size - needed_blocks) / 2;
-        temp.m_start_index = 0;
-        temp.m_size = n;
-        temp.m_map_size = map_size;
-
-        temp.allocate_blocks(temp.m_start_block, temp.m_start_block + needed_blocks);
-
-        size_t current_block = temp.m_start_block;
-        size_t remaining = n;
-        size_t index_in_block = 0;
-
-        while (remaining > 0)
-        {
-            T* block_ptr = temp.m_map[current_block];
-            size_t elements_in_this_block = std:: min(remaining, BLOCK_SIZE - index_in_block);
-
-            for(size_t i = 0; i < elements_in_this_block; ++i){
-                new( block_ptr + index_in_block + i) T(val);
-            }
-
-            remaining -= elements_in_this_block;
-            if(index_in_block + elements_in_this_block == BLOCK_SIZE && remaining > 0){
-                current_block++;
-                index_in_block = 0;
-            } else{
-                index_in_block +=elements_in_this_block;
-            }
+    size_t n = static_cast<size_t>(end_ptr - begin_ptr);
+    if constexpr (TRIVIAL) {
+        assign_trivial(n, [this, begin_ptr, n]() { copy_trivial(0, begin_ptr, n); });
+    } else {
+        deque<T, ReleasePolicy> temp;
+        temp.initialize_map(n);
+        while(temp.m_size < n){
+            size_t offset = (temp.m_start_index + temp.m_size) % BLOCK_SIZE;
+            size_t len = std::min(n - temp.m_size, BLOCK_SIZE - offset);
+            std::uninitialized_copy(begin_ptr + temp.m_size, begin_ptr + temp.m_size + len, temp.element_at(temp.m_size));
+            temp.m_size += len;
         }
-
         swap(temp);
-        
-    }catch(...){
-        throw;
     }
 }
 
-template<class T>
-void deque<T>::assign (T* begin_ptr, T* end_ptr){
-    if(!begin_ptr || !end_ptr || begin_ptr > end_ptr){
-        throw std::invalid_argument("Invalid pointer range");
-    }
+template <class T, class ReleasePolicy>
+void deque<T, ReleasePolicy>::assign(std::initializer_list<T> init){
+    *this = init;
+}
 
-    size_t n = end_ptr - begin_ptr;
+//尾插
+template <class T, class ReleasePolicy>
+void deque<T, ReleasePolicy>::push_back(const T& val){
+    ensure_back_capacity(1);
+    new (element_at(m_size)) T(val);
+    ++m_size;
+}
 
-    if (is_range_within_deque(begin_ptr, end_ptr)){
+template <class T, class ReleasePolicy>
+void deque<T, ReleasePolicy>::push_back(T&& val){
+    ensure_back_capacity(1);
+    new (element_at(m_size)) T(std::move(val));
+    ++m_size;
+}
 
-        vector<T> temp(begin_ptr, end_ptr);
-        deque<T> new_deque(temp.data(), temp.data() + temp.size());
-        swap(new_deque); 
-    } else {
-        deque<T> new_deque(begin_ptr, end_ptr);
-        swap(new_deque);
+//尾删
+template <class T, class ReleasePolicy>
+void deque<T, ReleasePolicy>::pop_back(){
+    if (empty()){
+        throw std::out_of_range("deque:: pop_back: deque is empty");
     }
+    element_at(m_size - 1)->~T();
+    --m_size;
+    release_back_spare();
 }
 
-template<class T>
-void deque<T>::assign(std::initializer_list<T> init){
-    *this = init;
+//头插：先在前一个位置构造，成功后再移动起点，构造抛出异常时容器不变
+template <class T, class ReleasePolicy>
+void deque<T, ReleasePolicy>::push_front(const T& val){
+    ensure_front_capacity(1);
+    size_t block = m_start_index == 0 ? m_start_block - 1 : m_start_block;
+    size_t index = m_start_index == 0 ? BLOCK_SIZE - 1 : m_start_index - 1;
+    new (m_map[block] + index) T(val);
+    m_start_block = block;
+    m_start_index = index;
+    ++m_size;
 }
 
-template<class T>
-void deque<T>::push_back(const T&val){
-
-    if(m_size == 0){
-        if (m_map == nullptr){
-            allocate_map(MAP_INIT_SIZE);
-            m_start_block = m_map_size / 2;
-            m_start_index = 0;
-        }
+template <class T, class ReleasePolicy>
+void deque<T, ReleasePolicy>::push_front(T&& val){
+    ensure_front_capacity(1);
+    size_t block = m_start_index == 0 ? m_start_block - 1 : m_start_block;
+    size_t index = m_start_index == 0 ? BLOCK_SIZE - 1 : m_start_index - 1;
+    new (m_map[block] + index) T(std::move(val));
+    m_start_block = block;
+    m_start_index = index;
+    ++m_size;
+}
 
-        if(m_map[m_start_block] == nullptr){
-            m_map[m_start_block] = reinterpret_cast<T*>(
-                new char[BLOCK_SIZE * sizeof(T)]);
-        }
-        new (m_map[m_start_block] + m_start_index) T(val);
-        m_size = 1;
-        return;
+//头删
+template <class T, class ReleasePolicy>
+void deque<T, ReleasePolicy>::pop_front(){
+    if (empty()) {
+        throw std::out_of_range("deque::pop_front: deque is empty");
     }
-    //插入新元素；
-    size_t total_pos = m_start_index + m_size;
-    size_t block_idx = m_start_block + total_pos / BLOCK_SIZE;
-    size_t pos_in_block = total_pos% BLOCK_SIZE;
-
-    //检查是否需要新块
-    if (pos_in_block == 0){
-
-        if(block_idx >= m_map_size){
-            size_t new_size = m_map_size;
-            while (new_size <= block_idx + 2){
-                new_size *=2;
-            }
-            reallocate_map(new_size);
+    element_at(0)->~T();
+    --m_size;
+    if(++m_start_index == BLOCK_SIZE){
+        m_start_index = 0;
+        ++m_start_block;
+    }
+    release_front_spare();
+}
 
-            total_pos = m_start_index + m_size;
-            block_idx = m_start_block + total_pos / BLOCK_SIZE;
-            pos_in_block = total_pos % BLOCK_SIZE;
-        }
-        
-        if (m_map[block_idx] ==nullptr){
-            m_map[block_idx] =reinterpret_cast<T*>(new char[BLOCK_SIZE * sizeof(T)]);
+//改变大小
+template <class T, class ReleasePolicy>
+void deque<T, ReleasePolicy>::resize(size_t new_size){
+    while(m_size > new_size){
+        pop_back();
+    }
+    if(new_size > m_size){
+        ensure_back_capacity(new_size - m_size);
+        while(m_size < new_size){
+            new (element_at(m_size)) T();
+            ++m_size;
         }
     }
-
-    new (m_map[block_idx] + pos_in_block) T(val);
-    m_size++;
 }
 
-template <class T>
-void deque<T>::push_back(T&& val) {
-    if (empty()) {
-        // 确保起始块已分配
-        if (m_map[m_start_block] == nullptr) {
-            m_map[m_start_block] = reinterpret_cast<T*>(
-                new char[BLOCK_SIZE * sizeof(T)]);
-        }
-        new (m_map[m_start_block] + m_start_index) T(std::move(val));
-        m_size = 1;
-        return;
+template <class T, class ReleasePolicy>
+void deque<T, ReleasePolicy>::resize(size_t new_size, const T& val){
+    while(m_size > new_size){
+        pop_back();
     }
-    
-    // 计算新元素应该存放的位置
-    size_t next_position = m_start_index + m_size;  // 逻辑线性索引
-    size_t block_index = m_start_block + next_position / BLOCK_SIZE;
-    size_t position_in_block = next_position % BLOCK_SIZE;
-    
-    // 检查块索引是否越界（这才是正确的检查！）
-    if (block_index >= m_map_size) {
-        // 计算新的 map 大小
-        size_t new_map_size = m_map_size * 2;
-        if (new_map_size == 0) new_map_size = MAP_INIT_SIZE;  // 处理初始情况
-        while (new_map_size <= block_index + 2) {  // +2 提供一些额外空间
-            new_map_size *= 2;
+    if(new_size > m_size){
+        ensure_back_capacity(new_size - m_size);
+        while(m_size < new_size){
+            new (element_at(m_size)) T(val);
+            ++m_size;
         }
-        
-        reallocate_map(new_map_size);
-        
-        // 重新计算位置（因为 reallocate_map 可能改变了 m_start_block）
-        next_position = m_start_index + m_size;
-        block_index = m_start_block + next_position / BLOCK_SIZE;
-        position_in_block = next_position % BLOCK_SIZE;
-    }
-    
-    // 如果目标块不存在，分配它
-    if (m_map[block_index] == nullptr) {
-        m_map[block_index] = reinterpret_cast<T*>(
-            new char[BLOCK_SIZE * sizeof(T)]);
-    }
-    
-    // 在目标位置构造元素
-    new (m_map[block_index] + position_in_block) T(std::move(val));
-    ++m_size;
+    }
 }
 
-template<class T>
-void deque<T>::pop_back(){
-    if (empty()){
-        throw std::out_of_range("deque:: pop_back: deque is empty");
+//插入：只移动离插入点较近的一侧
+template <class T, class ReleasePolicy>
+typename deque<T, ReleasePolicy>::iterator deque<T, ReleasePolicy>::insert(iterator position, const T& val){
+    size_t index = static_cast<size_t>(position - begin());
+    if(index > m_size){
+        throw std::out_of_range("deque::insert: position out of range");
     }
-
-    size_t total_positions = m_start_index + m_size;
-    size_t last_block_index = m_start_block + (total_positions - 1) / BLOCK_SIZE;
-    size_t last_element_index = (total_positions -1) % BLOCK_SIZE;
-
-    T* last_element_ptr = m_map[last_block_index] + last_element_index;
-    last_element_ptr->~T();
-
-    m_size--;
-
-    if(m_size == 0){
-        m_start_index = 0;
+    T copy(val);
+    if(index == 0){
+        push_front(std::move(copy));
+    }
+    else if(index == m_size){
+        push_back(std::move(copy));
+    }
+    else if(index < m_size / 2){
+        push_front(std::move(front()));
+        iterator first = begin();
+        std::move(first + 2, first + index + 1, first + 1);
+        *(first + index) = std::move(copy);
     }
     else{
-        size_t new_total_positions = m_start_index + m_size;
-        size_t new_last_block_index = m_start_block + (new_total_positions -1) / BLOCK_SIZE;
+        push_back(std::move(back()));
+        iterator last = end();
+        std::move_backward(begin() + index, last - 2, last - 1);
+        *(begin() + index) = std::move(copy);
+    }
+    return begin() + index;
+}
 
-        if (new_last_block_index < last_block_index){
+//删除：同样只移动较短的一侧
+template <class T, class ReleasePolicy>
+typename deque<T, ReleasePolicy>::iterator deque<T, ReleasePolicy>::erase(iterator pos){
+    return erase(pos, pos + 1);
+}
 
-            if (m_map[last_block_index]){
-                delete[] reinterpret_cast<char*>(m_map[last_block_index]);
-                m_map[last_block_index] = nullptr;
-            }
+template <class T, class ReleasePolicy>
+typename deque<T, ReleasePolicy>::iterator deque<T, ReleasePolicy>::erase(iterator erase_begin_ptr, iterator erase_end_ptr){
+    size_t index = static_cast<size_t>(erase_begin_ptr - begin());
+    size_t count = static_cast<size_t>(erase_end_ptr - erase_begin_ptr);
+    if(index > m_size || count > m_size - index){
+        throw std::out_of_range("deque::erase: range out of range");
+    }
+    if(count == 0){
+        return begin() + index;
+    }
+    iterator first = begin();
+    if(index < (m_size - count) / 2){
+        std::move_backward(first, first + index, first + index + count);
+        for(size_t i = 0; i < count; ++i){
+            pop_front();
+        }
+    }
+    else{
+        std::move(first + index + count, end(), first + index);
+        for(size_t i = 0; i < count; ++i){
+            pop_back();
         }
     }
+    return begin() + index;
 }
 
-template <class T>
-void deque<T>:: push_front(T&& val){
-
+//清空：析构全部元素，不重新分配。已分配的块收拢到指针数组中部：一块放尾后位置，
+//两侧按 ReleasePolicy 各保留至多 SPARE_BLOCKS 个备用块（优先尾部），其余释放
+template <class T, class ReleasePolicy>
+void deque<T, ReleasePolicy>::clear(){
     if(m_map == nullptr){
-        m_map = new T*[MAP_INIT_SIZE];
-        m_map_size = MAP_INIT_SIZE;
-        m_start_block = MAP_INIT_SIZE/2;
-        m_map[m_start_block] = deque<T>::allocate_block();
-        m_start_index = BLOCK_SIZE / 2;
-        m_size = 0;
+        return;
     }
+    destroy_elements();
+    m_size = 0;
 
-    if(m_start_index == 0){
-        if(m_start_block == 0){
-
-            size_t new_map_size = m_map_size * 2;
-            T** new_map = new T*[new_map_size];
-
-            size_t offset = new_map_size -m_map_size;
-            for (size_t i = 0; i < m_map_size; ++i) {
-                new_map[offset + i] = m_map[i];
+    size_t middle = m_map_size / 2;
+    size_t front_room = std::min(ReleasePolicy::SPARE_BLOCKS, middle);
+    size_t back_room = std::min(ReleasePolicy::SPARE_BLOCKS, m_map_size - middle - 1);
+    //先把已分配的块按顺序压到数组开头，多出来的释放掉
+    size_t count = 0;
+    for (size_t i = 0; i < m_map_size; ++i) {
+        if (m_map[i] != nullptr) {
+            T* block = m_map[i];
+            m_map[i] = nullptr;
+            if (count < 1 + front_room + back_room) {
+                m_map[count++] = block;
+            } else {
+                deallocate_block(block);
             }
-
-            delete[] reinterpret_cast<char*>(m_map);
-            m_map = new_map;
-            m_map_size = new_map_size;
-            m_start_block = offset;
         }
-
-        --m_start_block;
-        m_map[m_start_block] = deque<T>::allocate_block();
-        m_start_index = BLOCK_SIZE;
     }
+    //按不变量至少有尾后位置那一块
+    size_t back_spare = std::min(back_room, count - 1);
+    size_t first = middle - (count - 1 - back_spare);
+    std::copy_backward(m_map, m_map + count, m_map + first + count);
+    std::fill(m_map, m_map + std::min(first, count), nullptr);
+    m_start_block = middle;
+    m_start_index = BLOCK_SIZE / 2;
+}
 
-    --m_start_index;
-    m_map[m_start_block][m_start_index] = std::move(val);
-    ++m_size;
+//数据存取
+template <class T, class ReleasePolicy>
+const T& deque<T, ReleasePolicy>::operator[](size_t index)const{
+    STL_ACCESS_CHECK(index < m_size, "deque::operator[]: index out of range");
+    return *element_at(index);
 }
 
-template<class T>
-void deque<T>::push_front(const T& value) {
-    // 如果 deque 为空，需要初始化
-    if (empty()) {
-        if (m_map == nullptr) {
-            // 分配 map
-            m_map_size = MAP_INIT_SIZE;  // 初始大小，例如 8
-            m_map = new T*[m_map_size];
-            for (size_t i = 0; i < m_map_size; ++i) {
-                m_map[i] = nullptr;
-            }
-            m_start_block = m_map_size / 2;  // 从中间开始
-            m_start_index = BLOCK_SIZE / 2;  // 从块中间开始
-        }
-        
-        // 分配起始块
-        if (m_map[m_start_block] == nullptr) {
-            m_map[m_start_block] = reinterpret_cast<T*>(new char[BLOCK_SIZE * sizeof(T)]);
-        }
-        
-        // 在起始位置构造元素
-        new (&m_map[m_start_block][m_start_index]) T(value);
-        ++m_size;
-        return;
-    }
-    
-    // 检查是否需要扩展空间
-    if (m_start_index == 0) {
-        // 需要在前面的块分配空间
-        size_t new_block = (m_start_block == 0) ? m_map_size - 1 : m_start_block - 1;
-        
-        // 如果 map 满了，需要重新分配更大的 map
-        if (m_map[new_block] == nullptr) {
-            // 分配新块
-            m_map[new_block] = reinterpret_cast<T*>(new char[BLOCK_SIZE * sizeof(T)]);
-        }
-        
-        m_start_block = new_block;
-        m_start_index = BLOCK_SIZE - 1;
-    } else {
-        --m_start_index;
+template <class T, class ReleasePolicy>
+const T& deque<T, ReleasePolicy>::at(size_t index) const{
+    if(index >= m_size) {
+        throw std::out_of_range("deque::at: index(which is "+std::to_string(index)
+        +") >= size(which is " + std::to_string(m_size)+")");
     }
-    
-    // 在起始位置构造新元素
-    new (&m_map[m_start_block][m_start_index]) T(value);
-    ++m_size;
+    return *element_at(index);
 }
 
-template <class T>
-void deque<T>::pop_front(){
-    if (empty()) {
-        throw std::out_of_range("deque::pop_front: deque is empty");
-    }
+template <class T, class ReleasePolicy>
+T& deque<T, ReleasePolicy>::operator [](size_t index){
+    STL_ACCESS_CHECK(index < m_size, "deque::operator[]: index out of range");
+    return *element_at(index);
+}
 
-    T* first_element = m_map[m_start_block] + m_start_index;
-    first_element->~T();
+template <class T, class ReleasePolicy>
+T& deque<T, ReleasePolicy>::at(size_t index){
+    return const_cast<T&>(static_cast<const deque<T, ReleasePolicy>&>(*this).at(index));
+}
 
-    --m_size;
+template <class T, class ReleasePolicy>
+const T& deque<T, ReleasePolicy>::front() const {
+    STL_ACCESS_CHECK(!empty(), "deque::front: deque is empty");
+    return m_map[m_start_block][m_start_index];
+}
 
-    if (m_size == 0){
-        m_start_index = BLOCK_SIZE /2;
-    }else{
-        ++m_start_index;
-        
-        if(m_start_index == BLOCK_SIZE){
+template <class T, class ReleasePolicy>
+T& deque<T, ReleasePolicy>::front() {
+    // 通过常量版本实现，避免代码重复
+    return const_cast<T&>(static_cast<const deque<T, ReleasePolicy>&>(*this).front());
+}
 
-            T* empty_block = m_map[m_start_block];
+template <class T, class ReleasePolicy>
+const T& deque<T, ReleasePolicy>::back() const {
+    STL_ACCESS_CHECK(!empty(), "deque::back: deque is empty");
+    return *element_at(m_size - 1);
+}
 
-            m_start_index = 0;
-            ++m_start_block;
+template <class T, class ReleasePolicy>
+T& deque<T, ReleasePolicy>::back(){
+    return const_cast<T&>(static_cast<const deque<T, ReleasePolicy>&>(*this).back());
+}
 
-            if(deque<T>::should_release_block(m_start_block - 1)){
-                deque<T>::deallocate_block(empty_block);
-                m_map[m_start_block - 1] = nullptr;
-            }
-        }
+//迭代器
+template <class T, class ReleasePolicy>
+typename deque<T, ReleasePolicy>::iterator deque<T, ReleasePolicy>::begin(){
+    if(m_map == nullptr){
+        return iterator();
     }
+    return iterator(m_map + m_start_block, m_map[m_start_block] + m_start_index);
 }
 
-template<class T>
-void deque<T>::resize (size_t new_size ){
-    if(new_size == m_size){
-        return;
+template <class T, class ReleasePolicy>
+typename deque<T, ReleasePolicy>::iterator deque<T, ReleasePolicy>::end(){
+    if(m_map == nullptr){
+        return iterator();
     }
-    //缩小的情况
-    if(new_size < m_size){
-        size_t elements_to_destroy = m_size - new_size;
-
-        for(size_t i = 0; i < elements_to_destroy; ++i){
-
-            size_t pos = m_size - 1 - i;
-            size_t total_pos = m_start_index + pos;
-            size_t block_idx = m_start_block + total_pos / BLOCK_SIZE;
-            size_t elem_idx = total_pos % BLOCK_SIZE;
+    size_t block = finish_block();
+    return iterator(m_map + block, m_map[block] + (m_start_index + m_size) % BLOCK_SIZE);
+}
 
-            if(block_idx < m_map_size && m_map[block_idx] != nullptr){
-                m_map[block_idx][elem_idx].~T();
-            }
-        }
-        m_size = new_size;
+template <class T, class ReleasePolicy>
+typename deque<T, ReleasePolicy>::const_iterator deque<T, ReleasePolicy>::begin() const{
+    if(m_map == nullptr){
+        return const_iterator();
     }
+    return const_iterator(m_map + m_start_block, m_map[m_start_block] + m_start_index);
+}
 
-    //扩大的情况
-    else{
-        size_t elements_to_add = new_size - m_size;
-
-        ensure_capacity_at_back(elements_to_add);
-
-        for(size_t i = 0; i < elements_to_add; ++i){
-
-            size_t insert_pos = m_start_index + m_size + i;
-            size_t block_idx = m_start_block + insert_pos / BLOCK_SIZE;
-            size_t elem_idx = insert_pos % BLOCK_SIZE;
-
-            if(m_map[block_idx] == nullptr){
-                m_map[block_idx] = reinterpret_cast<T*>(new char[BLOCK_SIZE*sizeof(T)]);
-            }
-            new(m_map[block_idx] + elem_idx)T();
-        }
-        m_size = new_size;
-    }
-}
-
-template<class T>
-void deque<T>::resize (size_t new_size, const T& val){
-// 如果新大小等于当前大小
-if (new_size == m_size) {
-    return;
-    }
-// 备份当前大小，用于异常恢复
-size_t old_size = m_size;
-
-// 1. 缩小的情况
-if (new_size < m_size) {
-    
-    size_t elements_to_destroy = m_size - new_size;
-    for (size_t i = 0; i < elements_to_destroy; ++i) {
-        size_t pos = m_size - 1 - i;
-        size_t total_pos = m_start_index + pos;
-        size_t block_idx = m_start_block + total_pos / BLOCK_SIZE;
-        size_t elem_idx = total_pos % BLOCK_SIZE;
-        
-        if (block_idx < m_map_size && m_map[block_idx] != nullptr) {
-            m_map[block_idx][elem_idx].~T();
-            }
-        }
-    m_size = new_size;
-    }
-// 2. 扩大的情况
-else {
-    size_t elements_to_add = new_size - m_size;
-    ensure_back_capacity(elements_to_add);
-    
-    // 在末尾添加新元素，使用提供的val
-    for (size_t i = 0; i < elements_to_add; ++i) {
-        // 计算新元素应该插入的位置
-        size_t insert_pos = m_start_index + m_size + i;
-        size_t block_idx = m_start_block + insert_pos / BLOCK_SIZE;
-        size_t elem_idx = insert_pos % BLOCK_SIZE;
-        
-        if (m_map[block_idx] == nullptr) {
-            m_map[block_idx] = reinterpret_cast<T*>(new char[BLOCK_SIZE * sizeof(T)]);
-            }
-        new (m_map[block_idx] + elem_idx) T(val);
-        }
-    m_size = new_size;
-    }
+template <class T, class ReleasePolicy>
+typename deque<T, ReleasePolicy>::const_iterator deque<T, ReleasePolicy>::cbegin() const{
+    return begin();
 }
 
-template<class T>
-typename deque<T>::iterator deque<T>::insert(typename deque<T>::iterator position, const T& val) {
-    // 如果 deque 为空或 position 是 end()
-    if (empty() || position == end()) {
-        push_back(val);
-        return empty() ? begin() : --end();
-    }
-    
-    // 如果 position 是 begin()
-    if (position == begin()) {
-        push_front(val);
-        return begin();
-    }
-    
-    // 在中间插入
-    // 1. 先计算插入位置
-    size_t insert_index = 0;
-    iterator it = begin();
-    for (; it != position && it != end(); ++it) {
-        ++insert_index;
-    }
-    
-    // 2. 在末尾添加一个元素（为移动元素腾出空间）
-    push_back(val);  // 添加一个默认值
-    
-    // 3. 从插入点到末尾的元素向后移动一位
-    for (size_t i = size() - 1; i > insert_index; --i) {
-        (*this)[i] = (*this)[i - 1];
+template <class T, class ReleasePolicy>
+typename deque<T, ReleasePolicy>::const_iterator deque<T, ReleasePolicy>::end() const{
+    if(m_map == nullptr){
+        return const_iterator();
     }
-    
-    // 4. 在插入位置放入新值
-    (*this)[insert_index] = val;
-    
-    // 5. 返回指向新插入元素的迭代器
-    return begin() + insert_index;
+    size_t block = finish_block();
+    return const_iterator(m_map + block, m_map[block] + (m_start_index + m_size) % BLOCK_SIZE);
 }
 
-template<class T>
-typename deque<T>::iterator deque<T>::erase(typename deque<T>::iterator position) {
-    
-    if(position == end()){
-        throw std::out_of_range("deque::erase: cannot erase end() iterator");
-    }
-
-    if(empty()){
-        throw std::out_of_range("deque::erase: deque is empty");
-    }
-
-    if(position == begin()){
-        pop_front();
-        return begin();
-    }
-
-    if(position ==end()-1){
-        pop_back();
-        return end();
-    }
-
-    iterator next_position = position;
-    ++next_position;
-
-    size_t erase_index = 0; 
-    iterator it = begin();
-
-    while(it != position){
-        ++it;
-        ++erase_index;
-    }
-
-    size_t total_pos = m_start_index + erase_index;
-    size_t block_idx = m_start_block + total_pos/BLOCK_SIZE;
-    size_t elem_idx = total_pos % BLOCK_SIZE;
-
-    if(block_idx < m_map_size && m_map[block_idx] != nullptr){
-        m_map[block_idx][elem_idx].~T();
-    }
-
-    for (size_t i = erase_index; i < m_size - 1; ++i){
-        size_t src_total = m_start_index + i + 1;
-        size_t dst_total = m_start_index + i;
-
-        size_t src_block = m_start_block + src_total / BLOCK_SIZE;
-        size_t src_idx = src_total % BLOCK_SIZE;
-
-        size_t dst_block = m_start_block + dst_total / BLOCK_SIZE;
-        size_t dst_idx = dst_total % BLOCK_SIZE;
-
-        m_map[dst_block][dst_idx] = std::move(m_map[src_block][src_idx]);
-    }
-
-    size_t last_total = m_start_index + m_size - 1;
-    size_t last_block = m_start_block + last_total / BLOCK_SIZE;
-    size_t last_idx = last_total % BLOCK_SIZE;
-
-    if(last_block < m_map_size && m_map[last_block] != nullptr){
-        m_map[last_block][last_idx].~T();
-    }
-
-    --m_size;
-
-    return next_position;
+template <class T, class ReleasePolicy>
+typename deque<T, ReleasePolicy>::const_iterator deque<T, ReleasePolicy>::cend() const{
+    return end();
 }
 
+//交换
+template <class T, class ReleasePolicy>
+void deque<T, ReleasePolicy>::swap(deque<T, ReleasePolicy>& other) noexcept{
+    std::swap(m_map, other.m_map);
+    std::swap(m_map_size, other.m_map_size);
+    std::swap(m_start_block, other.m_start_block);
+    std::swap(m_start_index, other.m_start_index);
+    std::swap(m_size, other.m_size);
+}
 
-// 范围删除的erase
-template<class T>
-typename deque<T>::iterator deque<T>::erase(typename deque<T>::iterator first, 
-                typename deque<T>::iterator last) {
-    if (first == last){
-        return last;
-    }
-
-    size_t first_idx = 0;
-    size_t last_idx = 0;
-
-    iterator it = begin();
-    for (;it != first && it !=end(); ++it){
-        ++first_idx;
-    }
 
-    last_idx = first_idx;
-    for( ; it != last && it != end(); ++it){
-        ++last_idx;
+//拆分
+template <class T, class ReleasePolicy>
+deque<T, ReleasePolicy> deque<T, ReleasePolicy>::split_at(size_t k){
+    if(k > m_size){
+        throw std::out_of_range("deque::split_at: index out of range");
     }
-
-    size_t erase_count = last_idx - first_idx;
-
-    if(erase_count == 0){
-        return last;
+    deque<T, ReleasePolicy> tail;
+    if(k == m_size){
+        return tail;
     }
-
-    for (size_t i = first_idx; i < last_idx; ++i){
-        size_t total_pos = m_start_index + i;
-        size_t block = m_start_block + total_pos / BLOCK_SIZE;
-        size_t idx = total_pos % BLOCK_SIZE;
-
-        if(block < m_map_size && m_map[block]){
-            m_map[block][idx].~T();
-        }
+    if(k == 0){
+        swap(tail);
+        return tail;
     }
-    size_t elements_before = first_idx;
-    size_t elements_after = m_size -last_idx;
 
-    if (elements_before <= elements_after) {
-        for(size_t dst = last_idx - 1; dst>= first_idx; --dst){
-            for (size_t src = dst - 1; src >= first_idx; --src){
-                if(src >= first_idx + erase_count){
-                size_t src_total = m_start_index + src;
-                size_t dst_total = m_start_index + src + erase_count;
-
-                size_t src_block = m_start_block + src_total / BLOCK_SIZE;
-                size_t src_idx = src_total % BLOCK_SIZE;
-                size_t dst_block = m_start_block + dst_total / BLOCK_SIZE;
-                size_t dst_idx = dst_total % BLOCK_SIZE;
+    size_t pos = m_start_index + k;
+    size_t split_block = m_start_block + pos / BLOCK_SIZE;
+    size_t offset = pos % BLOCK_SIZE;
+    size_t last = finish_block();
+    size_t tail_blocks = last - split_block + 1;
 
-                m_map[dst_block][dst_idx] = std::move(m_map[src_block][src_idx]);
-                }
-            }
-        }
-    m_start_index +=erase_count;
+    //分界块里前一半 [head_lo, offset) 属于本对象，后一半 [offset, tail_hi) 属于 tail
+    size_t head_lo = split_block == m_start_block ? m_start_index : 0;
+    size_t tail_hi = std::min(BLOCK_SIZE, m_start_index + m_size - (split_block - m_start_block) * BLOCK_SIZE);
 
-    while (m_start_index >= BLOCK_SIZE) {
-        m_start_index -= BLOCK_SIZE;
-        ++m_start_block;
-        }
-    }
-    else{
-        for(size_t src = last_idx; src < m_size; ++src) {
-            size_t dst = src - erase_count;
-            
-            size_t src_total = m_start_index + src;
-            size_t dst_total = m_start_index + dst;
-
-            size_t src_block = m_start_block + src_total / BLOCK_SIZE;
-            size_t src_idx = src_total % BLOCK_SIZE;
-            size_t dst_block = m_start_block + dst_total /BLOCK_SIZE;
-            size_t dst_idx = dst_total % BLOCK_SIZE;
-
-            m_map[dst_block][dst_idx] = std:: move(m_map[src_block][src_idx]);
-        }
-        for(size_t i = m_size - erase_count; i < m_size; ++i){
-            size_t total_pos = m_start_index + i;
-            size_t block = m_start_block + total_pos /BLOCK_SIZE;
-            size_t idx = total_pos % BLOCK_SIZE;
+    //先完成所有可能失败的分配
+    tail.allocate_map(std::max(MAP_INIT_SIZE, tail_blocks + 2));
+    tail.m_start_block = (tail.m_map_size - tail_blocks) / 2;
+    tail.m_start_index = offset;
+    T* fresh = allocate_block();
 
-            if(block < m_map_size && m_map[block]){
-                m_map[block][idx].~T();
-            }
+    T* shared = m_map[split_block];
+    try{
+        if(offset - head_lo <= tail_hi - offset){
+            relocate(shared + head_lo, offset - head_lo, fresh + head_lo);
+            m_map[split_block] = fresh;
+            tail.m_map[tail.m_start_block] = shared;
+        } else {
+            relocate(shared + offset, tail_hi - offset, fresh + offset);
+            tail.m_map[tail.m_start_block] = fresh;
         }
     }
-    m_size -= erase_count;
-    if(first_idx < m_size){
-        size_t new_total = m_start_index + first_idx;
-        size_t new_block = m_start_block + new_total / BLOCK_SIZE;
-        size_t new_idx = new_total % BLOCK_SIZE;
-
-        return iterator(&m_map[new_block], m_map[new_block]+new_idx);
-    }
-    else{
-        return end();
-    }   
-}
-
-template<class T>
-void deque<T>::clear(){
-    destroy_elements();
-
-    m_size = 0;
-    if(m_map != nullptr) {
-        m_start_block = m_map_size / 2;
-        m_start_index = BLOCK_SIZE / 2;
-
-        if(m_map[m_start_block] == nullptr){
-            m_map[m_start_block] = allocate_block();
-        } 
+    catch(...){
+        deallocate_block(fresh);
+        throw;
     }
-}
-
-template<class T>
-const T& deque<T>::operator[](size_t index)const{
-    if(index >= m_size) {
-        throw std::out_of_range("deque::operator[]:index out of range");
+    for(size_t i = split_block + 1; i <= last; ++i){
+        tail.m_map[tail.m_start_block + (i - split_block)] = m_map[i];
+        m_map[i] = nullptr;
     }
-
-    size_t pos = m_start_index + index;
-    size_t block = m_start_block + pos / BLOCK_SIZE;
-    size_t offset = pos % BLOCK_SIZE;
-
-    return m_map[block][offset];
+    tail.m_size = m_size - k;
+    m_size = k;
+    return tail;
 }
 
-template<class T>
-const T& deque<T>::at(size_t index) const{
-    if(index >= m_size) {
-        throw std::out_of_range("deque::at: index(which is)"+std::to_string(index)
-        +")>= size(which is)" + std::to_string(m_size)+")");
-    }
-
-    size_t total_position = m_start_index + index;
-    size_t block_index = m_start_block + total_position/BLOCK_SIZE;
-    size_t element_index = total_position % BLOCK_SIZE;
-
-    if(block_index >= m_map_size){
-        throw std::logic_error("deque::at: internal error - block index out of range");
+//尾部拼接
+template <class T, class ReleasePolicy>
+void deque<T, ReleasePolicy>::splice_back(deque<T, ReleasePolicy>&& other){
+    if(this == &other || other.m_size == 0){
+        return;
     }
-    if(m_map[block_index] == nullptr){
-        throw std::logic_error("deque::at: internal error - accessing null block");
+    if(m_size == 0){
+        deque<T, ReleasePolicy> temp(std::move(other));
+        swap(temp);
+        return;
     }
-
-    return m_map[block_index][element_index];
-}
-
-template<class T>
-T& deque<T>::operator [](size_t index){
-    if(index >= m_size) {
-        throw std::out_of_range("deque::operator[]:index out of range");
+    size_t end_offset = (m_start_index + m_size) % BLOCK_SIZE;
+    if(end_offset != other.m_start_index){
+        if(other.m_size <= m_size){
+            ensure_back_capacity(other.m_size);
+            for(size_t i = 0; i < other.m_size; ++i){
+                push_back(std::move(*other.element_at(i)));
+            }
+            other.clear();
+        } else {
+            other.ensure_front_capacity(m_size);
+            for(size_t i = m_size; i-- > 0;){
+                other.push_front(std::move(*element_at(i)));
+            }
+            clear();
+            swap(other);
+        }
+        return;
     }
 
-    size_t pos = m_start_index + index;
-    size_t block = m_start_block + pos / BLOCK_SIZE;
-    size_t offset = pos % BLOCK_SIZE;
-
-    return m_map[block][offset];
-}
-
-template<class T>
-T& deque<T>::at(size_t index){
-    if(index >= m_size) {
-        throw std::out_of_range("deque::at: index(which is)"+std::to_string(index)
-        +")>= size(which is)" + std::to_string(m_size)+")");
+    //对齐：other 的第一块接在本对象尾后位置所在块上，其余块直接移交
+    size_t other_blocks = other.finish_block() - other.m_start_block + 1;
+    if(finish_block() + other_blocks - 1 >= m_map_size){
+        reallocate_map(other_blocks - 1, false);
+    }
+    size_t join = finish_block();
+    size_t head_lo = join == m_start_block ? m_start_index : 0;
+    size_t tail_hi = std::min(BLOCK_SIZE, other.m_start_index + other.m_size);
+    T* mine = m_map[join];
+    T* theirs = other.m_map[other.m_start_block];
+    if(end_offset - head_lo <= tail_hi - end_offset){
+        relocate(mine + head_lo, end_offset - head_lo, theirs + head_lo);
+        m_map[join] = theirs;
+        deallocate_block(mine);
+    } else {
+        relocate(theirs + end_offset, tail_hi - end_offset, mine + end_offset);
+        deallocate_block(theirs);
     }
+    other.m_map[other.m_start_block] = nullptr;
 
-    size_t total_position = m_start_index + index;
-    size_t block_index = m_start_block + total_position/BLOCK_SIZE;
-    size_t element_index = total_position % BLOCK_SIZE;
-
-    if(block_index >= m_map_size){
-        throw std::logic_error("deque::at: internal error - block index out of range");
-    }
-    if(m_map[block_index] == nullptr){
-        throw std::logic_error("deque::at: internal error - accessing null block");
+    for(size_t j = 1; j < other_blocks; ++j){
+        deallocate_block(m_map[join + j]);     //本对象的备用块
+        m_map[join + j] = other.m_map[other.m_start_block + j];
+        other.m_map[other.m_start_block + j] = nullptr;
     }
-
-    return m_map[block_index][element_index];
+    m_size += other.m_size;
+    other.m_size = 0;
+    other.release_storage();
 }
 
-template<class T>
-const T& deque<T>::front() const {
-    if (empty()) {
-        throw std::out_of_range("deque::front: deque is empty");
-    }
-    
-#ifdef _DEBUG
-    if (m_start_block >= m_map_size) {
-        throw std::logic_error("deque::front: invalid start block");
+//头部拼接
+template <class T, class ReleasePolicy>
+void deque<T, ReleasePolicy>::splice_front(deque<T, ReleasePolicy>&& other){
+    if(this == &other || other.m_size == 0){
+        return;
     }
-    
-    T* block = m_map[m_start_block];
-    if (block == nullptr) {
-        throw std::logic_error("deque::front: start block not allocated");
+    if(m_size == 0){
+        deque<T, ReleasePolicy> temp(std::move(other));
+        swap(temp);
+        return;
     }
-    
-    if (m_start_index >= BLOCK_SIZE) {
-        throw std::logic_error("deque::front: invalid start index");
+    size_t other_end = (other.m_start_index + other.m_size) % BLOCK_SIZE;
+    if(other_end != m_start_index){
+        if(other.m_size <= m_size){
+            ensure_front_capacity(other.m_size);
+            for(size_t i = other.m_size; i-- > 0;){
+                push_front(std::move(*other.element_at(i)));
+            }
+            other.clear();
+        } else {
+            other.ensure_back_capacity(m_size);
+            for(size_t i = 0; i < m_size; ++i){
+                other.push_back(std::move(*element_at(i)));
+            }
+            clear();
+            swap(other);
+        }
+        return;
     }
-#endif
-    
-    // 直接返回元素，而不是再次调用 front()
-    return m_map[m_start_block][m_start_index];
-}
 
-template<class T>
-T& deque<T>::front() {
-    // 通过常量版本实现，避免代码重复
-    return const_cast<T&>(static_cast<const deque<T>&>(*this).front());
-}
-
-template<class T>
-const T& deque<T>::back() const {
-    if (empty()) {
-        throw std::out_of_range("deque::back: deque is empty");
-    }
-    
-    // 计算最后一个元素的相对位置
-    size_t last_total = m_start_index + m_size - 1;
-    size_t last_block = m_start_block + (last_total / BLOCK_SIZE);
-    size_t last_idx = last_total % BLOCK_SIZE;
-    
-    // 关键：处理循环
-    if (last_block >= m_map_size) {
-        last_block %= m_map_size;  // 循环回到开头
-    }
-    
-    // 调试检查
-#ifdef _DEBUG
-    if (last_block >= m_map_size) {
-        throw std::logic_error("deque::back: invalid block index");
-    }
-    
-    T* block = m_map[last_block];
-    if (block == nullptr) {
-        throw std::logic_error("deque::back: invalid element index");
+    //对齐：other 尾后位置所在块与本对象第一块合并，other 其余的块直接移交到前面
+    size_t other_last = other.finish_block();
+    size_t other_blocks = other_last - other.m_start_block + 1;
+    if(m_start_block < other_blocks - 1){
+        reallocate_map(other_blocks - 1, true);
+    }
+    size_t join = m_start_block;
+    size_t head_lo = other_last == other.m_start_block ? other.m_start_index : 0;
+    size_t tail_hi = std::min(BLOCK_SIZE, m_start_index + m_size);
+    T* mine = m_map[join];
+    T* theirs = other.m_map[other_last];
+    if(other_end - head_lo <= tail_hi - other_end){
+        relocate(theirs + head_lo, other_end - head_lo, mine + head_lo);
+        deallocate_block(theirs);
+    } else {
+        relocate(mine + other_end, tail_hi - other_end, theirs + other_end);
+        m_map[join] = theirs;
+        deallocate_block(mine);
     }
-#endif
-    
-    return m_map[last_block][last_idx];
-}
+    other.m_map[other_last] = nullptr;
 
-template<class T>
-T& deque<T>::back(){
-    return const_cast<T&>(static_cast<const deque<T>&>(*this).back());
-}
-
-
-template<class T>
-typename deque<T>::iterator deque<T>::begin(){
-    if(empty()){
-        return iterator(nullptr, nullptr);
+    for(size_t j = 1; j < other_blocks; ++j){
+        deallocate_block(m_map[join - j]);     //本对象的备用块
+        m_map[join - j] = other.m_map[other_last - j];
+        other.m_map[other_last - j] = nullptr;
     }
-    return iterator(& m_map[m_start_block], m_map[m_start_block] + m_start_index);
+    m_start_block = join - (other_blocks - 1);
+    m_start_index = other.m_start_index;
+    m_size += other.m_size;
+    other.m_size = 0;
+    other.release_storage();
 }
 
-template<class T>
-typename deque<T>::iterator deque<T>::end(){
-    if(empty()){
-        return iterator(nullptr, nullptr);
-    }
-    size_t total_elements = m_start_index + m_size ;
-    size_t last_block = m_start_block + (total_elements - 1)/ BLOCK_SIZE;
-    size_t index_in_last_block = (total_elements - 1)% BLOCK_SIZE; 
 
-    return iterator(&m_map[last_block],m_map[last_block] + index_in_last_block +1);
+//辅助函数实现
+template <class T, class ReleasePolicy>
+void deque<T, ReleasePolicy>::allocate_map(size_t new_map_size){
+    m_map = new_map_array(new_map_size);
+    m_map_size = new_map_size;
 }
 
-template<class T>
-typename deque<T>::const_iterator deque<T>::begin() const{
-    if(empty()){
-        return end();
-    }
-
-    T** block_ptr = &m_map[m_start_block];
-    const T* elem_ptr = m_map[m_start_block] + m_start_index;
-
-    return const_iterator(block_ptr, elem_ptr);
+template <class T, class ReleasePolicy>
+T** deque<T, ReleasePolicy>::new_map_array(size_t map_size){
+    T** map = new T*[map_size + 2 * MAP_GUARD];
+    std::fill_n(map, map_size + 2 * MAP_GUARD, nullptr);
+    return map + MAP_GUARD;
 }
 
-template<class T>
-typename deque<T>::const_iterator deque<T>::cbegin() const{
-    return begin();
+template <class T, class ReleasePolicy>
+void deque<T, ReleasePolicy>::delete_map_array(T** map){
+    delete[] (map - MAP_GUARD);
 }
 
-template<class T>
-typename deque<T>::const_iterator deque<T>::end() const{
-
-    if(empty()){
-        return begin();
-    }
-
-    size_t total_end = m_start_index + m_size;
-    size_t end_block = m_start_block + total_end / BLOCK_SIZE;
-    size_t end_idx = total_end % BLOCK_SIZE;
-#ifdef _DEBUG
-    if(end_block > m_map_size){
-        throw std::logic_error("deque::end: end block exceeds map size");
-    }
-#endif
-    if(end_idx == 0){
-        if(end_block < m_map_size) {
-            T*block = m_map[end_block];
-            return const_iterator(&m_map[end_block],(block!=nullptr)?block:nullptr);
-        }
-        else{
-            return const_iterator(nullptr,nullptr);
-        }
+template <class T, class ReleasePolicy>
+void deque<T, ReleasePolicy>::prefetch_block_head(T* const* slot){
+    if (PREFETCH_BLOCKS > 0 && *slot != nullptr) {
+        stl_prefetch_range(*slot, PREFETCH_EDGE_BYTES);
     }
-    else{
-        if(end_block<m_map_size) {
-            T* block = m_map[end_block];
-
-#ifdef _DEBUG
-        if(block ==nullptr) {
-            throw std::logic_error("deque::end: block not allocated for end position");
-        }
-#endif
-        return const_iterator(&m_map[end_block],end_block + end_idx);
-        }
-    else{
-        return const_iterator(nullptr,nullptr);
-        }
-    }
-}
-
-template<class T>
-typename deque<T>::const_iterator deque<T>::cend() const {
-    return end();
 }
 
-//辅助函数实现
-template <class T>
-void deque<T>::allocate_map(size_t new_map_size){
-
-    m_map = reinterpret_cast<T**>(new char[new_map_size * sizeof(T*)]);
-    m_map_size = new_map_size;
-
-    for(size_t i= 0; i < m_map_size; ++i){
-        m_map[i] = nullptr;
+template <class T, class ReleasePolicy>
+void deque<T, ReleasePolicy>::prefetch_block_tail(T* const* slot){
+    if (PREFETCH_BLOCKS > 0 && *slot != nullptr) {
+        stl_prefetch_range(reinterpret_cast<const char*>(*slot + BLOCK_SIZE) - PREFETCH_EDGE_BYTES,
+                           PREFETCH_EDGE_BYTES);
     }
 }
 
-template <class T>
-void deque<T>::allocate_blocks(size_t start_block, size_t end_block){
-
+template <class T, class ReleasePolicy>
+void deque<T, ReleasePolicy>::allocate_blocks(size_t start_block, size_t end_block){
     for (size_t i = start_block; i < end_block; ++i){
-        m_map[i] = reinterpret_cast<T*>(new char[BLOCK_SIZE * sizeof(T)]);
+        if(m_map[i] == nullptr){
+            m_map[i] = allocate_block();
+        }
     }
 }
 
-template <class T>
-void deque<T>::destroy_elements(){
+template <class T, class ReleasePolicy>
+void deque<T, ReleasePolicy>::destroy_elements(){
     if (m_size == 0 || !m_map ) return;
 
     size_t current_block = m_start_block;
@@ -1671,376 +1241,383 @@ void deque<T>::destroy_elements(){
     }
 }
 
-template <class T>
-void deque<T>::deallocate_blocks(size_t start_block, size_t end_block) {
-
+template <class T, class ReleasePolicy>
+void deque<T, ReleasePolicy>::deallocate_blocks(size_t start_block, size_t end_block) {
     for(size_t i = start_block; i < end_block; ++i){
         if (m_map[i]){
-
-            delete[] reinterpret_cast<char*>(m_map[i]);
+            deallocate_block(m_map[i]);
             m_map[i] = nullptr;
         }
     }
-} 
+}
+
+template <class T, class ReleasePolicy>
+void deque<T, ReleasePolicy>::deallocate_block(T* block) {
+    if (block != nullptr) {
+        STL_INSTRUMENT_EVENT(deque, on_free(BLOCK_SIZE * sizeof(T)));
+        delete[] reinterpret_cast<char*>(block);
+    }
+}
 
-template<class T>
-void deque<T>::reallocate_map(size_t new_map_size) {
-    if (new_map_size <= m_map_size) {
+//析构全部元素，释放所有块和指针数组，回到默认构造的状态
+template <class T, class ReleasePolicy>
+void deque<T, ReleasePolicy>::release_storage() {
+    if (m_map == nullptr) {
         return;
     }
+    destroy_elements();
+    deallocate_blocks(0, m_map_size);
+    delete_map_array(m_map);
+    m_map = nullptr;
+    m_map_size = 0;
+    m_start_block = 0;
+    m_start_index = 0;
+    m_size = 0;
+}
 
-    // 分配新 map
-    T** new_map = new T*[new_map_size];  // 直接分配指针数组
-    
-    // 初始化为 nullptr
-    for (size_t i = 0; i < new_map_size; ++i) {
-        new_map[i] = nullptr;
-    }
-
-    if (m_size > 0) {
-        // 计算新 map 中数据应该放置的位置（居中）
-        size_t blocks_used = (m_size + BLOCK_SIZE - 1) / BLOCK_SIZE;
-        size_t new_start_block = (new_map_size - blocks_used) / 2;
-        
-        // 计算原 map 中使用的块范围
-        size_t first_used_block = m_start_block;
-        size_t last_used_block = m_start_block + blocks_used - 1;
-        
-        // 确保 last_used_block 不越界
-        if (last_used_block >= m_map_size) {
-            // 处理边界情况
-            last_used_block = m_map_size - 1;
+//已用块数相对指针数组较少时（队列式使用，数据整体漂移到一端）只在同样大小的新数组里重新居中，
+//否则按 2 倍扩大。块本身不移动，元素地址保持不变。
+//范围外的备用块尽量保留在原来的相对位置，放不下的直接释放。
+template <class T, class ReleasePolicy>
+void deque<T, ReleasePolicy>::reallocate_map(size_t blocks_to_add, bool add_at_front) {
+    size_t used_blocks = finish_block() - m_start_block + 1;
+    size_t needed_blocks = used_blocks + blocks_to_add;
+
+    size_t new_map_size = m_map_size;
+    if (needed_blocks * 2 > m_map_size) {
+        new_map_size = std::max(m_map_size * 2, needed_blocks * 2);
+    }
+
+    size_t new_start_block = (new_map_size - needed_blocks) / 2
+                             + (add_at_front ? blocks_to_add : 0);
+
+    T** new_map = new_map_array(new_map_size);
+    STL_INSTRUMENT_EVENT(deque, on_map_reallocate());
+
+    for (size_t i = 0; i < m_map_size; ++i) {
+        if (m_map[i] == nullptr) {
+            continue;
         }
-        
-        // 拷贝块指针到新 map
-        for (size_t i = first_used_block, j = 0; 
-             i <= last_used_block && j < blocks_used; 
-             ++i, ++j) {
-            if (i < m_map_size && m_map[i] != nullptr) {
-                new_map[new_start_block + j] = m_map[i];
-                // 注意：不将原指针置空，所有权将转移到新 map
-            }
+        //新位置 = i - m_start_block + new_start_block，用有符号数避免下溢
+        ptrdiff_t j = static_cast<ptrdiff_t>(i) - static_cast<ptrdiff_t>(m_start_block)
+                      + static_cast<ptrdiff_t>(new_start_block);
+        if (j >= 0 && j < static_cast<ptrdiff_t>(new_map_size)) {
+            new_map[j] = m_map[i];
+        } else {
+            deallocate_block(m_map[i]);
         }
-        
-        // 更新起始块索引（注意：是索引，不是指针！）
-        m_start_block = new_start_block;
-    } else {
-        // deque 为空的情况
-        m_start_block = new_map_size / 2;
-        m_start_index = 0;
-    }
-    
-    // 释放旧 map（注意：不释放块内存！）
-    if (m_map) {
-        delete[] m_map;  // 只删除指针数组，不删除块
     }
-    
+
+    delete_map_array(m_map);
     m_map = new_map;
     m_map_size = new_map_size;
+    m_start_block = new_start_block;
 }
 
-template<class T>
-void deque<T>::reallocate_map_for_front(size_t new_map_size) {
-    if (new_map_size <= m_map_size) return;
-    
-    T** new_map = reinterpret_cast<T**>(new char[new_map_size * sizeof(T*)]);
-    std::fill_n(new_map, new_map_size, nullptr);
-    
-    if (m_size > 0) {
-        // 计算当前使用的块
-        size_t total_pos = m_start_index + m_size;
-        size_t first_block = m_start_block;
-        size_t last_block = m_start_block + (total_pos - 1) / BLOCK_SIZE;
-        size_t blocks_used = last_block - first_block + 1;
-        
-        // 将数据放在新map的后2/3处，为前端留出1/3空间
-        size_t new_start = new_map_size * 2 / 3 - blocks_used;
-        
-        for (size_t i = 0; i < blocks_used; ++i) {
-            new_map[new_start + i] = m_map[first_block + i];
-            m_map[first_block + i] = nullptr;
-        }
-        
-        m_start_block = new_start;
-    } else {
-        m_start_block = new_map_size * 2 / 3;
-        m_start_index = BLOCK_SIZE - 1;
-    }
-    
-    if (m_map) {
-        delete[] reinterpret_cast<char*>(m_map);
+template <class T, class ReleasePolicy>
+void deque<T, ReleasePolicy>::initialize_map(size_t n, size_t start_index) {
+    size_t needed_blocks = (start_index + n) / BLOCK_SIZE + 1;
+    allocate_map(std::max(MAP_INIT_SIZE, needed_blocks + 2));
+    m_start_block = (m_map_size - needed_blocks) / 2;
+    m_start_index = start_index;
+    m_size = 0;
+    try {
+        allocate_blocks(m_start_block, m_start_block + needed_blocks);
+    } catch (...) {
+        release_storage();
+        throw;
     }
-    
-    m_map = new_map;
-    m_map_size = new_map_size;
 }
 
-
-template <class T>
-bool deque<T>::is_range_within_deque(T*begin_ptr, T*end_ptr){
-    if (!begin_ptr || !end_ptr||begin_ptr >= end_ptr){
-        return false;
+template <class T, class ReleasePolicy>
+void deque<T, ReleasePolicy>::ensure_back_capacity(size_t n) {
+    if (m_map == nullptr) {
+        initialize_map(n);
+        return;
     }
-
-    if(empty()){
-        return false;
+    size_t last_block = m_start_block + (m_start_index + m_size + n) / BLOCK_SIZE;
+    if (last_block >= m_map_size) {
+        reallocate_map(last_block - finish_block(), false);
+        last_block = m_start_block + (m_start_index + m_size + n) / BLOCK_SIZE;
     }
+    allocate_blocks(finish_block() + 1, last_block + 1);
+}
 
-    size_t range_size = end_ptr - begin_ptr;
-
-    size_t begin_index = SIZE_MAX;
-    size_t end_index = SIZE_MAX;
-
-    T** possible_block = nullptr;
-
-    for(size_t block_idx = 0; block_idx < m_map_size; ++block_idx) {
-        if (m_map[block_idx]) {
-            T* block_begin = m_map[block_idx];
-            T* block_end = block_begin + BLOCK_SIZE;
-
-            if(begin_ptr >= block_begin && begin_ptr < block_end) {
-                possible_block = &m_map[block_idx];
-
-                size_t offset = begin_ptr - block_begin;
-
-                for( size_t i = 0; i < m_size; ++i){
-                    size_t total_pos = m_start_index + i;
-                    size_t actual_block_idx = m_start_block + total_pos /BLOCK_SIZE;
-                    size_t actual_offset = total_pos % BLOCK_SIZE;
+template <class T, class ReleasePolicy>
+void deque<T, ReleasePolicy>::ensure_front_capacity(size_t n) {
+    if (m_map == nullptr) {
+        initialize_map(0);
+    }
+    if (n <= m_start_index) {
+        return;
+    }
+    size_t blocks_needed = (n - m_start_index + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    if (blocks_needed > m_start_block) {
+        reallocate_map(blocks_needed, true);
+    }
+    allocate_blocks(m_start_block - blocks_needed, m_start_block);
+}
 
-                    if(actual_block_idx == block_idx && actual_offset == offset) {
-                        begin_index = i;
-                        break;
-                    }
-                }
-            break;
-            }
-        }
+template <class T, class ReleasePolicy>
+void deque<T, ReleasePolicy>::release_back_spare() {
+    //只在尾后位置刚退回上一块时检查，备用块总是从尾后块往外连续分布
+    if ((m_start_index + m_size) % BLOCK_SIZE != BLOCK_SIZE - 1) {
+        return;
+    }
+    size_t first_spare = finish_block() + 1;
+    size_t spare = 0;
+    while (first_spare + spare < m_map_size && m_map[first_spare + spare] != nullptr
+           && !ReleasePolicy::should_release_block(spare)) {
+        ++spare;
     }
-    if(begin_index == SIZE_MAX){
-        return false;
+    if (!ReleasePolicy::should_release_block(spare)) {
+        return;
+    }
+    for (size_t i = first_spare + ReleasePolicy::SPARE_BLOCKS; i < m_map_size && m_map[i] != nullptr; ++i) {
+        deallocate_block(m_map[i]);
+        m_map[i] = nullptr;
     }
-    for(size_t i = 0; i < range_size; ++i){
-        size_t current_index = begin_index +i;
+}
 
-        if(current_index >= m_size) {
-            return false;
-        }
-        size_t total_pos = m_start_index + current_index;
-        size_t block_idx = m_start_block + total_pos / BLOCK_SIZE;
-        size_t offset = total_pos % BLOCK_SIZE;
-
-        T* expected_ptr = m_map[block_idx]+ offset;
-        T* actual_ptr = begin_ptr + i;
-
-        if(expected_ptr != actual_ptr){
-            return false;
-        } 
-    }
-    return true;
-}
-
-template<class T>
-void deque<T>::ensure_capacity_at_back(size_t n) {
-    if (n == 0) return;
-    
-    // 计算需要多少额外空间
-    size_t current_total = m_start_index + m_size;
-    size_t needed_total = current_total + n;
-    size_t current_last_block = m_start_block + (current_total - 1) / BLOCK_SIZE;
-    size_t needed_last_block = m_start_block + (needed_total - 1) / BLOCK_SIZE;
-    
-    // 如果需要的块超过了当前map大小，需要扩展map
-    if (needed_last_block >= m_map_size) {
-        size_t new_map_size = m_map_size;
-        while (needed_last_block >= new_map_size) {
-            new_map_size *= 2;
-        }
-        reallocate_map(new_map_size);
+template <class T, class ReleasePolicy>
+void deque<T, ReleasePolicy>::release_front_spare() {
+    if (m_start_index != 0) {
+        return;
     }
-    
-    // 确保所有需要的块都已分配
-    for (size_t i = current_last_block + 1; i <= needed_last_block; ++i) {
-        if (i < m_map_size && m_map[i] == nullptr) {
-            m_map[i] = deque<T>::allocate_block();
-        }
+    size_t spare = 0;
+    while (spare < m_start_block && m_map[m_start_block - 1 - spare] != nullptr
+           && !ReleasePolicy::should_release_block(spare)) {
+        ++spare;
+    }
+    if (!ReleasePolicy::should_release_block(spare)) {
+        return;
+    }
+    for (size_t i = m_start_block - ReleasePolicy::SPARE_BLOCKS; i-- > 0 && m_map[i] != nullptr;) {
+        deallocate_block(m_map[i]);
+        m_map[i] = nullptr;
     }
 }
 
-template<class T>
-typename deque<T>::iterator deque<T>::internal_begin(){
-    return begin();
+template <class T, class ReleasePolicy>
+void deque<T, ReleasePolicy>::reserve_back(size_t n) {
+    ensure_back_capacity(n);
 }
 
-template<class T>
-typename deque<T>::iterator deque<T>::internal_end(){
-    return end();
+template <class T, class ReleasePolicy>
+void deque<T, ReleasePolicy>::reserve_front(size_t n) {
+    ensure_front_capacity(n);
 }
 
-template<class T>
-void deque<T>::move_elements_forward(iterator pos, size_t n){
-    if(n == 0) {
+template <class T, class ReleasePolicy>
+void deque<T, ReleasePolicy>::shrink_to_fit() {
+    if (m_map == nullptr) {
         return;
     }
-    size_t pos_index = std::distance(internal_begin(),pos);
-
-    size_t elements_to_move = m_size - pos_index;
+    if (m_size == 0) {
+        release_storage();
+        return;
+    }
+    size_t last = finish_block();
+    deallocate_blocks(0, m_start_block);
+    deallocate_blocks(last + 1, m_map_size);
 
-    if (elements_to_move == 0) {
+    size_t used_blocks = last - m_start_block + 1;
+    size_t new_map_size = std::max(MAP_INIT_SIZE, used_blocks + 2);
+    if (new_map_size >= m_map_size) {
         return;
     }
-    
-    for (size_t i = m_size -1; i>=pos_index; --i){
-        if( i> pos_index) {
-            break;
-        }
+    T** new_map = new_map_array(new_map_size);
+    STL_INSTRUMENT_EVENT(deque, on_map_reallocate());
+    size_t new_start_block = (new_map_size - used_blocks) / 2;
+    std::copy(m_map + m_start_block, m_map + last + 1, new_map + new_start_block);
+    delete_map_array(m_map);
+    m_map = new_map;
+    m_map_size = new_map_size;
+    m_start_block = new_start_block;
+}
 
-        size_t src_total = m_start_index + i;
-        size_t src_block = m_start_block + src_total / BLOCK_SIZE;
-        size_t src_idx = src_total % BLOCK_SIZE;
+template <class T, class ReleasePolicy>
+template <class F>
+void deque<T, ReleasePolicy>::for_each_segment(F f) const {
+    size_t block = m_start_block;
+    size_t offset = m_start_index;
+    size_t remaining = m_size;
+    while (remaining > 0) {
+        size_t len = std::min(remaining, BLOCK_SIZE - offset);
+        //保护槽位保证 block + PREFETCH_BLOCKS 不越界
+        prefetch_block_head(m_map + block + PREFETCH_BLOCKS);
+        f(m_map[block] + offset, len);
+        remaining -= len;
+        offset = 0;
+        ++block;
+    }
+}
 
-        size_t dst_total = m_start_index + i + n;
-        size_t dst_block = m_start_block + dst_total / BLOCK_SIZE;
-        size_t dst_idx = dst_total % BLOCK_SIZE;
+template <class T, class ReleasePolicy>
+template <class F>
+size_t deque<T, ReleasePolicy>::append_with(size_t n, F f) {
+    static_assert(std::is_trivially_default_constructible<T>::value &&
+                  std::is_trivially_destructible<T>::value,
+                  "deque::append_with: 只支持平凡类型");
+    if (n == 0) {
+        return 0;
+    }
+    ensure_back_capacity(n);
+    size_t total = 0;
+    while (total < n) {
+        size_t pos = m_start_index + m_size;
+        size_t offset = pos % BLOCK_SIZE;
+        size_t len = std::min(n - total, BLOCK_SIZE - offset);
+        size_t filled = f(m_map[m_start_block + pos / BLOCK_SIZE] + offset, len);
+        if (filled > len) {
+            throw std::length_error("deque::append_with: callback wrote more than requested");
+        }
+        m_size += filled;
+        total += filled;
+        if (filled < len) {
+            break;
+        }
+    }
+    return total;
+}
 
-        if(dst_block >= m_map_size) {
-            throw std::runtime_error("move_elements_forward: destination out of map bounds");
-        } 
+template <class T, class ReleasePolicy>
+template <class F>
+void deque<T, ReleasePolicy>::for_each(F f, size_t prefetch_blocks) {
+    scan_forward<T>(f, prefetch_blocks);
+}
 
-        if (m_map[dst_block] == nullptr) {
-            m_map[dst_block] = reinterpret_cast<T*>(new char[BLOCK_SIZE * sizeof(T)]);
-        }
+template <class T, class ReleasePolicy>
+template <class F>
+void deque<T, ReleasePolicy>::for_each(F f, size_t prefetch_blocks) const {
+    scan_forward<const T>(f, prefetch_blocks);
+}
 
-        if(i + n < m_size + n){
-            if(m_map[src_block] != nullptr){
-                m_map[dst_block][dst_idx].~T();
-            }
+template <class T, class ReleasePolicy>
+template <class F>
+void deque<T, ReleasePolicy>::for_each_reverse(F f, size_t prefetch_blocks) {
+    scan_backward<T>(f, prefetch_blocks);
+}
 
-            new (m_map[dst_block] + dst_idx) T(std::move(m_map[src_block][src_idx]));
-            m_map[src_block][src_idx].~T();
-        }
-    }
+template <class T, class ReleasePolicy>
+template <class F>
+void deque<T, ReleasePolicy>::for_each_reverse(F f, size_t prefetch_blocks) const {
+    scan_backward<const T>(f, prefetch_blocks);
 }
 
-template<class T>
-void deque<T>::move_elements_backward(iterator pos, size_t n){
-    if(n == 0 ||pos == internal_begin()) {
+//每条缓存行的元素之前，预取前方第 prefetch_blocks 块里同一块内偏移处的元素；
+//超出最后一块后不再预取。块都是完整分配的，偏移处即使没有元素也可以预取
+template <class T, class ReleasePolicy>
+template <class Elem, class F>
+void deque<T, ReleasePolicy>::scan_forward(F& f, size_t prefetch_blocks) const {
+    if (m_size == 0) {
         return;
     }
-
-    size_t pos_index = 0;
-    iterator it = internal_begin();
-    while (it != pos && it != internal_end()) {
-        ++it;
-        ++pos_index;
-    }
-
-    for(size_t i=0; i<n; ++i) {
-        if(m_start_index == 0){
-            if(m_start_block == 0){
-                reallocate_map_for_front(m_map_size * 2);
+    const size_t line = std::max<size_t>(1, STL_CACHE_LINE / sizeof(T));
+    size_t last = m_start_block + (m_start_index + m_size - 1) / BLOCK_SIZE;
+    size_t offset = m_start_index;
+    size_t remaining = m_size;
+    for (size_t block = m_start_block; remaining > 0; ++block) {
+        size_t len = std::min(remaining, BLOCK_SIZE - offset);
+        Elem* data = m_map[block];
+        const T* ahead = (prefetch_blocks > 0 && prefetch_blocks <= last - block)
+                         ? m_map[block + prefetch_blocks] : nullptr;
+        for (size_t i = offset; i < offset + len;) {
+            size_t end = std::min(offset + len, i + line);
+            if (ahead != nullptr) {
+                stl_prefetch_range(ahead + i, (end - i) * sizeof(T));
+            }
+            for (; i < end; ++i) {
+                f(data[i]);
             }
-            --m_start_block;
-            m_map[m_start_block] = reinterpret_cast<T*>(new char[BLOCK_SIZE * sizeof(T)]);
-            m_start_index = BLOCK_SIZE;
-        }
-        --m_start_index;
-        new (m_map[m_start_block] + m_start_index) T();
-        ++m_size;
-    }
-
-    for(size_t i = 0; i < pos_index; ++i){
-        size_t src_total = m_start_index + n + i;
-        size_t src_block = m_start_block + src_total /BLOCK_SIZE;
-        size_t src_idx = src_total % BLOCK_SIZE;
-
-        size_t dst_total = m_start_index + i;
-        size_t dst_block = m_start_block + dst_total / BLOCK_SIZE;
-        size_t dst_idx = dst_total % BLOCK_SIZE;
-
-        if(m_map[src_block] != nullptr) {
-            m_map[dst_block][dst_idx] = std::move(m_map[src_block][src_idx]);
         }
+        remaining -= len;
+        offset = 0;
     }
 }
 
-template<class T>
-void deque<T>::ensure_back_capacity(size_t n){
-    if (n == 0) return;
-
-    size_t new_total_elements = m_size + n;
-    size_t needed_blocks = 0;
-    if (new_total_elements > 0) {
-        // 考虑起始位置
-        size_t total_positions = m_start_index + new_total_elements;
-        needed_blocks = (total_positions + BLOCK_SIZE - 1) / BLOCK_SIZE;
-    }
-    
-    size_t available_blocks = 0;
-    if (m_map != nullptr) {
-        available_blocks = m_map_size - m_start_block;
+template <class T, class ReleasePolicy>
+template <class Elem, class F>
+void deque<T, ReleasePolicy>::scan_backward(F& f, size_t prefetch_blocks) const {
+    if (m_size == 0) {
+        return;
     }
-    
-    if (needed_blocks > available_blocks) {
-        size_t new_map_size = m_map_size;
-        while (needed_blocks > new_map_size - m_start_block) {
-            new_map_size *= 2;
+    const size_t line = std::max<size_t>(1, STL_CACHE_LINE / sizeof(T));
+    size_t end_pos = m_start_index + m_size;     //相对 m_start_block 起点的尾后位置
+    size_t block = m_start_block + (end_pos - 1) / BLOCK_SIZE;
+    size_t end = (end_pos - 1) % BLOCK_SIZE + 1;
+    size_t remaining = m_size;
+    for (;; --block) {
+        size_t len = std::min(remaining, end);
+        size_t begin = end - len;
+        Elem* data = m_map[block];
+        const T* ahead = (prefetch_blocks > 0 && prefetch_blocks <= block - m_start_block)
+                         ? m_map[block - prefetch_blocks] : nullptr;
+        for (size_t i = end; i > begin;) {
+            size_t stop = i - std::min(i - begin, line);
+            if (ahead != nullptr) {
+                stl_prefetch_range(ahead + stop, (i - stop) * sizeof(T));
+            }
+            while (i > stop) {
+                f(data[--i]);
+            }
         }
-        deque<T>::reallocate_map(new_map_size);
-    }
-    
-    size_t first_block_to_check = m_start_block;
-    if (m_size > 0) {
-        size_t last_used_pos = m_start_index + m_size - 1;
-        first_block_to_check = m_start_block + last_used_pos / BLOCK_SIZE + 1;
-    }
-    
-    size_t last_needed_block = m_start_block + needed_blocks - 1;
-    
-    for (size_t i = first_block_to_check; i <= last_needed_block; ++i) {
-        if (i < m_map_size && m_map[i] == nullptr) {
-            m_map[i] = reinterpret_cast<T*>(new char[BLOCK_SIZE * sizeof(T)]);
+        remaining -= len;
+        if (remaining == 0) {
+            break;
         }
+        end = BLOCK_SIZE;
     }
 }
 
-template<class T>
-void deque<T>::swap(deque<T>& other) noexcept {
-    using std::swap;
-    
-    swap(m_map, other.m_map);
-    swap(m_map_size, other.m_map_size);
-    swap(m_start_block, other.m_start_block);
-    swap(m_start_index, other.m_start_index);
-    swap(m_size, other.m_size);
+template <class T, class ReleasePolicy>
+void deque<T, ReleasePolicy>::copy_trivial(size_t index, const T* src, size_t n) {
+    size_t pos = m_start_index + index;
+    while (n > 0) {
+        size_t offset = pos % BLOCK_SIZE;
+        size_t len = std::min(n, BLOCK_SIZE - offset);
+        std::memmove(static_cast<void*>(m_map[m_start_block + pos / BLOCK_SIZE] + offset), src, len * sizeof(T));
+        pos += len;
+        src += len;
+        n -= len;
+    }
 }
 
-template<class T>
-void deque<T>::deallocate_block(T* block) {
-    if (block != nullptr) {
-        // 如果块中有元素，需要先析构（但在这个场景下，块应该是空的）
-        delete[] reinterpret_cast<char*>(block);
+template <class T, class ReleasePolicy>
+template <class Copy>
+void deque<T, ReleasePolicy>::assign_trivial(size_t n, Copy copy) {
+    if (n > m_size) {
+        ensure_back_capacity(n - m_size);
+    }
+    if (m_map == nullptr) {
+        return;
     }
+    copy();
+    m_size = n;
+    //缩短后只保留尾后位置之后的一个备用块
+    deallocate_blocks(finish_block() + 2, m_map_size);
 }
 
-template<class T>
-bool deque<T>::should_release_block(size_t block_index) const {
-    // 计算当前使用的块范围
-    size_t used_blocks = (m_size + BLOCK_SIZE - 1) / BLOCK_SIZE;
-    size_t first_used = m_start_block;
-    size_t last_used = m_start_block + used_blocks - 1;
-    
-    // 如果块在使用范围内，不能释放
-    if (block_index >= first_used && block_index <= last_used) {
-        return false;
-    }
-    
-    // 确保有足够的缓冲块（比如前后各保留2个块）
-    size_t buffer_blocks = 2;
-    if (block_index < m_start_block - buffer_blocks || 
-        block_index > last_used + buffer_blocks) {
-        return true;
+template <class T, class ReleasePolicy>
+void deque<T, ReleasePolicy>::relocate(T* src, size_t n, T* dst) {
+    if constexpr (TRIVIAL) {
+        if (n > 0) {
+            std::memcpy(static_cast<void*>(dst), src, n * sizeof(T));
+        }
+    } else {
+        size_t i = 0;
+        try {
+            for (; i < n; ++i) {
+                new (dst + i) T(std::move_if_noexcept(src[i]));
+            }
+        } catch (...) {
+            for (size_t j = 0; j < i; ++j) {
+                dst[j].~T();
+            }
+            throw;
+        }
+        for (size_t j = 0; j < n; ++j) {
+            src[j].~T();
+        }
     }
-    
-    return false;
 }
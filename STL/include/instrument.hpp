@@ -0,0 +1,238 @@
+#pragma once
+#include<iostream>
+#include <stdexcept>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <typeinfo>
+#include <cstdlib>
+#if defined(__GNUG__)
+#include <cxxabi.h>
+#endif
+
+// 容器插桩：统计 vector / deque 的内存分配和关键操作，按容器类型（含元素类型）汇总。
+// 默认关闭。定义 STL_INSTRUMENT 后容器中的 STL_INSTRUMENT_EVENT 才会展开成计数代码，
+// 未定义时展开为空语句，不产生任何开销。
+//     instrument_registry::instance().dump_text(std::cout);
+//     instrument_registry::instance().dump_json(file);
+// 统计口径：
+//   allocations / frees / bytes_*：元素存储的分配与释放；deque 中一次分配就是一个数据块，
+//                                  live 块数 = allocations - frees（指针数组不计入）
+//   grow_events / element_moves  ：vector 扩容次数，以及扩容时逐个移动的元素数（按字节重定位不计）
+//   map_reallocations            ：deque 指针数组的重新分配次数
+//   retired / *_bytes            ：vector 析构时的已用字节和空闲（capacity - size）字节，用来评估 reserve 是否合适
+// 计数器都是 relaxed 原子变量，多线程下各项之间不保证是同一时刻的快照。
+
+struct container_stats
+{
+    std::atomic<size_t> allocations{0};
+    std::atomic<size_t> frees{0};
+    std::atomic<size_t> bytes_allocated{0};
+    std::atomic<size_t> bytes_freed{0};
+    std::atomic<size_t> peak_live_bytes{0};
+    std::atomic<size_t> grow_events{0};
+    std::atomic<size_t> element_moves{0};
+    std::atomic<size_t> map_reallocations{0};
+    std::atomic<size_t> retired{0};
+    std::atomic<size_t> retired_used_bytes{0};
+    std::atomic<size_t> retired_slack_bytes{0};
+
+    void on_allocate(size_t bytes);
+    void on_free(size_t bytes);
+    void on_grow(size_t moved_elements);
+    void on_map_reallocate();
+    void on_retire(size_t used_bytes, size_t capacity_bytes);
+    void reset();
+};
+
+//全局登记表：类型名 -> 统计数据。登记表本身故意不析构，
+//保证静态对象中的容器在程序退出阶段析构时仍能安全计数
+class instrument_registry
+{
+private:
+    mutable std::mutex m_mutex;
+    std::map<std::string, std::unique_ptr<container_stats> > m_stats;
+
+    instrument_registry() = default;
+
+public:
+    instrument_registry(const instrument_registry&) = delete;
+    instrument_registry& operator=(const instrument_registry&) = delete;
+
+    static instrument_registry& instance();
+
+    //取得某个类型的统计数据（不存在则创建），返回的引用永久有效
+    container_stats& stats(const std::string& type_name);
+
+    //输出
+    void dump_text(std::ostream& os) const;
+    void dump_json(std::ostream& os) const;
+
+    //计数清零（保留已登记的类型）
+    void reset();
+};
+
+//可读的类型名
+template <class C>
+std::string instrument_type_name()
+{
+    const char* name = typeid(C).name();
+#if defined(__GNUG__)
+    int status = 0;
+    char* demangled = abi::__cxa_demangle(name, nullptr, nullptr, &status);
+    if (status == 0 && demangled) {
+        std::string result(demangled);
+        std::free(demangled);
+        return result;
+    }
+#endif
+    return name;
+}
+
+//每个容器类型只在第一次使用时查一次登记表
+template <class C>
+container_stats& instrument_stats()
+{
+    static container_stats& stats = instrument_registry::instance().stats(instrument_type_name<C>());
+    return stats;
+}
+
+#ifdef STL_INSTRUMENT
+#define STL_INSTRUMENT_EVENT(Container, call) (instrument_stats<Container>().call)
+#else
+#define STL_INSTRUMENT_EVENT(Container, call) ((void)0)
+#endif
+
+
+//container_stats 实现
+inline void container_stats::on_allocate(size_t bytes)
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    size_t allocated = bytes_allocated.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    size_t live = allocated - bytes_freed.load(std::memory_order_relaxed);
+    size_t peak = peak_live_bytes.load(std::memory_order_relaxed);
+    while (live > peak && !peak_live_bytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+    }
+}
+
+inline void container_stats::on_free(size_t bytes)
+{
+    frees.fetch_add(1, std::memory_order_relaxed);
+    bytes_freed.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+inline void container_stats::on_grow(size_t moved_elements)
+{
+    grow_events.fetch_add(1, std::memory_order_relaxed);
+    element_moves.fetch_add(moved_elements, std::memory_order_relaxed);
+}
+
+inline void container_stats::on_map_reallocate()
+{
+    map_reallocations.fetch_add(1, std::memory_order_relaxed);
+}
+
+inline void container_stats::on_retire(size_t used_bytes, size_t capacity_bytes)
+{
+    retired.fetch_add(1, std::memory_order_relaxed);
+    retired_used_bytes.fetch_add(used_bytes, std::memory_order_relaxed);
+    retired_slack_bytes.fetch_add(capacity_bytes - used_bytes, std::memory_order_relaxed);
+}
+
+inline void container_stats::reset()
+{
+    std::atomic<size_t>* counters[] = {
+        &allocations, &frees, &bytes_allocated, &bytes_freed, &peak_live_bytes,
+        &grow_events, &element_moves, &map_reallocations,
+        &retired, &retired_used_bytes, &retired_slack_bytes
+    };
+    for (std::atomic<size_t>* counter : counters) {
+        counter->store(0, std::memory_order_relaxed);
+    }
+}
+
+
+//instrument_registry 实现
+inline instrument_registry& instrument_registry::instance()
+{
+    static instrument_registry* registry = new instrument_registry();
+    return *registry;
+}
+
+inline container_stats& instrument_registry::stats(const std::string& type_name)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::unique_ptr<container_stats>& slot = m_stats[type_name];
+    if (!slot) {
+        slot.reset(new container_stats());
+    }
+    return *slot;
+}
+
+inline void instrument_registry::dump_text(std::ostream& os) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (const auto& entry : m_stats) {
+        const container_stats& s = *entry.second;
+        size_t allocated = s.bytes_allocated.load(std::memory_order_relaxed);
+        size_t freed = s.bytes_freed.load(std::memory_order_relaxed);
+        os << entry.first << "\n"
+           << "  allocations: " << s.allocations.load(std::memory_order_relaxed)
+           << "  frees: " << s.frees.load(std::memory_order_relaxed)
+           << "  bytes allocated: " << allocated
+           << "  bytes freed: " << freed
+           << "  live bytes: " << allocated - freed
+           << "  peak live bytes: " << s.peak_live_bytes.load(std::memory_order_relaxed) << "\n"
+           << "  grow events: " << s.grow_events.load(std::memory_order_relaxed)
+           << "  element moves: " << s.element_moves.load(std::memory_order_relaxed)
+           << "  map reallocations: " << s.map_reallocations.load(std::memory_order_relaxed) << "\n"
+           << "  retired: " << s.retired.load(std::memory_order_relaxed)
+           << "  retired used bytes: " << s.retired_used_bytes.load(std::memory_order_relaxed)
+           << "  retired slack bytes: " << s.retired_slack_bytes.load(std::memory_order_relaxed) << "\n";
+    }
+}
+
+inline void instrument_registry::dump_json(std::ostream& os) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    os << "{";
+    bool first = true;
+    for (const auto& entry : m_stats) {
+        const container_stats& s = *entry.second;
+        if (!first) {
+            os << ",";
+        }
+        first = false;
+        os << "\n  \"";
+        for (char c : entry.first) {
+            if (c == '"' || c == '\\') {
+                os << '\\';
+            }
+            os << c;
+        }
+        os << "\": {"
+           << "\"allocations\": " << s.allocations.load(std::memory_order_relaxed)
+           << ", \"frees\": " << s.frees.load(std::memory_order_relaxed)
+           << ", \"bytes_allocated\": " << s.bytes_allocated.load(std::memory_order_relaxed)
+           << ", \"bytes_freed\": " << s.bytes_freed.load(std::memory_order_relaxed)
+           << ", \"peak_live_bytes\": " << s.peak_live_bytes.load(std::memory_order_relaxed)
+           << ", \"grow_events\": " << s.grow_events.load(std::memory_order_relaxed)
+           << ", \"element_moves\": " << s.element_moves.load(std::memory_order_relaxed)
+           << ", \"map_reallocations\": " << s.map_reallocations.load(std::memory_order_relaxed)
+           << ", \"retired\": " << s.retired.load(std::memory_order_relaxed)
+           << ", \"retired_used_bytes\": " << s.retired_used_bytes.load(std::memory_order_relaxed)
+           << ", \"retired_slack_bytes\": " << s.retired_slack_bytes.load(std::memory_order_relaxed)
+           << "}";
+    }
+    os << (first ? "}" : "\n}") << "\n";
+}
+
+inline void instrument_registry::reset()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto& entry : m_stats) {
+        entry.second->reset();
+    }
+}
@@ -0,0 +1,388 @@
+#pragma once
+#include<iostream>
+#include <stdexcept>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <functional>
+#include <utility>
+#include <new>
+#include "vector.hpp"
+
+// 无锁栈（Treiber 栈）
+// 栈顶指针与空闲链表都使用带版本号的指针（高16位为版本号，低48位为地址）来避免 ABA。
+// 节点出栈后不会归还给系统，而是放入空闲链表复用，栈析构时统一释放，
+// 因此并发读取旧栈顶的 next 总是安全的（最多读到过期值，随后的 CAS 会因版本号不同而失败）。
+template <class T>
+class lockfree_stack
+{
+private:
+
+    struct node
+    {
+        alignas(T) unsigned char m_storage[sizeof(T)];
+        std::atomic<node*> m_next{nullptr};
+
+        T* value() { return reinterpret_cast<T*>(m_storage); }
+    };
+
+    static const uint64_t PTR_MASK = (uint64_t(1) << 48) - 1;
+    static const uint64_t TAG_SHIFT = 48;
+    static const size_t ELIMINATION_SPIN = 256;   //压栈方在消除槽中等待的轮数
+
+    alignas(64) std::atomic<uint64_t> m_head{0};       //栈顶（带版本号）
+    alignas(64) std::atomic<uint64_t> m_free_head{0};  //空闲节点链表（带版本号）
+    std::atomic<uint64_t>* m_elimination = nullptr;  //消除回退数组
+    size_t m_elimination_size = 0;
+
+public:
+
+    //构造
+    explicit lockfree_stack(size_t elimination_slots = 0);
+    lockfree_stack(const lockfree_stack&) = delete;
+    lockfree_stack& operator=(const lockfree_stack&) = delete;
+
+    //析构（调用时不能有其他线程仍在访问）
+    ~lockfree_stack();
+
+    //压栈和出栈
+    void push(const T& val);
+    void push(T&& val);
+    //赋值抛异常时元素留在栈上
+    bool try_pop(T& out);
+
+    //批量操作：整条链一次 CAS 挂上栈顶 / 一次摘下整个栈；
+    //pop_all 的处理函数抛异常时，还没处理完的元素（含抛异常的那个）按原顺序放回栈上
+    template <class InputIt>
+    void push_batch(InputIt first, InputIt last);
+    size_t pop_all(vector<T>& out);
+    size_t pop_all(const std::function<void(T&)>& consume);
+
+    //状态（并发下只是瞬时快照）
+    bool empty() const { return unpack(m_head.load(std::memory_order_acquire)) == nullptr; }
+    size_t elimination_slots() const { return m_elimination_size; }
+
+private:
+
+    static uint64_t pack(node* ptr, uint64_t tag) {
+        return (tag << TAG_SHIFT) | (reinterpret_cast<uint64_t>(ptr) & PTR_MASK);
+    }
+    static node* unpack(uint64_t v) { return reinterpret_cast<node*>(v & PTR_MASK); }
+    static uint64_t tag_of(uint64_t v) { return v >> TAG_SHIFT; }
+
+    node* acquire_node();
+    void recycle_node(node* n);
+
+    //把 [first, last] 这条已链好的链挂到栈顶
+    void push_chain(node* first, node* last);
+    void push_node(node* n);
+
+    //消除回退：压栈方把节点挂在槽里等待，出栈方直接取走
+    bool try_eliminate_push(node* n);
+    node* try_eliminate_pop();
+    size_t pick_slot() const;
+
+    static void free_list(node* n, bool destroy_values);
+};
+
+static_assert(sizeof(void*) == 8, "lockfree_stack: 带版本号指针需要 64 位地址");
+
+
+//构造
+template <class T>
+lockfree_stack<T>::lockfree_stack(size_t elimination_slots)
+: m_elimination_size(elimination_slots)
+{
+    if (m_elimination_size > 0) {
+        m_elimination = new std::atomic<uint64_t>[m_elimination_size];
+        for (size_t i = 0; i < m_elimination_size; ++i) {
+            m_elimination[i].store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+//析构
+template <class T>
+lockfree_stack<T>::~lockfree_stack()
+{
+    free_list(unpack(m_head.load(std::memory_order_acquire)), true);
+    free_list(unpack(m_free_head.load(std::memory_order_acquire)), false);
+    delete[] m_elimination;
+}
+
+template <class T>
+void lockfree_stack<T>::free_list(node* n, bool destroy_values)
+{
+    while (n) {
+        node* next = n->m_next.load(std::memory_order_relaxed);
+        if (destroy_values) {
+            n->value()->~T();
+        }
+        delete n;
+        n = next;
+    }
+}
+
+//压栈
+template <class T>
+void lockfree_stack<T>::push(const T& val)
+{
+    node* n = acquire_node();
+    try {
+        new (n->value()) T(val);
+    } catch (...) {
+        recycle_node(n);
+        throw;
+    }
+    push_node(n);
+}
+
+template <class T>
+void lockfree_stack<T>::push(T&& val)
+{
+    node* n = acquire_node();
+    try {
+        new (n->value()) T(std::move(val));
+    } catch (...) {
+        recycle_node(n);
+        throw;
+    }
+    push_node(n);
+}
+
+template <class T>
+void lockfree_stack<T>::push_node(node* n)
+{
+    uint64_t old_head = m_head.load(std::memory_order_relaxed);
+    while (true) {
+        n->m_next.store(unpack(old_head), std::memory_order_relaxed);
+        if (m_head.compare_exchange_weak(old_head, pack(n, tag_of(old_head) + 1),
+                                         std::memory_order_release,
+                                         std::memory_order_relaxed)) {
+            return;
+        }
+        //竞争失败：尝试与出栈方直接交换
+        if (m_elimination_size > 0 && try_eliminate_push(n)) {
+            return;
+        }
+        old_head = m_head.load(std::memory_order_relaxed);
+    }
+}
+
+template <class T>
+void lockfree_stack<T>::push_chain(node* first, node* last)
+{
+    uint64_t old_head = m_head.load(std::memory_order_relaxed);
+    while (true) {
+        last->m_next.store(unpack(old_head), std::memory_order_relaxed);
+        if (m_head.compare_exchange_weak(old_head, pack(first, tag_of(old_head) + 1),
+                                         std::memory_order_release,
+                                         std::memory_order_relaxed)) {
+            return;
+        }
+    }
+}
+
+//出栈
+template <class T>
+bool lockfree_stack<T>::try_pop(T& out)
+{
+    uint64_t old_head = m_head.load(std::memory_order_acquire);
+    node* n = nullptr;
+    while (true) {
+        n = unpack(old_head);
+        if (n == nullptr) {
+            //栈空时仍可能有压栈方在消除槽中等待
+            n = (m_elimination_size > 0) ? try_eliminate_pop() : nullptr;
+            if (n == nullptr) {
+                return false;
+            }
+            break;
+        }
+        node* next = n->m_next.load(std::memory_order_relaxed);
+        if (m_head.compare_exchange_weak(old_head, pack(next, tag_of(old_head) + 1),
+                                         std::memory_order_acquire,
+                                         std::memory_order_acquire)) {
+            break;
+        }
+        if (m_elimination_size > 0) {
+            node* eliminated = try_eliminate_pop();
+            if (eliminated) {
+                n = eliminated;
+                break;
+            }
+            old_head = m_head.load(std::memory_order_acquire);
+        }
+    }
+
+    //赋值抛异常时把节点放回栈上，元素不会丢
+    try {
+        out = std::move(*n->value());
+    } catch (...) {
+        push_node(n);
+        throw;
+    }
+    n->value()->~T();
+    recycle_node(n);
+    return true;
+}
+
+//批量压栈：先在本地把所有节点链好，再用一次 CAS 发布
+template <class T>
+template <class InputIt>
+void lockfree_stack<T>::push_batch(InputIt first, InputIt last)
+{
+    node* chain_first = nullptr;
+    node* chain_last = nullptr;
+    try {
+        for (; first != last; ++first) {
+            node* n = acquire_node();
+            try {
+                new (n->value()) T(*first);
+            } catch (...) {
+                recycle_node(n);
+                throw;
+            }
+            //新元素放在链头，保证与逐个 push 的出栈顺序一致
+            n->m_next.store(chain_first, std::memory_order_relaxed);
+            chain_first = n;
+            if (chain_last == nullptr) {
+                chain_last = n;
+            }
+        }
+    } catch (...) {
+        free_list(chain_first, true);
+        throw;
+    }
+    if (chain_first) {
+        push_chain(chain_first, chain_last);
+    }
+}
+
+//一次摘下整个栈，按出栈顺序移动追加到 out
+template <class T>
+size_t lockfree_stack<T>::pop_all(vector<T>& out)
+{
+    return pop_all([&out](T& val) { out.push_back(std::move(val)); });
+}
+
+template <class T>
+size_t lockfree_stack<T>::pop_all(const std::function<void(T&)>& consume)
+{
+    uint64_t old_head = m_head.load(std::memory_order_acquire);
+    while (!m_head.compare_exchange_weak(old_head, pack(nullptr, tag_of(old_head) + 1),
+                                         std::memory_order_acquire,
+                                         std::memory_order_acquire)) {
+    }
+
+    size_t count = 0;
+    node* n = unpack(old_head);
+    while (n) {
+        node* next = n->m_next.load(std::memory_order_relaxed);
+        try {
+            consume(*n->value());
+        } catch (...) {
+            //consume 抛异常：当前节点和剩下的整条链按原顺序挂回栈顶，再把异常抛出去
+            node* last = n;
+            while (node* after = last->m_next.load(std::memory_order_relaxed)) {
+                last = after;
+            }
+            push_chain(n, last);
+            throw;
+        }
+        n->value()->~T();
+        recycle_node(n);
+        n = next;
+        ++count;
+    }
+    return count;
+}
+
+//节点复用
+template <class T>
+typename lockfree_stack<T>::node* lockfree_stack<T>::acquire_node()
+{
+    uint64_t old_head = m_free_head.load(std::memory_order_acquire);
+    while (unpack(old_head) != nullptr) {
+        node* n = unpack(old_head);
+        node* next = n->m_next.load(std::memory_order_relaxed);
+        if (m_free_head.compare_exchange_weak(old_head, pack(next, tag_of(old_head) + 1),
+                                              std::memory_order_acquire,
+                                              std::memory_order_acquire)) {
+            return n;
+        }
+    }
+    return new node;
+}
+
+template <class T>
+void lockfree_stack<T>::recycle_node(node* n)
+{
+    uint64_t old_head = m_free_head.load(std::memory_order_relaxed);
+    do {
+        n->m_next.store(unpack(old_head), std::memory_order_relaxed);
+    } while (!m_free_head.compare_exchange_weak(old_head, pack(n, tag_of(old_head) + 1),
+                                                std::memory_order_release,
+                                                std::memory_order_relaxed));
+}
+
+//消除回退
+//槽的值同样带版本号：每次状态变化版本号加一，防止压栈方撤回时误撤别人的节点
+template <class T>
+size_t lockfree_stack<T>::pick_slot() const
+{
+    thread_local uint32_t seed =
+        static_cast<uint32_t>(std::hash<std::thread::id>()(std::this_thread::get_id())) | 1u;
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return seed % m_elimination_size;
+}
+
+template <class T>
+bool lockfree_stack<T>::try_eliminate_push(node* n)
+{
+    std::atomic<uint64_t>& slot = m_elimination[pick_slot()];
+    uint64_t old_value = slot.load(std::memory_order_relaxed);
+    if (unpack(old_value) != nullptr) {
+        return false;
+    }
+    uint64_t offered = pack(n, tag_of(old_value) + 1);
+    if (!slot.compare_exchange_strong(old_value, offered,
+                                      std::memory_order_release,
+                                      std::memory_order_relaxed)) {
+        return false;
+    }
+
+    for (size_t i = 0; i < ELIMINATION_SPIN; ++i) {
+        if (slot.load(std::memory_order_acquire) != offered) {
+            return true;   //已被出栈方取走
+        }
+    }
+
+    //超时撤回；撤回失败说明刚好被取走
+    uint64_t expected = offered;
+    if (slot.compare_exchange_strong(expected, pack(nullptr, tag_of(offered) + 1),
+                                     std::memory_order_acquire,
+                                     std::memory_order_acquire)) {
+        return false;
+    }
+    return true;
+}
+
+template <class T>
+typename lockfree_stack<T>::node* lockfree_stack<T>::try_eliminate_pop()
+{
+    std::atomic<uint64_t>& slot = m_elimination[pick_slot()];
+    uint64_t old_value = slot.load(std::memory_order_acquire);
+    node* n = unpack(old_value);
+    if (n == nullptr) {
+        return nullptr;
+    }
+    if (slot.compare_exchange_strong(old_value, pack(nullptr, tag_of(old_value) + 1),
+                                     std::memory_order_acquire,
+                                     std::memory_order_relaxed)) {
+        return n;
+    }
+    return nullptr;
+}
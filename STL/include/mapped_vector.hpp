@@ -0,0 +1,481 @@
+#pragma once
+#include<iostream>
+#include <stdexcept>
+#include <string>
+#include <cstring>
+#include <cstdint>
+#include <cerrno>
+#include <type_traits>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "check_policy.hpp"
+
+// 直接映射文件的 vector：文件内容就是元素数组本身，打开即可访问，不需要逐个读取和 push_back，
+// 多个进程映射同一个文件时共享页缓存。
+// 文件布局：64 字节文件头 + capacity 个元素（文件头之后的数据区 64 字节对齐）。
+// 访问权限由元素类型决定：
+//     mapped_vector<const record> v(path);               //只读：PROT_READ 映射，所有访问都是 const，没有修改操作
+//     mapped_vector<record> w(path);                     //读写（默认 read_write，文件不存在时创建）
+// mapped_vector<const T> 只能以 read_only 打开，mapped_vector<T> 只能以 read_write / truncate 打开，
+// 模式不符时 open 抛出 logic_error。读写模式下可以修改元素、追加（ftruncate + 重新映射扩容），
+// 并通过 sync() 写回校验和、用 msync 落盘。
+// push_back / pop_back / resize / reserve 会记下“有修改”，关闭时重新计算校验和；
+// 通过 operator[]、at()、data()、begin() 拿到的引用或指针写入不会被记下（只读扫描不必在关闭时重算整个文件），
+// 这样写入之后要调用 sync()，或者调用 mark_dirty() 让关闭时重算，否则文件头里的校验和会过期。
+// 元素必须是可平凡拷贝的固定布局类型。
+
+struct mapped_vector_header
+{
+    uint64_t magic;          //固定为 MAGIC
+    uint32_t version;
+    uint32_t flags;          //CHECKSUM_VALID：checksum 与数据一致
+    uint64_t element_size;
+    uint64_t count;          //元素个数
+    uint64_t capacity;       //数据区可容纳的元素个数
+    uint64_t checksum;       //数据区前 count 个元素的校验和
+    uint64_t reserved[2];
+
+    static const uint64_t MAGIC = 0x314345564d4c5453ull;   //"STLMVEC1"
+    static const uint32_t VERSION = 1;
+    static const uint32_t CHECKSUM_VALID = 1u;
+};
+
+static_assert(sizeof(mapped_vector_header) == 64, "mapped_vector_header 应为 64 字节");
+
+//按 8 字节分组的 FNV-1a 变体，足够快，能发现截断和随机损坏
+inline uint64_t mapped_vector_checksum(const void* data, size_t bytes)
+{
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    uint64_t h = 14695981039346656037ull;
+    const uint64_t prime = 1099511628211ull;
+    size_t i = 0;
+    for (; i + 8 <= bytes; i += 8) {
+        uint64_t word;
+        std::memcpy(&word, p + i, 8);
+        h = (h ^ word) * prime;
+    }
+    for (; i < bytes; ++i) {
+        h = (h ^ p[i]) * prime;
+    }
+    return h ^ bytes;
+}
+
+template <class T>
+class mapped_vector
+{
+public:
+    typedef typename std::remove_const<T>::type value_type;
+
+    enum open_mode
+    {
+        read_only,    //只读打开已有文件（只用于 mapped_vector<const T>）
+        read_write,   //读写打开，文件不存在时创建
+        truncate      //读写打开并清空（创建新文件）
+    };
+
+    //T 带 const 时是只读视图
+    static const bool READ_ONLY = std::is_const<T>::value;
+
+private:
+    static_assert(std::is_trivially_copyable<value_type>::value, "mapped_vector: 元素必须可平凡拷贝");
+
+    static constexpr open_mode default_mode() { return READ_ONLY ? read_only : read_write; }
+
+private:
+
+    int m_fd = -1;
+    void* m_base = nullptr;       //整个文件的映射
+    size_t m_mapped_bytes = 0;
+    open_mode m_mode = read_only;
+    bool m_dirty = false;         //上次 sync() 之后有过修改（mutator 或 mark_dirty() 设置）
+    std::string m_path;
+
+public:
+
+    //构造
+    mapped_vector() = default;
+    explicit mapped_vector(const std::string& path, open_mode mode = default_mode(), bool verify = false);
+    mapped_vector(const mapped_vector&) = delete;
+    mapped_vector& operator=(const mapped_vector&) = delete;
+    mapped_vector(mapped_vector&& other) noexcept;
+    mapped_vector& operator=(mapped_vector&& other) noexcept;
+
+    //析构：读写模式下有修改时重新计算校验和（不 msync，需要落盘时先调用 sync()）
+    ~mapped_vector();
+
+    void open(const std::string& path, open_mode mode = default_mode(), bool verify = false);
+    void close();
+    bool is_open() const { return m_base != nullptr; }
+    bool writable() const { return m_mode != read_only; }
+
+    //大小
+    bool empty() const { return size() == 0; }
+    size_t size() const { return is_open() ? header()->count : 0; }
+    size_t capacity() const { return is_open() ? header()->capacity : 0; }
+
+    //数据存取（mapped_vector<const T> 的非 const 版本同样返回 const 引用 / 指针）
+    const value_type& operator[](size_t index) const {
+        STL_ACCESS_CHECK(index < size(), "mapped_vector::operator[]: index out of range");
+        return data()[index];
+    }
+    T& operator[](size_t index) {
+        STL_ACCESS_CHECK(index < size(), "mapped_vector::operator[]: index out of range");
+        return data()[index];
+    }
+    const value_type& at(size_t index) const;
+    T& at(size_t index);
+    const value_type& front() const { return at(0); }
+    const value_type& back() const { return at(size() - 1); }
+
+    const value_type* data() const { return reinterpret_cast<const value_type*>(static_cast<const char*>(m_base) + sizeof(mapped_vector_header)); }
+    T* data() { return reinterpret_cast<T*>(static_cast<char*>(m_base) + sizeof(mapped_vector_header)); }
+
+    // 迭代器
+    const value_type* begin() const { return data(); }
+    const value_type* end() const { return data() + size(); }
+    T* begin() { return data(); }
+    T* end() { return data() + size(); }
+
+    //修改（只有 mapped_vector<T> 提供，用在 mapped_vector<const T> 上编译报错）
+    void push_back(const value_type& val);
+    void pop_back();
+    void resize(size_t n);
+    void reserve(size_t n);
+    void clear() { resize(0); }
+    //通过引用或指针直接写入元素之后调用，关闭时重新计算校验和
+    void mark_dirty();
+
+    //重新计算校验和并 msync 落盘；async 为 true 时只发起写回
+    void sync(bool async = false);
+    //检查校验和；文件头中的校验和被标记为无效时返回 false
+    bool verify() const;
+
+private:
+    const mapped_vector_header* header() const { return static_cast<const mapped_vector_header*>(m_base); }
+    mapped_vector_header* header() { return static_cast<mapped_vector_header*>(m_base); }
+
+    static size_t file_bytes(size_t capacity) { return sizeof(mapped_vector_header) + capacity * sizeof(T); }
+    void check_writable(const char* what) const;
+    void update_checksum();
+    void map_file(size_t bytes);
+    void remap(size_t new_bytes);
+    [[noreturn]] void fail(const std::string& what, int err = 0);
+    void reset();
+};
+template <class T>
+const bool mapped_vector<T>::READ_ONLY;
+
+
+//构造
+template <class T>
+mapped_vector<T>::mapped_vector(const std::string& path, open_mode mode, bool verify_data)
+{
+    open(path, mode, verify_data);
+}
+
+template <class T>
+mapped_vector<T>::mapped_vector(mapped_vector&& other) noexcept
+{
+    *this = std::move(other);
+}
+
+template <class T>
+mapped_vector<T>& mapped_vector<T>::operator=(mapped_vector&& other) noexcept
+{
+    if (this != &other) {
+        close();
+        m_fd = other.m_fd;
+        m_base = other.m_base;
+        m_mapped_bytes = other.m_mapped_bytes;
+        m_mode = other.m_mode;
+        m_dirty = other.m_dirty;
+        m_path = std::move(other.m_path);
+        other.reset();
+    }
+    return *this;
+}
+
+//析构
+template <class T>
+mapped_vector<T>::~mapped_vector()
+{
+    close();
+}
+
+//打开文件并映射
+template <class T>
+void mapped_vector<T>::open(const std::string& path, open_mode mode, bool verify_data)
+{
+    if (READ_ONLY && mode != read_only) {
+        throw std::logic_error("mapped_vector::open: mapped_vector<const T> can only be opened read_only");
+    }
+    if (!READ_ONLY && mode == read_only) {
+        throw std::logic_error("mapped_vector::open: open read-only files as mapped_vector<const T>");
+    }
+    close();
+    m_path = path;
+    m_mode = mode;
+
+    int flags = (mode == read_only) ? O_RDONLY : O_RDWR | O_CREAT;
+    if (mode == truncate) {
+        flags |= O_TRUNC;
+    }
+    m_fd = ::open(path.c_str(), flags, 0644);
+    if (m_fd < 0) {
+        fail("mapped_vector::open: cannot open file", errno);
+    }
+
+    struct stat st;
+    if (fstat(m_fd, &st) != 0) {
+        fail("mapped_vector::open: fstat failed", errno);
+    }
+    size_t bytes = static_cast<size_t>(st.st_size);
+
+    //新文件：写入空的文件头
+    if (bytes == 0 && mode != read_only) {
+        bytes = file_bytes(0);
+        if (ftruncate(m_fd, static_cast<off_t>(bytes)) != 0) {
+            fail("mapped_vector::open: ftruncate failed", errno);
+        }
+        map_file(bytes);
+        mapped_vector_header* h = header();
+        h->magic = mapped_vector_header::MAGIC;
+        h->version = mapped_vector_header::VERSION;
+        h->flags = mapped_vector_header::CHECKSUM_VALID;
+        h->element_size = sizeof(T);
+        h->count = 0;
+        h->capacity = 0;
+        h->checksum = mapped_vector_checksum(nullptr, 0);
+        return;
+    }
+
+    if (bytes < sizeof(mapped_vector_header)) {
+        fail("mapped_vector::open: file too small for header");
+    }
+    map_file(bytes);
+    const mapped_vector_header* h = header();
+    if (h->magic != mapped_vector_header::MAGIC || h->version != mapped_vector_header::VERSION) {
+        fail("mapped_vector::open: not a mapped_vector file");
+    }
+    if (h->element_size != sizeof(T)) {
+        fail("mapped_vector::open: element size mismatch");
+    }
+    if (h->count > h->capacity || file_bytes(h->capacity) > bytes) {
+        fail("mapped_vector::open: file is truncated");
+    }
+    if (verify_data && !verify()) {
+        fail("mapped_vector::open: checksum mismatch");
+    }
+}
+
+//关闭
+template <class T>
+void mapped_vector<T>::close()
+{
+    if (m_base) {
+        if (writable() && m_dirty) {
+            update_checksum();
+        }
+        munmap(m_base, m_mapped_bytes);
+    }
+    if (m_fd >= 0) {
+        ::close(m_fd);
+    }
+    reset();
+}
+
+//at()
+template <class T>
+const typename mapped_vector<T>::value_type& mapped_vector<T>::at(size_t index) const
+{
+    if (index >= size()) {
+        throw std::out_of_range("mapped_vector::at: index out of range");
+    }
+    return data()[index];
+}
+
+template <class T>
+T& mapped_vector<T>::at(size_t index)
+{
+    if (index >= size()) {
+        throw std::out_of_range("mapped_vector::at: index out of range");
+    }
+    return data()[index];
+}
+
+//尾插
+template <class T>
+void mapped_vector<T>::push_back(const value_type& val)
+{
+    static_assert(!READ_ONLY, "mapped_vector::push_back: mapped_vector<const T> is read-only");
+    check_writable("mapped_vector::push_back: opened read-only");
+    size_t n = size();
+    if (n == capacity()) {
+        //val 可能位于映射内，重新映射前先拷贝
+        T copy(val);
+        reserve(n == 0 ? 64 : n * 2);
+        data()[n] = copy;
+    } else {
+        data()[n] = val;
+    }
+    header()->count = n + 1;
+    m_dirty = true;
+}
+
+template <class T>
+void mapped_vector<T>::pop_back()
+{
+    static_assert(!READ_ONLY, "mapped_vector::pop_back: mapped_vector<const T> is read-only");
+    check_writable("mapped_vector::pop_back: opened read-only");
+    if (size() == 0) {
+        return;
+    }
+    header()->count -= 1;
+    m_dirty = true;
+}
+
+//重新设置大小，新元素清零
+template <class T>
+void mapped_vector<T>::resize(size_t n)
+{
+    static_assert(!READ_ONLY, "mapped_vector::resize: mapped_vector<const T> is read-only");
+    check_writable("mapped_vector::resize: opened read-only");
+    size_t old = size();
+    if (n > capacity()) {
+        reserve(n);
+    }
+    if (n > old) {
+        std::memset(static_cast<void*>(data() + old), 0, (n - old) * sizeof(T));
+    }
+    header()->count = n;
+    m_dirty = true;
+}
+
+//扩大文件并重新映射
+template <class T>
+void mapped_vector<T>::reserve(size_t n)
+{
+    static_assert(!READ_ONLY, "mapped_vector::reserve: mapped_vector<const T> is read-only");
+    check_writable("mapped_vector::reserve: opened read-only");
+    if (n <= capacity()) {
+        return;
+    }
+    size_t bytes = file_bytes(n);
+    if (ftruncate(m_fd, static_cast<off_t>(bytes)) != 0) {
+        fail("mapped_vector::reserve: ftruncate failed", errno);
+    }
+    remap(bytes);
+    header()->capacity = n;
+    m_dirty = true;
+}
+
+template <class T>
+void mapped_vector<T>::mark_dirty()
+{
+    static_assert(!READ_ONLY, "mapped_vector::mark_dirty: mapped_vector<const T> is read-only");
+    check_writable("mapped_vector::mark_dirty: opened read-only");
+    m_dirty = true;
+}
+
+//写回
+template <class T>
+void mapped_vector<T>::sync(bool async)
+{
+    static_assert(!READ_ONLY, "mapped_vector::sync: mapped_vector<const T> is read-only");
+    check_writable("mapped_vector::sync: opened read-only");
+    update_checksum();
+    if (msync(m_base, m_mapped_bytes, async ? MS_ASYNC : MS_SYNC) != 0) {
+        throw std::runtime_error("mapped_vector::sync: msync failed: " + std::string(std::strerror(errno)));
+    }
+    m_dirty = false;
+}
+
+template <class T>
+bool mapped_vector<T>::verify() const
+{
+    if (!is_open()) {
+        return false;
+    }
+    const mapped_vector_header* h = header();
+    if (!(h->flags & mapped_vector_header::CHECKSUM_VALID)) {
+        return false;
+    }
+    return h->checksum == mapped_vector_checksum(data(), h->count * sizeof(T));
+}
+
+//辅助函数实现
+template <class T>
+void mapped_vector<T>::check_writable(const char* what) const
+{
+    if (!is_open() || !writable()) {
+        throw std::logic_error(what);
+    }
+}
+
+template <class T>
+void mapped_vector<T>::update_checksum()
+{
+    mapped_vector_header* h = header();
+    h->checksum = mapped_vector_checksum(data(), h->count * sizeof(T));
+    h->flags |= mapped_vector_header::CHECKSUM_VALID;
+}
+
+template <class T>
+void mapped_vector<T>::map_file(size_t bytes)
+{
+    int prot = (m_mode == read_only) ? PROT_READ : PROT_READ | PROT_WRITE;
+    void* p = mmap(nullptr, bytes, prot, MAP_SHARED, m_fd, 0);
+    if (p == MAP_FAILED) {
+        fail("mapped_vector: mmap failed", errno);
+    }
+    m_base = p;
+    m_mapped_bytes = bytes;
+}
+
+template <class T>
+void mapped_vector<T>::remap(size_t new_bytes)
+{
+#if defined(__linux__)
+    void* p = mremap(m_base, m_mapped_bytes, new_bytes, MREMAP_MAYMOVE);
+    if (p == MAP_FAILED) {
+        fail("mapped_vector: mremap failed", errno);
+    }
+    m_base = p;
+    m_mapped_bytes = new_bytes;
+#else
+    munmap(m_base, m_mapped_bytes);
+    m_base = nullptr;
+    map_file(new_bytes);
+#endif
+}
+
+//出错时释放资源并抛出异常，系统调用失败时附带 errno 描述
+template <class T>
+void mapped_vector<T>::fail(const std::string& what, int err)
+{
+    std::string message = what + " (" + m_path + ")";
+    if (err != 0) {
+        message += ": " + std::string(std::strerror(err));
+    }
+    if (m_base) {
+        munmap(m_base, m_mapped_bytes);
+    }
+    if (m_fd >= 0) {
+        ::close(m_fd);
+    }
+    reset();
+    throw std::runtime_error(message);
+}
+
+template <class T>
+void mapped_vector<T>::reset()
+{
+    m_fd = -1;
+    m_base = nullptr;
+    m_mapped_bytes = 0;
+    m_mode = read_only;
+    m_dirty = false;
+    m_path.clear();
+}
@@ -0,0 +1,138 @@
+#pragma once
+#include<iostream>
+#include <stdexcept>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <sys/mman.h>
+#include <unistd.h>
+#include "vector.hpp"
+
+// 基于匿名 mmap 的 vector 存储后端，用法：
+//     vector<double, growth_double, mmap_storage<>> v;
+// 小于 MMAP_THRESHOLD 字节的缓冲区仍然走 malloc；达到阈值后改用独立的匿名映射：
+//   - HUGE_PAGES 为 true 时映射按 2MB 对齐取整并 madvise(MADV_HUGEPAGE)，减少大数组随机访问的 TLB 缺失；
+//   - 可平凡重定位的元素扩容时用 mremap 重新映射，只改页表，不拷贝数据，也没有新旧两份同时驻留的峰值；
+//   - clear() / 缩小 resize() 时对不再使用的整页 madvise(MADV_DONTNEED)，立即把物理内存还给系统。
+// 映射是否使用 mmap 只由字节数决定，所以 allocate / deallocate 必须传入相同的字节数（vector 按容量传递）。
+template <bool HUGE_PAGES = true, size_t MMAP_THRESHOLD = size_t(1) << 20>
+struct mmap_storage
+{
+    static const size_t HUGE_PAGE_SIZE = size_t(2) << 20;
+
+    static void* allocate(size_t bytes)
+    {
+        if (bytes == 0) {
+            return nullptr;
+        }
+        if (!use_mmap(bytes)) {
+            return heap_storage::allocate(bytes);
+        }
+        return map(mapping_size(bytes));
+    }
+
+    static void* reallocate(void* p, size_t old_bytes, size_t new_bytes)
+    {
+        if (p == nullptr || old_bytes == 0) {
+            return allocate(new_bytes);
+        }
+        if (new_bytes == 0) {
+            deallocate(p, old_bytes);
+            return nullptr;
+        }
+        bool old_mapped = use_mmap(old_bytes);
+        bool new_mapped = use_mmap(new_bytes);
+        if (!old_mapped && !new_mapped) {
+            return heap_storage::reallocate(p, old_bytes, new_bytes);
+        }
+#if defined(__linux__)
+        if (old_mapped && new_mapped) {
+            size_t old_len = mapping_size(old_bytes);
+            size_t new_len = mapping_size(new_bytes);
+            if (old_len == new_len) {
+                return p;
+            }
+            void* new_p = mremap(p, old_len, new_len, MREMAP_MAYMOVE);
+            if (new_p == MAP_FAILED) {
+                throw std::bad_alloc();
+            }
+            advise(new_p, new_len);
+            return new_p;
+        }
+#endif
+        //跨越阈值（或没有 mremap 的平台）：申请新块后按字节拷贝
+        void* new_p = allocate(new_bytes);
+        std::memcpy(new_p, p, old_bytes < new_bytes ? old_bytes : new_bytes);
+        deallocate(p, old_bytes);
+        return new_p;
+    }
+
+    static void deallocate(void* p, size_t bytes)
+    {
+        if (p == nullptr) {
+            return;
+        }
+        if (!use_mmap(bytes)) {
+            heap_storage::deallocate(p, bytes);
+            return;
+        }
+        munmap(p, mapping_size(bytes));
+    }
+
+    //不利用映射尾部的富余，保证 deallocate 收到的字节数能还原出同样的映射长度
+    static size_t usable_size(void*, size_t bytes) { return bytes; }
+
+    //把 [used_bytes, bytes) 覆盖的整页还给系统，映射保留，再次写入时按需分配零页
+    static void release_unused(void* p, size_t used_bytes, size_t bytes)
+    {
+        if (p == nullptr || !use_mmap(bytes)) {
+            return;
+        }
+        size_t page = page_size();
+        size_t first = (used_bytes + page - 1) / page * page;
+        size_t last = mapping_size(bytes);
+        if (first < last) {
+            madvise(static_cast<char*>(p) + first, last - first, MADV_DONTNEED);
+        }
+    }
+
+private:
+    static bool use_mmap(size_t bytes) { return bytes >= MMAP_THRESHOLD; }
+
+    static size_t page_size()
+    {
+        static const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        return page;
+    }
+
+    static size_t mapping_size(size_t bytes)
+    {
+        size_t unit = HUGE_PAGES ? HUGE_PAGE_SIZE : page_size();
+        return (bytes + unit - 1) / unit * unit;
+    }
+
+    static void* map(size_t len)
+    {
+        void* p = mmap(nullptr, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+        advise(p, len);
+        return p;
+    }
+
+    static void advise(void* p, size_t len)
+    {
+#if defined(MADV_HUGEPAGE)
+        if (HUGE_PAGES) {
+            madvise(p, len, MADV_HUGEPAGE);
+        }
+#else
+        (void)p;
+        (void)len;
+#endif
+    }
+};
+
+template <bool HUGE_PAGES, size_t MMAP_THRESHOLD>
+const size_t mmap_storage<HUGE_PAGES, MMAP_THRESHOLD>::HUGE_PAGE_SIZE;
@@ -0,0 +1,41 @@
+#pragma once
+#include <cstddef>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <xmmintrin.h>
+#endif
+
+// 软件预取，由构建宏 STL_PREFETCH_BLOCKS 统一控制默认距离：
+//   deque 迭代器每跨进一个新块，预取前方（后退时是后方）第 STL_PREFETCH_BLOCKS 块开头的几条缓存行；
+//   deque::for_each / for_each_reverse 每处理一条缓存行的元素，就预取前方第 prefetch_blocks 块里
+//   同一位置的缓存行，距离可以逐次调用指定，默认同样是 STL_PREFETCH_BLOCKS。
+// 块是分别分配的，地址不连续，硬件预取器不会跨块（通常也不跨页）继续取数，
+// 所以第一次访问一个块时要等缓存和 TLB 缺失；提前几块发出预取可以把这段等待藏在前面块的计算里。
+// 设为 0 关闭。同一程序的所有翻译单元必须使用相同的值。
+
+#ifndef STL_PREFETCH_BLOCKS
+#define STL_PREFETCH_BLOCKS 2
+#endif
+
+//缓存行大小按 64 字节估计
+static const size_t STL_CACHE_LINE = 64;
+
+//预取 p 所在的缓存行（读，尽量留在所有缓存层级）。预取从不触发缺页或访问错误
+inline void stl_prefetch(const void* p)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_prefetch(p, 0, 3);
+#elif defined(_MSC_VER)
+    _mm_prefetch(static_cast<const char*>(p), _MM_HINT_T0);
+#else
+    (void)p;
+#endif
+}
+
+//预取 [p, p + bytes) 覆盖的所有缓存行
+inline void stl_prefetch_range(const void* p, size_t bytes)
+{
+    const char* first = static_cast<const char*>(p);
+    for (size_t offset = 0; offset < bytes; offset += STL_CACHE_LINE) {
+        stl_prefetch(first + offset);
+    }
+}
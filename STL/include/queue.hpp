@@ -1,6 +1,11 @@
 #pragma once
 #include<iostream>
 #include <stdexcept>
+#include <functional>
+#include <algorithm>
+#include <utility>
+#include "vector.hpp"
+#include "check_policy.hpp"
 
 
 
@@ -10,4 +15,418 @@ class queue
 
 
 
-};
\ No newline at end of file
+};
+
+
+// d 叉堆优先队列，底层使用本项目的 vector
+// D 为堆的分叉数，默认 4 叉：一个结点的孩子在内存中相邻，下沉时比较的孩子大多落在同一缓存行，
+// 树高也只有二叉堆的一半。Compare 语义与 std::priority_queue 相同（默认 less，堆顶为最大值）。
+template <class T, class Compare = std::less<T>, size_t D = 4>
+class priority_queue
+{
+    static_assert(D >= 2, "priority_queue: 分叉数至少为 2");
+
+private:
+
+    vector<T> m_heap;
+    Compare m_comp;
+
+public:
+
+    //构造
+    priority_queue() = default;
+    explicit priority_queue(const Compare& comp) : m_comp(comp) {}
+    template <class InputIt>
+    priority_queue(InputIt first, InputIt last, const Compare& comp = Compare());
+
+    //入队和出队
+    void push(const T& val);
+    void push(T&& val);
+    void pop();
+    const T& top() const;
+
+    //大小
+    bool empty() const { return m_heap.empty(); }
+    size_t size() const { return m_heap.size(); }
+    void reserve(size_t n) { m_heap.reserve(n); }
+    void clear() { m_heap.clear(); }
+
+    //用区间内容整体替换堆，O(n) 自底向上建堆
+    template <class InputIt>
+    void heapify(InputIt first, InputIt last);
+
+    //交换
+    void swap(priority_queue& other);
+
+private:
+    static size_t parent(size_t i) { return (i - 1) / D; }
+    static size_t first_child(size_t i) { return i * D + 1; }
+
+    void sift_up(size_t pos);
+    void sift_down(size_t pos);
+};
+
+
+//区间构造
+template <class T, class Compare, size_t D>
+template <class InputIt>
+priority_queue<T, Compare, D>::priority_queue(InputIt first, InputIt last, const Compare& comp)
+: m_comp(comp)
+{
+    heapify(first, last);
+}
+
+//入队
+template <class T, class Compare, size_t D>
+void priority_queue<T, Compare, D>::push(const T& val)
+{
+    m_heap.push_back(val);
+    sift_up(m_heap.size() - 1);
+}
+
+template <class T, class Compare, size_t D>
+void priority_queue<T, Compare, D>::push(T&& val)
+{
+    m_heap.push_back(std::move(val));
+    sift_up(m_heap.size() - 1);
+}
+
+//出队
+template <class T, class Compare, size_t D>
+void priority_queue<T, Compare, D>::pop()
+{
+    if (m_heap.empty()) {
+        throw std::out_of_range("priority_queue::pop: queue is empty");
+    }
+    size_t last = m_heap.size() - 1;
+    if (last > 0) {
+        m_heap[0] = std::move(m_heap[last]);
+    }
+    m_heap.pop_back();
+    if (!m_heap.empty()) {
+        sift_down(0);
+    }
+}
+
+template <class T, class Compare, size_t D>
+const T& priority_queue<T, Compare, D>::top() const
+{
+    STL_ACCESS_CHECK(!m_heap.empty(), "priority_queue::top: queue is empty");
+    return m_heap[0];
+}
+
+//建堆
+template <class T, class Compare, size_t D>
+template <class InputIt>
+void priority_queue<T, Compare, D>::heapify(InputIt first, InputIt last)
+{
+    m_heap.clear();
+    for (; first != last; ++first) {
+        m_heap.push_back(*first);
+    }
+    if (m_heap.size() < 2) {
+        return;
+    }
+    //从最后一个非叶结点开始依次下沉
+    for (size_t i = parent(m_heap.size() - 1) + 1; i-- > 0;) {
+        sift_down(i);
+    }
+}
+
+template <class T, class Compare, size_t D>
+void priority_queue<T, Compare, D>::swap(priority_queue& other)
+{
+    m_heap.swap(other.m_heap);
+    std::swap(m_comp, other.m_comp);
+}
+
+//上浮：用“空洞”移动代替逐层交换
+template <class T, class Compare, size_t D>
+void priority_queue<T, Compare, D>::sift_up(size_t pos)
+{
+    T val = std::move(m_heap[pos]);
+    while (pos > 0) {
+        size_t p = parent(pos);
+        if (!m_comp(m_heap[p], val)) {
+            break;
+        }
+        m_heap[pos] = std::move(m_heap[p]);
+        pos = p;
+    }
+    m_heap[pos] = std::move(val);
+}
+
+//下沉：在至多 D 个相邻孩子中选出优先级最高的一个
+template <class T, class Compare, size_t D>
+void priority_queue<T, Compare, D>::sift_down(size_t pos)
+{
+    size_t n = m_heap.size();
+    T val = std::move(m_heap[pos]);
+    while (true) {
+        size_t child = first_child(pos);
+        if (child >= n) {
+            break;
+        }
+        size_t child_end = std::min(child + D, n);
+        size_t best = child;
+        for (size_t c = child + 1; c < child_end; ++c) {
+            if (m_comp(m_heap[best], m_heap[c])) {
+                best = c;
+            }
+        }
+        if (!m_comp(val, m_heap[best])) {
+            break;
+        }
+        m_heap[pos] = std::move(m_heap[best]);
+        pos = best;
+    }
+    m_heap[pos] = std::move(val);
+}
+
+
+// 带索引的 d 叉堆：push 返回一个句柄，之后可以按句柄 O(log n) 修改优先级或删除
+// 句柄在元素被 pop / erase 后失效，并会被之后的 push 复用。
+template <class T, class Compare = std::less<T>, size_t D = 4>
+class indexed_priority_queue
+{
+    static_assert(D >= 2, "indexed_priority_queue: 分叉数至少为 2");
+
+public:
+    typedef size_t handle_type;
+    static const size_t npos = size_t(-1);
+
+private:
+
+    vector<T> m_values;           //按句柄存放的元素
+    vector<size_t> m_heap;        //堆数组，存放句柄
+    vector<size_t> m_position;    //句柄 -> 堆中位置，空闲句柄为 npos
+    vector<size_t> m_free;        //可复用的句柄
+    Compare m_comp;
+
+public:
+
+    //构造
+    indexed_priority_queue() = default;
+    explicit indexed_priority_queue(const Compare& comp) : m_comp(comp) {}
+
+    //入队和出队
+    handle_type push(const T& val);
+    void pop();
+    const T& top() const;
+    handle_type top_handle() const;
+
+    //按句柄访问、修改和删除
+    bool contains(handle_type h) const { return h < m_position.size() && m_position[h] != npos; }
+    const T& get(handle_type h) const;
+    void update(handle_type h, const T& new_priority);
+    void erase(handle_type h);
+
+    //大小
+    bool empty() const { return m_heap.empty(); }
+    size_t size() const { return m_heap.size(); }
+    void reserve(size_t n);
+    void clear();
+
+    //用区间内容整体替换堆，第 i 个元素的句柄为 i
+    template <class InputIt>
+    void heapify(InputIt first, InputIt last);
+
+private:
+    static size_t parent(size_t i) { return (i - 1) / D; }
+    static size_t first_child(size_t i) { return i * D + 1; }
+
+    void check_handle(handle_type h, const char* what) const;
+    void remove_at(size_t pos);
+    void sift_up(size_t pos);
+    void sift_down(size_t pos);
+    void place(size_t pos, size_t h) { m_heap[pos] = h; m_position[h] = pos; }
+};
+
+template <class T, class Compare, size_t D>
+const size_t indexed_priority_queue<T, Compare, D>::npos;
+
+//入队
+template <class T, class Compare, size_t D>
+typename indexed_priority_queue<T, Compare, D>::handle_type
+indexed_priority_queue<T, Compare, D>::push(const T& val)
+{
+    handle_type h;
+    if (!m_free.empty()) {
+        h = m_free.back();
+        m_free.pop_back();
+        m_values[h] = val;
+    } else {
+        h = m_values.size();
+        m_values.push_back(val);
+        m_position.push_back(npos);
+    }
+    m_heap.push_back(h);
+    m_position[h] = m_heap.size() - 1;
+    sift_up(m_heap.size() - 1);
+    return h;
+}
+
+//出队
+template <class T, class Compare, size_t D>
+void indexed_priority_queue<T, Compare, D>::pop()
+{
+    if (m_heap.empty()) {
+        throw std::out_of_range("indexed_priority_queue::pop: queue is empty");
+    }
+    remove_at(0);
+}
+
+template <class T, class Compare, size_t D>
+const T& indexed_priority_queue<T, Compare, D>::top() const
+{
+    STL_ACCESS_CHECK(!m_heap.empty(), "indexed_priority_queue::top: queue is empty");
+    return m_values[m_heap[0]];
+}
+
+template <class T, class Compare, size_t D>
+typename indexed_priority_queue<T, Compare, D>::handle_type
+indexed_priority_queue<T, Compare, D>::top_handle() const
+{
+    if (m_heap.empty()) {
+        throw std::out_of_range("indexed_priority_queue::top: queue is empty");
+    }
+    return m_heap[0];
+}
+
+//按句柄访问
+template <class T, class Compare, size_t D>
+const T& indexed_priority_queue<T, Compare, D>::get(handle_type h) const
+{
+    check_handle(h, "indexed_priority_queue::get: invalid handle");
+    return m_values[h];
+}
+
+//修改优先级：按新旧值的比较结果决定上浮还是下沉
+template <class T, class Compare, size_t D>
+void indexed_priority_queue<T, Compare, D>::update(handle_type h, const T& new_priority)
+{
+    check_handle(h, "indexed_priority_queue::update: invalid handle");
+    bool raised = m_comp(m_values[h], new_priority);
+    m_values[h] = new_priority;
+    if (raised) {
+        sift_up(m_position[h]);
+    } else {
+        sift_down(m_position[h]);
+    }
+}
+
+template <class T, class Compare, size_t D>
+void indexed_priority_queue<T, Compare, D>::erase(handle_type h)
+{
+    check_handle(h, "indexed_priority_queue::erase: invalid handle");
+    remove_at(m_position[h]);
+}
+
+template <class T, class Compare, size_t D>
+void indexed_priority_queue<T, Compare, D>::reserve(size_t n)
+{
+    m_values.reserve(n);
+    m_heap.reserve(n);
+    m_position.reserve(n);
+}
+
+template <class T, class Compare, size_t D>
+void indexed_priority_queue<T, Compare, D>::clear()
+{
+    m_values.clear();
+    m_heap.clear();
+    m_position.clear();
+    m_free.clear();
+}
+
+//建堆
+template <class T, class Compare, size_t D>
+template <class InputIt>
+void indexed_priority_queue<T, Compare, D>::heapify(InputIt first, InputIt last)
+{
+    clear();
+    for (; first != last; ++first) {
+        m_position.push_back(m_values.size());
+        m_heap.push_back(m_values.size());
+        m_values.push_back(*first);
+    }
+    if (m_heap.size() < 2) {
+        return;
+    }
+    for (size_t i = parent(m_heap.size() - 1) + 1; i-- > 0;) {
+        sift_down(i);
+    }
+}
+
+//辅助函数实现
+template <class T, class Compare, size_t D>
+void indexed_priority_queue<T, Compare, D>::check_handle(handle_type h, const char* what) const
+{
+    if (!contains(h)) {
+        throw std::out_of_range(what);
+    }
+}
+
+//删除堆中 pos 处的元素：用末尾元素补位，再视情况上浮或下沉
+template <class T, class Compare, size_t D>
+void indexed_priority_queue<T, Compare, D>::remove_at(size_t pos)
+{
+    size_t h = m_heap[pos];
+    size_t last = m_heap.size() - 1;
+    m_position[h] = npos;
+    m_free.push_back(h);
+
+    if (pos == last) {
+        m_heap.pop_back();
+        return;
+    }
+    size_t moved = m_heap[last];
+    m_heap.pop_back();
+    place(pos, moved);
+    if (pos > 0 && m_comp(m_values[m_heap[parent(pos)]], m_values[moved])) {
+        sift_up(pos);
+    } else {
+        sift_down(pos);
+    }
+}
+
+template <class T, class Compare, size_t D>
+void indexed_priority_queue<T, Compare, D>::sift_up(size_t pos)
+{
+    size_t h = m_heap[pos];
+    while (pos > 0) {
+        size_t p = parent(pos);
+        if (!m_comp(m_values[m_heap[p]], m_values[h])) {
+            break;
+        }
+        place(pos, m_heap[p]);
+        pos = p;
+    }
+    place(pos, h);
+}
+
+template <class T, class Compare, size_t D>
+void indexed_priority_queue<T, Compare, D>::sift_down(size_t pos)
+{
+    size_t n = m_heap.size();
+    size_t h = m_heap[pos];
+    while (true) {
+        size_t child = first_child(pos);
+        if (child >= n) {
+            break;
+        }
+        size_t child_end = std::min(child + D, n);
+        size_t best = child;
+        for (size_t c = child + 1; c < child_end; ++c) {
+            if (m_comp(m_values[m_heap[best]], m_values[m_heap[c]])) {
+                best = c;
+            }
+        }
+        if (!m_comp(m_values[h], m_values[m_heap[best]])) {
+            break;
+        }
+        place(pos, m_heap[best]);
+        pos = best;
+    }
+    place(pos, h);
+}
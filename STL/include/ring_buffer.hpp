@@ -0,0 +1,522 @@
+#pragma once
+#include<iostream>
+#include <stdexcept>
+#include <algorithm>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "check_policy.hpp"
+
+// 固定容量的环形缓冲区：满了以后 push_back 覆盖最早的元素，适合遥测环、最近事件历史。
+// 构造之后不再分配内存，下标用 2 的幂容量做掩码换算；支持下标访问、随机访问迭代器，
+// 以及 spans() 一次拿到按时间顺序排列的两段连续内存，用于批量读取。
+//     ring_buffer<event, 1024> recent;        //容量在编译期确定，元素存放在对象内部
+//     ring_buffer<event> history(100000);     //N 为 0：容量在运行时确定，构造时分配一次，向上取整到 2 的幂
+//     recent.push_back(e);                    //满了就挤掉最早的一个
+//     auto s = recent.spans();                //[s.first, s.first + s.first_size) 之后接 [s.second, ...)
+// 逻辑下标 0 是最早的元素。运行时容量版本默认构造或被移走后容量为 0，写入会抛出 length_error，
+// 重新赋值后才能使用。
+
+//两段连续内存，按时间顺序先 first 后 second；second_size 为 0 时只有一段
+template <class Elem>
+struct ring_spans
+{
+    Elem* first;
+    size_t first_size;
+    Elem* second;
+    size_t second_size;
+};
+
+//存储层：N > 0 时元素在对象内部，N 为 0 时在堆上
+template <class T, size_t N>
+class ring_buffer_storage
+{
+    static_assert((N & (N - 1)) == 0, "ring_buffer: 容量必须是 2 的幂");
+
+protected:
+    alignas(T) unsigned char m_buffer[N * sizeof(T)];
+
+    ring_buffer_storage() = default;
+    explicit ring_buffer_storage(size_t) {}
+
+    T* storage() { return reinterpret_cast<T*>(m_buffer); }
+    const T* storage() const { return reinterpret_cast<const T*>(m_buffer); }
+    static constexpr size_t storage_capacity() { return N; }
+};
+
+template <class T>
+class ring_buffer_storage<T, 0>
+{
+protected:
+    T* m_data = nullptr;
+    size_t m_capacity = 0;
+
+    ring_buffer_storage() = default;
+    //capacity 为 0 时不分配
+    explicit ring_buffer_storage(size_t capacity) {
+        if (capacity == 0) {
+            return;
+        }
+        if (capacity > (size_t(-1) >> 1) / sizeof(T)) {
+            throw std::length_error("ring_buffer: capacity too large");
+        }
+        size_t rounded = 1;
+        while (rounded < capacity) {
+            rounded <<= 1;
+        }
+        m_data = std::allocator<T>().allocate(rounded);
+        m_capacity = rounded;
+    }
+    ~ring_buffer_storage() {
+        if (m_data != nullptr) {
+            std::allocator<T>().deallocate(m_data, m_capacity);
+        }
+    }
+    ring_buffer_storage(const ring_buffer_storage&) = delete;
+    ring_buffer_storage& operator=(const ring_buffer_storage&) = delete;
+
+    T* storage() { return m_data; }
+    const T* storage() const { return m_data; }
+    size_t storage_capacity() const { return m_capacity; }
+
+    void swap_storage(ring_buffer_storage& other) noexcept {
+        std::swap(m_data, other.m_data);
+        std::swap(m_capacity, other.m_capacity);
+    }
+};
+
+
+template <class T, size_t N = 0>
+class ring_buffer : private ring_buffer_storage<T, N>
+{
+private:
+    typedef ring_buffer_storage<T, N> base;
+    using base::storage;
+    using base::storage_capacity;
+
+    size_t m_head = 0;    //最早元素所在的槽位
+    size_t m_size = 0;
+
+    template <class Elem, class Ring>
+    class basic_iterator;
+
+public:
+    typedef basic_iterator<T, ring_buffer> iterator;
+    typedef basic_iterator<const T, const ring_buffer> const_iterator;
+
+    //构造：N > 0 用默认构造，N 为 0 必须给出容量
+    ring_buffer() = default;
+    explicit ring_buffer(size_t capacity);
+    ring_buffer(const ring_buffer& other);
+    ring_buffer(ring_buffer&& other) noexcept(N == 0 || std::is_nothrow_move_constructible<T>::value);
+    ~ring_buffer() { clear(); }
+
+    ring_buffer& operator=(const ring_buffer& other);
+    ring_buffer& operator=(ring_buffer&& other) noexcept(N == 0 || std::is_nothrow_move_constructible<T>::value);
+
+    //尾部写入，满时覆盖最早的元素
+    void push_back(const T& val);
+    void push_back(T&& val);
+    template <class... Args>
+    T& emplace_back(Args&&... args);
+    //批量写入 n 个元素；n 超过容量时只保留最后 capacity() 个
+    void append(const T* src, size_t n);
+
+    //删除
+    void pop_front();
+    void pop_back();
+    //丢掉最早的 n 个元素，n 超过 size() 时抛出 out_of_range
+    void pop_front(size_t n);
+    void clear();
+
+    //容量和大小
+    bool empty() const { return m_size == 0; }
+    bool full() const { return m_size == capacity(); }
+    size_t size() const { return m_size; }
+    size_t capacity() const { return storage_capacity(); }
+
+    //数据存取，下标 0 是最早的元素
+    T& operator[](size_t index) {
+        STL_ACCESS_CHECK(index < m_size, "ring_buffer::operator[]: index out of range");
+        return storage()[slot(index)];
+    }
+    const T& operator[](size_t index) const {
+        STL_ACCESS_CHECK(index < m_size, "ring_buffer::operator[]: index out of range");
+        return storage()[slot(index)];
+    }
+    T& at(size_t index);
+    const T& at(size_t index) const;
+    T& front();
+    const T& front() const;
+    T& back();
+    const T& back() const;
+
+    //按时间顺序的两段连续内存
+    ring_spans<T> spans();
+    ring_spans<const T> spans() const;
+    //把最早的 min(n, size()) 个元素拷到 dest，返回拷贝个数
+    size_t copy_to(T* dest, size_t n) const;
+
+    //迭代器
+    iterator begin() { return iterator(this, 0); }
+    iterator end() { return iterator(this, m_size); }
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, m_size); }
+    const_iterator cbegin() const { return begin(); }
+    const_iterator cend() const { return end(); }
+
+    void swap(ring_buffer& other);
+
+private:
+    size_t mask() const { return capacity() - 1; }
+    size_t slot(size_t index) const { return (m_head + index) & mask(); }
+    //下一个写入位置；满时就是最早元素的位置
+    template <class... Args>
+    T& emplace_slot(Args&&... args);
+    //从 other 按顺序拷贝（MOVE 时移动）全部元素，调用前本对象为空
+    template <bool MOVE, class Ring>
+    void copy_from(Ring& other);
+};
+
+
+//迭代器：保存容器指针和逻辑下标，解引用时再换算槽位
+template <class T, size_t N>
+template <class Elem, class Ring>
+class ring_buffer<T, N>::basic_iterator
+{
+private:
+    Ring* m_ring;
+    size_t m_index;
+
+    friend class ring_buffer<T, N>;
+
+public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = T;
+    using difference_type = ptrdiff_t;
+    using pointer = Elem*;
+    using reference = Elem&;
+
+    basic_iterator() : m_ring(nullptr), m_index(0) {}
+    basic_iterator(Ring* ring, size_t index) : m_ring(ring), m_index(index) {}
+
+    //iterator 可以隐式转换为 const_iterator
+    template <class OtherElem, class OtherRing,
+              class = typename std::enable_if<std::is_const<Elem>::value && !std::is_const<OtherElem>::value>::type>
+    basic_iterator(const basic_iterator<OtherElem, OtherRing>& other)
+    : m_ring(other.m_ring), m_index(other.m_index) {}
+
+    reference operator*() const { return (*m_ring)[m_index]; }
+    pointer operator->() const { return &(*m_ring)[m_index]; }
+    reference operator[](difference_type n) const { return (*m_ring)[m_index + n]; }
+
+    basic_iterator& operator++() { ++m_index; return *this; }
+    basic_iterator operator++(int) { basic_iterator tmp = *this; ++m_index; return tmp; }
+    basic_iterator& operator--() { --m_index; return *this; }
+    basic_iterator operator--(int) { basic_iterator tmp = *this; --m_index; return tmp; }
+
+    basic_iterator& operator+=(difference_type n) { m_index += n; return *this; }
+    basic_iterator& operator-=(difference_type n) { m_index -= n; return *this; }
+    basic_iterator operator+(difference_type n) const { return basic_iterator(m_ring, m_index + n); }
+    basic_iterator operator-(difference_type n) const { return basic_iterator(m_ring, m_index - n); }
+    friend basic_iterator operator+(difference_type n, const basic_iterator& it) { return it + n; }
+    difference_type operator-(const basic_iterator& other) const {
+        return static_cast<difference_type>(m_index) - static_cast<difference_type>(other.m_index);
+    }
+
+    bool operator==(const basic_iterator& other) const { return m_index == other.m_index; }
+    bool operator!=(const basic_iterator& other) const { return m_index != other.m_index; }
+    bool operator<(const basic_iterator& other) const { return m_index < other.m_index; }
+    bool operator>(const basic_iterator& other) const { return m_index > other.m_index; }
+    bool operator<=(const basic_iterator& other) const { return m_index <= other.m_index; }
+    bool operator>=(const basic_iterator& other) const { return m_index >= other.m_index; }
+
+    template <class, class>
+    friend class basic_iterator;
+};
+
+
+//构造
+template <class T, size_t N>
+ring_buffer<T, N>::ring_buffer(size_t capacity)
+: base(capacity)
+{
+    static_assert(N == 0, "ring_buffer: 只有运行时容量（N 为 0）的版本接受容量参数");
+    if (capacity == 0) {
+        throw std::length_error("ring_buffer: capacity must be positive");
+    }
+}
+
+template <class T, size_t N>
+ring_buffer<T, N>::ring_buffer(const ring_buffer& other)
+: base(other.capacity())
+{
+    copy_from<false>(other);
+}
+
+template <class T, size_t N>
+ring_buffer<T, N>::ring_buffer(ring_buffer&& other) noexcept(N == 0 || std::is_nothrow_move_constructible<T>::value)
+: base()
+{
+    if constexpr (N == 0) {
+        base::swap_storage(other);
+        std::swap(m_head, other.m_head);
+        std::swap(m_size, other.m_size);
+    } else {
+        copy_from<true>(other);
+        other.clear();
+    }
+}
+
+template <class T, size_t N>
+ring_buffer<T, N>& ring_buffer<T, N>::operator=(const ring_buffer& other)
+{
+    if (this != &other) {
+        ring_buffer temp(other);
+        swap(temp);
+    }
+    return *this;
+}
+
+template <class T, size_t N>
+ring_buffer<T, N>& ring_buffer<T, N>::operator=(ring_buffer&& other) noexcept(N == 0 || std::is_nothrow_move_constructible<T>::value)
+{
+    if (this != &other) {
+        clear();
+        if constexpr (N == 0) {
+            base::swap_storage(other);
+            std::swap(m_head, other.m_head);
+            std::swap(m_size, other.m_size);
+        } else {
+            copy_from<true>(other);
+            other.clear();
+        }
+    }
+    return *this;
+}
+
+
+//写入
+template <class T, size_t N>
+template <class... Args>
+T& ring_buffer<T, N>::emplace_slot(Args&&... args)
+{
+    if (m_size < capacity()) {
+        T* p = storage() + slot(m_size);
+        new (p) T(std::forward<Args>(args)...);
+        ++m_size;
+        return *p;
+    }
+    //满：先构造好新元素再覆盖，构造抛异常时缓冲区不变
+    T* p = storage() + m_head;
+    *p = T(std::forward<Args>(args)...);
+    m_head = (m_head + 1) & mask();
+    return *p;
+}
+
+template <class T, size_t N>
+void ring_buffer<T, N>::push_back(const T& val)
+{
+    emplace_back(val);
+}
+
+template <class T, size_t N>
+void ring_buffer<T, N>::push_back(T&& val)
+{
+    emplace_back(std::move(val));
+}
+
+template <class T, size_t N>
+template <class... Args>
+T& ring_buffer<T, N>::emplace_back(Args&&... args)
+{
+    if (N == 0 && capacity() == 0) {
+        throw std::length_error("ring_buffer::emplace_back: buffer has no storage");
+    }
+    return emplace_slot(std::forward<Args>(args)...);
+}
+
+template <class T, size_t N>
+void ring_buffer<T, N>::append(const T* src, size_t n)
+{
+    if (N == 0 && capacity() == 0) {
+        throw std::length_error("ring_buffer::append: buffer has no storage");
+    }
+    if (n > capacity()) {
+        src += n - capacity();
+        n = capacity();
+    }
+    if constexpr (std::is_trivially_copyable<T>::value) {
+        //先丢掉会被挤掉的最早元素，再按槽位分两段整体拷贝
+        size_t overflow = m_size + n > capacity() ? m_size + n - capacity() : 0;
+        m_head = (m_head + overflow) & mask();
+        m_size -= overflow;
+        size_t start = slot(m_size);
+        size_t first = std::min(n, capacity() - start);
+        std::copy(src, src + first, storage() + start);
+        std::copy(src + first, src + n, storage());
+        m_size += n;
+    } else {
+        for (size_t i = 0; i < n; ++i) {
+            emplace_slot(src[i]);
+        }
+    }
+}
+
+
+//删除
+template <class T, size_t N>
+void ring_buffer<T, N>::pop_front()
+{
+    if (m_size == 0) {
+        throw std::out_of_range("ring_buffer::pop_front: ring_buffer is empty");
+    }
+    storage()[m_head].~T();
+    m_head = (m_head + 1) & mask();
+    --m_size;
+}
+
+template <class T, size_t N>
+void ring_buffer<T, N>::pop_back()
+{
+    if (m_size == 0) {
+        throw std::out_of_range("ring_buffer::pop_back: ring_buffer is empty");
+    }
+    storage()[slot(m_size - 1)].~T();
+    --m_size;
+}
+
+template <class T, size_t N>
+void ring_buffer<T, N>::pop_front(size_t n)
+{
+    if (n > m_size) {
+        throw std::out_of_range("ring_buffer::pop_front: not enough elements");
+    }
+    if constexpr (!std::is_trivially_destructible<T>::value) {
+        for (size_t i = 0; i < n; ++i) {
+            storage()[slot(i)].~T();
+        }
+    }
+    m_size -= n;
+    m_head = m_size == 0 ? 0 : (m_head + n) & mask();
+}
+
+template <class T, size_t N>
+void ring_buffer<T, N>::clear()
+{
+    pop_front(m_size);
+}
+
+
+//数据存取
+template <class T, size_t N>
+T& ring_buffer<T, N>::at(size_t index)
+{
+    if (index >= m_size) {
+        throw std::out_of_range("ring_buffer::at: index out of range");
+    }
+    return storage()[slot(index)];
+}
+
+template <class T, size_t N>
+const T& ring_buffer<T, N>::at(size_t index) const
+{
+    if (index >= m_size) {
+        throw std::out_of_range("ring_buffer::at: index out of range");
+    }
+    return storage()[slot(index)];
+}
+
+template <class T, size_t N>
+T& ring_buffer<T, N>::front()
+{
+    STL_ACCESS_CHECK(m_size > 0, "ring_buffer::front: ring_buffer is empty");
+    return storage()[m_head];
+}
+
+template <class T, size_t N>
+const T& ring_buffer<T, N>::front() const
+{
+    STL_ACCESS_CHECK(m_size > 0, "ring_buffer::front: ring_buffer is empty");
+    return storage()[m_head];
+}
+
+template <class T, size_t N>
+T& ring_buffer<T, N>::back()
+{
+    STL_ACCESS_CHECK(m_size > 0, "ring_buffer::back: ring_buffer is empty");
+    return storage()[slot(m_size - 1)];
+}
+
+template <class T, size_t N>
+const T& ring_buffer<T, N>::back() const
+{
+    STL_ACCESS_CHECK(m_size > 0, "ring_buffer::back: ring_buffer is empty");
+    return storage()[slot(m_size - 1)];
+}
+
+template <class T, size_t N>
+ring_spans<T> ring_buffer<T, N>::spans()
+{
+    size_t first = std::min(m_size, capacity() - m_head);
+    return ring_spans<T>{storage() + m_head, first, storage(), m_size - first};
+}
+
+template <class T, size_t N>
+ring_spans<const T> ring_buffer<T, N>::spans() const
+{
+    size_t first = std::min(m_size, capacity() - m_head);
+    return ring_spans<const T>{storage() + m_head, first, storage(), m_size - first};
+}
+
+template <class T, size_t N>
+size_t ring_buffer<T, N>::copy_to(T* dest, size_t n) const
+{
+    n = std::min(n, m_size);
+    ring_spans<const T> s = spans();
+    size_t first = std::min(n, s.first_size);
+    dest = std::copy(s.first, s.first + first, dest);
+    std::copy(s.second, s.second + (n - first), dest);
+    return n;
+}
+
+
+//交换：运行时容量直接交换存储；内部存储逐个交换，多出来的元素移动过去
+template <class T, size_t N>
+void ring_buffer<T, N>::swap(ring_buffer& other)
+{
+    if (this == &other) {
+        return;
+    }
+    if constexpr (N == 0) {
+        base::swap_storage(other);
+        std::swap(m_head, other.m_head);
+        std::swap(m_size, other.m_size);
+    } else {
+        ring_buffer temp(std::move(other));
+        other = std::move(*this);
+        *this = std::move(temp);
+    }
+}
+
+template <class T, size_t N>
+template <bool MOVE, class Ring>
+void ring_buffer<T, N>::copy_from(Ring& other)
+{
+    m_head = 0;
+    try {
+        for (size_t i = 0; i < other.m_size; ++i) {
+            if constexpr (MOVE) {
+                new (storage() + i) T(std::move_if_noexcept(other[i]));
+            } else {
+                new (storage() + i) T(other[i]);
+            }
+            ++m_size;
+        }
+    } catch (...) {
+        clear();
+        throw;
+    }
+}
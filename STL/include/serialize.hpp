@@ -0,0 +1,385 @@
+#pragma once
+#include<iostream>
+#include <stdexcept>
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include "vector.hpp"
+#include "deque.hpp"
+
+// vector / deque 的流式二进制序列化。写出要求元素可平凡拷贝，读入还要求可平凡默认构造（直接读进未初始化的存储）。
+// 格式：64 字节文件头（魔数、版本、标志、元素大小、元素个数、校验和）+ count 个元素的原始字节。
+// vector 和 deque 写出的格式相同，可以互相读取。
+//   写：元素内存直接作为 iovec 交给 writev（vector 一段，deque 每块一段），不经过中间缓冲区；
+//   读：先检查文件头，再用 append_with 把数据 read 进容器自己的存储（deque 逐块），
+//       从普通文件读取且长度足够时先按 count 预留好空间，否则按块增长，内存只随实际读到的数据增加；
+//       读完整个结果才替换目标容器，任何错误（截断、元素大小不符、校验和不一致）抛异常，目标容器不变。
+//     serialize(fd, events);                 //写到已打开的文件描述符（文件、管道、套接字）
+//     deserialize(fd, events);
+//     save_file("state.bin", events);        //先写临时文件、fsync，再 rename 覆盖，不会留下半个检查点
+//     load_file("state.bin", events);
+// 校验和与 mapped_vector 相同（按 8 字节分组的 FNV-1a 变体），写出时多读一遍内存；
+// 不需要时用 serialize_options 关掉。多字节字段按本机字节序写，只能在字节序相同的机器之间交换。
+
+struct serial_header
+{
+    uint64_t magic;          //固定为 MAGIC
+    uint32_t version;
+    uint32_t flags;          //HAS_CHECKSUM：checksum 有效
+    uint64_t element_size;
+    uint64_t count;          //元素个数
+    uint64_t checksum;       //全部元素字节的校验和
+    uint64_t reserved[3];
+
+    static const uint64_t MAGIC = 0x31305245534c5453ull;   //"STLSER01"
+    static const uint32_t VERSION = 1;
+    static const uint32_t HAS_CHECKSUM = 1u;
+};
+
+static_assert(sizeof(serial_header) == 64, "serial_header 应为 64 字节");
+
+struct serialize_options
+{
+    bool checksum = true;
+};
+
+//流式校验和：数据可以分成任意多段喂进来，结果与对整段调用 mapped_vector_checksum 相同
+class serial_checksum
+{
+private:
+    uint64_t m_hash = 14695981039346656037ull;
+    uint64_t m_bytes = 0;
+    unsigned char m_pending[8];
+    size_t m_pending_size = 0;
+
+    static const uint64_t PRIME = 1099511628211ull;
+
+public:
+    void update(const void* data, size_t bytes);
+    uint64_t value() const;
+};
+
+inline void serial_checksum::update(const void* data, size_t bytes)
+{
+    //空容器的 data() 可能是空指针，不能交给 memcpy
+    if (bytes == 0) {
+        return;
+    }
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    m_bytes += bytes;
+    //先把上一段剩下的不足 8 字节补齐
+    if (m_pending_size > 0) {
+        size_t take = std::min(bytes, sizeof(m_pending) - m_pending_size);
+        std::memcpy(m_pending + m_pending_size, p, take);
+        m_pending_size += take;
+        p += take;
+        bytes -= take;
+        if (m_pending_size < sizeof(m_pending)) {
+            return;
+        }
+        uint64_t word;
+        std::memcpy(&word, m_pending, 8);
+        m_hash = (m_hash ^ word) * PRIME;
+        m_pending_size = 0;
+    }
+    uint64_t h = m_hash;
+    for (; bytes >= 8; p += 8, bytes -= 8) {
+        uint64_t word;
+        std::memcpy(&word, p, 8);
+        h = (h ^ word) * PRIME;
+    }
+    m_hash = h;
+    std::memcpy(m_pending + m_pending_size, p, bytes);
+    m_pending_size += bytes;
+}
+
+inline uint64_t serial_checksum::value() const
+{
+    uint64_t h = m_hash;
+    for (size_t i = 0; i < m_pending_size; ++i) {
+        h = (h ^ m_pending[i]) * PRIME;
+    }
+    return h ^ m_bytes;
+}
+
+
+namespace serial_detail
+{
+
+inline void fail(const std::string& what, int err)
+{
+    throw std::runtime_error(what + ": " + std::string(std::strerror(err)));
+}
+
+//把一组 iovec 全部写完，处理部分写入和 EINTR
+class gather_writer
+{
+private:
+    static const size_t MAX_IOV = 512;
+
+    int m_fd;
+    iovec m_iov[MAX_IOV];
+    size_t m_count = 0;
+
+public:
+    explicit gather_writer(int fd) : m_fd(fd) {}
+
+    void add(const void* data, size_t bytes)
+    {
+        if (bytes == 0) {
+            return;
+        }
+        if (m_count == MAX_IOV) {
+            flush();
+        }
+        m_iov[m_count].iov_base = const_cast<void*>(data);
+        m_iov[m_count].iov_len = bytes;
+        ++m_count;
+    }
+
+    void flush()
+    {
+        iovec* iov = m_iov;
+        size_t count = m_count;
+        while (count > 0) {
+            ssize_t n = writev(m_fd, iov, static_cast<int>(std::min<size_t>(count, IOV_MAX)));
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                fail("serialize: write failed", errno);
+            }
+            size_t written = static_cast<size_t>(n);
+            while (count > 0 && written >= iov->iov_len) {
+                written -= iov->iov_len;
+                ++iov;
+                --count;
+            }
+            if (count > 0) {
+                iov->iov_base = static_cast<char*>(iov->iov_base) + written;
+                iov->iov_len -= written;
+            }
+        }
+        m_count = 0;
+    }
+};
+
+//读满 bytes 字节，遇到文件结尾提前返回，返回实际读到的字节数
+inline size_t read_full(int fd, void* buffer, size_t bytes)
+{
+    char* p = static_cast<char*>(buffer);
+    size_t done = 0;
+    while (done < bytes) {
+        ssize_t n = ::read(fd, p + done, std::min<size_t>(bytes - done, SSIZE_MAX));
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            fail("deserialize: read failed", errno);
+        }
+        if (n == 0) {
+            break;
+        }
+        done += static_cast<size_t>(n);
+    }
+    return done;
+}
+
+//Segments：for_each(f) 按顺序给出 f(const T* first, size_t len)
+template <class T, class Segments>
+void write_container(int fd, size_t count, Segments segments, const serialize_options& options)
+{
+    serial_header header = serial_header();
+    header.magic = serial_header::MAGIC;
+    header.version = serial_header::VERSION;
+    header.element_size = sizeof(T);
+    header.count = count;
+    if (options.checksum) {
+        serial_checksum sum;
+        segments([&sum](const T* first, size_t len) { sum.update(first, len * sizeof(T)); });
+        header.flags |= serial_header::HAS_CHECKSUM;
+        header.checksum = sum.value();
+    }
+    gather_writer out(fd);
+    out.add(&header, sizeof(header));
+    segments([&out](const T* first, size_t len) { out.add(first, len * sizeof(T)); });
+    out.flush();
+}
+
+//读取并检查文件头；preallocate 返回 fd 是普通文件且剩余长度足够，可以按 count 预留
+template <class T>
+serial_header read_header(int fd, bool& preallocate)
+{
+    serial_header header;
+    if (read_full(fd, &header, sizeof(header)) != sizeof(header)) {
+        throw std::runtime_error("deserialize: truncated header");
+    }
+    if (header.magic != serial_header::MAGIC) {
+        throw std::runtime_error("deserialize: not a serialized container (or different byte order)");
+    }
+    if (header.version > serial_header::VERSION) {
+        throw std::runtime_error("deserialize: written by a newer format version");
+    }
+    if (header.element_size != sizeof(T)) {
+        throw std::runtime_error("deserialize: element size mismatch");
+    }
+    if (header.count > size_t(-1) / sizeof(T)) {
+        throw std::runtime_error("deserialize: element count too large");
+    }
+    preallocate = false;
+    struct stat st;
+    off_t pos = lseek(fd, 0, SEEK_CUR);
+    if (pos >= 0 && fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) {
+        if (static_cast<uint64_t>(st.st_size - pos) < header.count * sizeof(T)) {
+            throw std::runtime_error("deserialize: file is shorter than its header says");
+        }
+        preallocate = true;
+    }
+    return header;
+}
+
+//把 count 个元素读进 c（vector 或 deque，必须为空）；不能预留时每次最多追加 CHUNK 字节
+template <class T, class C>
+void read_elements(int fd, C& c, const serial_header& header, bool preallocate)
+{
+    const size_t CHUNK = std::max<size_t>(1, (size_t(16) << 20) / sizeof(T));
+    size_t count = static_cast<size_t>(header.count);
+    bool verify = (header.flags & serial_header::HAS_CHECKSUM) != 0;
+    serial_checksum sum;
+    auto fill = [fd, verify, &sum](T* dst, size_t n) {
+        size_t got = read_full(fd, dst, n * sizeof(T));
+        if (verify) {
+            sum.update(dst, got);
+        }
+        return got / sizeof(T);
+    };
+    size_t step = preallocate ? count : CHUNK;
+    while (c.size() < count) {
+        size_t want = std::min(step, count - c.size());
+        if (c.append_with(want, fill) != want) {
+            throw std::runtime_error("deserialize: truncated data");
+        }
+    }
+    if (verify && sum.value() != header.checksum) {
+        throw std::runtime_error("deserialize: checksum mismatch");
+    }
+}
+
+//save_file / load_file 共用：打开文件，出错抛异常，作用域结束时关闭
+class scoped_fd
+{
+private:
+    int m_fd;
+
+public:
+    scoped_fd(const std::string& path, int flags, mode_t mode = 0644)
+    : m_fd(::open(path.c_str(), flags | O_CLOEXEC, mode))
+    {
+        if (m_fd < 0) {
+            fail("cannot open " + path, errno);
+        }
+    }
+    ~scoped_fd() {
+        if (m_fd >= 0) {
+            ::close(m_fd);
+        }
+    }
+    scoped_fd(const scoped_fd&) = delete;
+    scoped_fd& operator=(const scoped_fd&) = delete;
+
+    int get() const { return m_fd; }
+    //显式关闭，报告延迟写入的错误
+    void close()
+    {
+        if (m_fd >= 0) {
+            int fd = m_fd;
+            m_fd = -1;
+            if (::close(fd) != 0) {
+                fail("close failed", errno);
+            }
+        }
+    }
+};
+
+}   // namespace serial_detail
+
+
+//写出
+template <class T, class GrowthPolicy, class Storage>
+void serialize(int fd, const vector<T, GrowthPolicy, Storage>& v,
+               const serialize_options& options = serialize_options())
+{
+    static_assert(std::is_trivially_copyable<T>::value, "serialize: 元素必须可平凡拷贝");
+    serial_detail::write_container<T>(fd, v.size(), [&v](auto f) { f(v.data(), v.size()); }, options);
+}
+
+template <class T, class ReleasePolicy>
+void serialize(int fd, const deque<T, ReleasePolicy>& d,
+               const serialize_options& options = serialize_options())
+{
+    static_assert(std::is_trivially_copyable<T>::value, "serialize: 元素必须可平凡拷贝");
+    serial_detail::write_container<T>(fd, d.size(), [&d](auto f) { d.for_each_segment(f); }, options);
+}
+
+//读入：成功后替换 c 的内容
+template <class T, class GrowthPolicy, class Storage>
+void deserialize(int fd, vector<T, GrowthPolicy, Storage>& v)
+{
+    static_assert(std::is_trivially_copyable<T>::value, "deserialize: 元素必须可平凡拷贝");
+    bool preallocate;
+    serial_header header = serial_detail::read_header<T>(fd, preallocate);
+    vector<T, GrowthPolicy, Storage> result;
+    if (preallocate) {
+        result.reserve(static_cast<size_t>(header.count));
+    }
+    serial_detail::read_elements<T>(fd, result, header, preallocate);
+    v.swap(result);
+}
+
+template <class T, class ReleasePolicy>
+void deserialize(int fd, deque<T, ReleasePolicy>& d)
+{
+    static_assert(std::is_trivially_copyable<T>::value, "deserialize: 元素必须可平凡拷贝");
+    bool preallocate;
+    serial_header header = serial_detail::read_header<T>(fd, preallocate);
+    deque<T, ReleasePolicy> result;
+    serial_detail::read_elements<T>(fd, result, header, preallocate);
+    d.swap(result);
+}
+
+//按路径保存：写到 path.tmp，fsync 后 rename 到 path
+template <class C>
+void save_file(const std::string& path, const C& c, const serialize_options& options = serialize_options())
+{
+    std::string tmp = path + ".tmp";
+    try {
+        serial_detail::scoped_fd file(tmp, O_WRONLY | O_CREAT | O_TRUNC);
+        serialize(file.get(), c, options);
+        if (fsync(file.get()) != 0) {
+            serial_detail::fail("save_file: fsync failed", errno);
+        }
+        file.close();
+        if (std::rename(tmp.c_str(), path.c_str()) != 0) {
+            serial_detail::fail("save_file: cannot rename " + tmp, errno);
+        }
+    } catch (...) {
+        ::unlink(tmp.c_str());
+        throw;
+    }
+}
+
+template <class C>
+void load_file(const std::string& path, C& c)
+{
+    serial_detail::scoped_fd file(path, O_RDONLY);
+    deserialize(file.get(), c);
+}
@@ -0,0 +1,444 @@
+#pragma once
+#include<iostream>
+#include <stdexcept>
+#include <initializer_list>
+#include <type_traits>
+#include <utility>
+#include "check_policy.hpp"
+#include <algorithm>
+#include <cstring>
+
+// 小缓冲优化的 vector：前 N 个元素存放在对象内部的缓冲区，超过 N 个才转到堆上。
+// 接口与 vector 保持一致。
+// 迭代器规则：内联模式下，移动构造 / 移动赋值 / swap 会逐个搬移元素，原对象的迭代器全部失效；
+// 堆模式下直接转移指针，原迭代器继续指向（现已属于目标对象的）同一元素。
+template <class T, size_t N = 8>
+class small_vector
+{
+    static_assert(N > 0, "small_vector: 内联容量至少为 1");
+
+private:
+
+    T* m_data;              //指向内联缓冲区或堆内存
+    size_t m_size = 0;
+    size_t m_capacity = N;
+    alignas(T) unsigned char m_buffer[N * sizeof(T)];   //内联缓冲区
+
+public:
+
+    //构造
+    small_vector() : m_data(inline_data()) {}
+    small_vector(size_t n, const T& val);   //（数量，数据）
+    small_vector(std::initializer_list<T> init);
+
+    //拷贝构造和移动构造
+    small_vector(const small_vector& other);
+    small_vector(small_vector&& other) noexcept(std::is_nothrow_move_constructible<T>::value);
+
+    //析构函数
+    ~small_vector();
+
+    //赋值
+    small_vector& operator=(const small_vector& other);
+    small_vector& operator=(small_vector&& other) noexcept(std::is_nothrow_move_constructible<T>::value);
+
+    //尾插和尾删
+    void push_back(const T& val);
+    void push_back(T&& val);
+    void pop_back();
+
+    //容量和大小
+    bool empty() const { return m_size == 0; }
+    size_t capacity() const { return m_capacity; }
+    size_t size() const { return m_size; }
+    bool is_inline() const { return m_data == inline_data(); }
+    void resize(size_t size);
+
+    //插入和删除
+    void insert(T* insert_begin_ptr, const T& val);
+    T* erase(T* erase_ptr);
+    T* erase(T* erase_begin_ptr, T* erase_end_ptr);
+    void clear();
+
+    //数据存取
+    const T& operator[](size_t index) const {
+        STL_ACCESS_CHECK(index < m_size, "small_vector::operator[]: index out of range");
+        return m_data[index];
+    }
+    T& operator[](size_t index) {
+        STL_ACCESS_CHECK(index < m_size, "small_vector::operator[]: index out of range");
+        return m_data[index];
+    }
+    const T& at(size_t index) const;
+    T& at(size_t index);
+
+    const T& front() const;
+    const T& back() const;
+    T& front();
+    T& back();
+
+    //互换容器
+    void swap(small_vector& other);
+
+    //预留空间
+    void reserve(size_t size);
+
+    // 迭代器
+    T* begin() { return m_data; }
+    const T* begin() const { return m_data; }
+    T* end() { return m_data + m_size; }
+    const T* end() const { return m_data + m_size; }
+
+private:
+    T* inline_data() { return reinterpret_cast<T*>(m_buffer); }
+    const T* inline_data() const { return reinterpret_cast<const T*>(m_buffer); }
+
+    //把 n 个元素从 src 搬到未初始化的 dst，并析构 src
+    static void relocate(T* dst, T* src, size_t n);
+    //释放当前堆内存（内联模式下什么也不做）
+    void release_storage();
+    //接管 other 的内容，other 变为空的内联状态
+    void steal(small_vector& other);
+    size_t grow_capacity() const { return m_capacity * 2; }
+};
+
+
+//构造
+template <class T, size_t N>
+small_vector<T, N>::small_vector(size_t n, const T& val)
+: m_data(inline_data())
+{
+    reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        new (m_data + i) T(val);
+        ++m_size;
+    }
+}
+
+template <class T, size_t N>
+small_vector<T, N>::small_vector(std::initializer_list<T> init)
+: m_data(inline_data())
+{
+    reserve(init.size());
+    for (const T& val : init) {
+        new (m_data + m_size) T(val);
+        ++m_size;
+    }
+}
+
+//拷贝构造
+template <class T, size_t N>
+small_vector<T, N>::small_vector(const small_vector& other)
+: m_data(inline_data())
+{
+    reserve(other.m_size);
+    for (size_t i = 0; i < other.m_size; ++i) {
+        new (m_data + i) T(other.m_data[i]);
+        ++m_size;
+    }
+}
+
+//移动构造
+template <class T, size_t N>
+small_vector<T, N>::small_vector(small_vector&& other) noexcept(std::is_nothrow_move_constructible<T>::value)
+: m_data(inline_data())
+{
+    steal(other);
+}
+
+//析构函数
+template <class T, size_t N>
+small_vector<T, N>::~small_vector()
+{
+    clear();
+    release_storage();
+}
+
+//赋值
+template <class T, size_t N>
+small_vector<T, N>& small_vector<T, N>::operator=(const small_vector& other)
+{
+    if (this == &other) {
+        return *this;
+    }
+    small_vector temp(other);
+    clear();
+    release_storage();
+    steal(temp);
+    return *this;
+}
+
+template <class T, size_t N>
+small_vector<T, N>& small_vector<T, N>::operator=(small_vector&& other) noexcept(std::is_nothrow_move_constructible<T>::value)
+{
+    if (this == &other) {
+        return *this;
+    }
+    clear();
+    release_storage();
+    steal(other);
+    return *this;
+}
+
+//尾插
+template <class T, size_t N>
+void small_vector<T, N>::push_back(const T& val)
+{
+    if (m_size == m_capacity) {
+        //val 可能引用本容器中的元素，扩容前先拷贝一份
+        T copy(val);
+        reserve(grow_capacity());
+        new (m_data + m_size) T(std::move(copy));
+    } else {
+        new (m_data + m_size) T(val);
+    }
+    m_size++;
+}
+
+template <class T, size_t N>
+void small_vector<T, N>::push_back(T&& val)
+{
+    if (m_size == m_capacity) {
+        T copy(std::move(val));
+        reserve(grow_capacity());
+        new (m_data + m_size) T(std::move(copy));
+    } else {
+        new (m_data + m_size) T(std::move(val));
+    }
+    m_size++;
+}
+
+//尾删
+template <class T, size_t N>
+void small_vector<T, N>::pop_back()
+{
+    if (m_size == 0) {
+        return;
+    }
+    m_data[m_size - 1].~T();
+    m_size--;
+}
+
+//重新设置大小
+template <class T, size_t N>
+void small_vector<T, N>::resize(size_t n)
+{
+    if (m_size < n) {
+        if (m_capacity < n) {
+            reserve(std::max(n, grow_capacity()));
+        }
+        for (size_t i = m_size; i < n; ++i) {
+            new (m_data + i) T();
+            ++m_size;
+        }
+    } else {
+        for (size_t i = n; i < m_size; ++i) {
+            m_data[i].~T();
+        }
+        m_size = n;
+    }
+}
+
+//插入元素
+template <class T, size_t N>
+void small_vector<T, N>::insert(T* insert_begin_ptr, const T& val)
+{
+    if (insert_begin_ptr < m_data || insert_begin_ptr > m_data + m_size) {
+        return;
+    }
+    size_t insert_pos = insert_begin_ptr - m_data;
+    T copy(val);
+
+    if (m_size == m_capacity) {
+        reserve(grow_capacity());
+    }
+    if (insert_pos == m_size) {
+        new (m_data + m_size) T(std::move(copy));
+    } else {
+        new (m_data + m_size) T(std::move(m_data[m_size - 1]));
+        for (size_t i = m_size - 1; i > insert_pos; --i) {
+            m_data[i] = std::move(m_data[i - 1]);
+        }
+        m_data[insert_pos] = std::move(copy);
+    }
+    m_size++;
+}
+
+//删除指定位置的一个元素
+template <class T, size_t N>
+T* small_vector<T, N>::erase(T* erase_ptr)
+{
+    if (m_size == 0 || erase_ptr < m_data || erase_ptr >= m_data + m_size) {
+        return nullptr;
+    }
+    return erase(erase_ptr, erase_ptr + 1);
+}
+
+//删除指定范围的元素
+template <class T, size_t N>
+T* small_vector<T, N>::erase(T* erase_begin_ptr, T* erase_end_ptr)
+{
+    if (m_size == 0 || erase_begin_ptr < m_data || erase_end_ptr > m_data + m_size
+        || erase_begin_ptr >= erase_end_ptr) {
+        return erase_begin_ptr;
+    }
+    T* new_end = std::move(erase_end_ptr, m_data + m_size, erase_begin_ptr);
+    for (T* p = new_end; p != m_data + m_size; ++p) {
+        p->~T();
+    }
+    m_size = new_end - m_data;
+    return erase_begin_ptr;
+}
+
+//清空元素（保留已有容量）
+template <class T, size_t N>
+void small_vector<T, N>::clear()
+{
+    for (size_t i = 0; i < m_size; ++i) {
+        m_data[i].~T();
+    }
+    m_size = 0;
+}
+
+//at()
+template <class T, size_t N>
+const T& small_vector<T, N>::at(size_t index) const
+{
+    if (index >= m_size) {
+        throw std::out_of_range("small_vector::at: index out of range");
+    }
+    return m_data[index];
+}
+
+template <class T, size_t N>
+T& small_vector<T, N>::at(size_t index)
+{
+    if (index >= m_size) {
+        throw std::out_of_range("small_vector::at: index out of range");
+    }
+    return m_data[index];
+}
+
+template <class T, size_t N>
+const T& small_vector<T, N>::front() const
+{
+    STL_ACCESS_CHECK(m_size != 0, "small_vector::front(): empty container");
+    return m_data[0];
+}
+
+template <class T, size_t N>
+const T& small_vector<T, N>::back() const
+{
+    STL_ACCESS_CHECK(m_size != 0, "small_vector::back(): empty container");
+    return m_data[m_size - 1];
+}
+
+template <class T, size_t N>
+T& small_vector<T, N>::front()
+{
+    return const_cast<T&>(static_cast<const small_vector&>(*this).front());
+}
+
+template <class T, size_t N>
+T& small_vector<T, N>::back()
+{
+    return const_cast<T&>(static_cast<const small_vector&>(*this).back());
+}
+
+//互换容器：两边都在堆上时只交换指针，否则经由临时对象搬移元素
+template <class T, size_t N>
+void small_vector<T, N>::swap(small_vector& other)
+{
+    if (this == &other) {
+        return;
+    }
+    if (!is_inline() && !other.is_inline()) {
+        std::swap(m_data, other.m_data);
+        std::swap(m_size, other.m_size);
+        std::swap(m_capacity, other.m_capacity);
+        return;
+    }
+    small_vector temp(std::move(other));
+    other = std::move(*this);
+    *this = std::move(temp);
+}
+
+//预留空间
+template <class T, size_t N>
+void small_vector<T, N>::reserve(size_t new_capacity)
+{
+    if (new_capacity <= m_capacity) {
+        return;
+    }
+    T* new_data = static_cast<T*>(::operator new(new_capacity * sizeof(T)));
+    size_t constructed = 0;
+    try {
+        if (std::is_trivially_copyable<T>::value) {
+            if (m_size > 0) {
+                std::memcpy(static_cast<void*>(new_data), m_data, m_size * sizeof(T));
+            }
+        } else {
+            for (size_t i = 0; i < m_size; ++i) {
+                new (new_data + i) T(std::move_if_noexcept(m_data[i]));
+                constructed++;
+            }
+        }
+    } catch (...) {
+        for (size_t i = 0; i < constructed; ++i) {
+            new_data[i].~T();
+        }
+        ::operator delete(new_data);
+        throw;
+    }
+
+    for (size_t i = 0; i < m_size; ++i) {
+        m_data[i].~T();
+    }
+    release_storage();
+    m_data = new_data;
+    m_capacity = new_capacity;
+}
+
+//辅助函数实现
+template <class T, size_t N>
+void small_vector<T, N>::relocate(T* dst, T* src, size_t n)
+{
+    if (std::is_trivially_copyable<T>::value) {
+        if (n > 0) {
+            std::memcpy(static_cast<void*>(dst), src, n * sizeof(T));
+        }
+        return;
+    }
+    for (size_t i = 0; i < n; ++i) {
+        new (dst + i) T(std::move(src[i]));
+        src[i].~T();
+    }
+}
+
+template <class T, size_t N>
+void small_vector<T, N>::release_storage()
+{
+    if (!is_inline()) {
+        ::operator delete(m_data);
+        m_data = inline_data();
+        m_capacity = N;
+    }
+}
+
+//调用前本对象必须为空的内联状态
+template <class T, size_t N>
+void small_vector<T, N>::steal(small_vector& other)
+{
+    if (other.is_inline()) {
+        relocate(m_data, other.m_data, other.m_size);
+        m_size = other.m_size;
+        other.m_size = 0;
+    } else {
+        m_data = other.m_data;
+        m_size = other.m_size;
+        m_capacity = other.m_capacity;
+        other.m_data = other.inline_data();
+        other.m_size = 0;
+        other.m_capacity = N;
+    }
+}
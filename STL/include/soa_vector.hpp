@@ -0,0 +1,279 @@
+#pragma once
+#include<iostream>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+#include <type_traits>
+#include "vector.hpp"
+
+// 列式（Structure of Arrays）容器：soa_vector<float, float, uint32_t> 的每个字段各自存放在
+// 一个 64 字节对齐的连续数组中（每列是一个使用 aligned_heap_storage 的 vector）。
+// 热循环只访问一两个字段时，每条缓存行装满的都是有用数据，也方便编译器向量化：
+//     soa_span<float> xs = v.column<0>();
+//     for (size_t i = 0; i < xs.size(); ++i) sum += xs[i];
+// 按行访问通过代理引用：v[i].get<1>() = 2.0f; 或 v[i] = std::make_tuple(...)。
+
+//列视图：指向某一列连续内存的指针 + 长度
+template <class T>
+class soa_span
+{
+private:
+    T* m_data;
+    size_t m_size;
+
+public:
+    soa_span(T* data, size_t size) : m_data(data), m_size(size) {}
+
+    T* data() const { return m_data; }
+    size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+    T& operator[](size_t index) const { return m_data[index]; }
+    T* begin() const { return m_data; }
+    T* end() const { return m_data + m_size; }
+};
+
+template <class... Ts>
+class soa_vector
+{
+    static_assert(sizeof...(Ts) > 0, "soa_vector: 至少需要一列");
+
+public:
+    static const size_t COLUMN_ALIGN = 64;
+
+    template <size_t I>
+    using column_type = typename std::tuple_element<I, std::tuple<Ts...> >::type;
+    typedef std::tuple<Ts...> value_type;
+
+    class row_reference;
+    class const_row_reference;
+
+private:
+
+    template <class T>
+    using column_vector = vector<T, growth_double, aligned_heap_storage<COLUMN_ALIGN> >;
+
+    std::tuple<column_vector<Ts>...> m_columns;
+    size_t m_size = 0;
+
+public:
+
+    //构造
+    soa_vector() = default;
+
+    //尾插和尾删
+    void push_back(const Ts&... vals);
+    void push_back(const value_type& row);
+    void pop_back();
+
+    //容量和大小
+    bool empty() const { return m_size == 0; }
+    size_t size() const { return m_size; }
+    size_t capacity() const { return std::get<0>(m_columns).capacity(); }
+    void reserve(size_t n);
+    void resize(size_t n);
+    void clear();
+
+    //按行访问（代理引用）
+    row_reference operator[](size_t index) { return row_reference(this, index); }
+    const_row_reference operator[](size_t index) const { return const_row_reference(this, index); }
+    row_reference at(size_t index);
+    const_row_reference at(size_t index) const;
+    row_reference front() { return at(0); }
+    row_reference back() { return at(m_size - 1); }
+
+    //按列访问
+    template <size_t I>
+    soa_span<column_type<I> > column() {
+        return soa_span<column_type<I> >(std::get<I>(m_columns).data(), m_size);
+    }
+    template <size_t I>
+    soa_span<const column_type<I> > column() const {
+        return soa_span<const column_type<I> >(std::get<I>(m_columns).data(), m_size);
+    }
+
+    //交换
+    void swap(soa_vector& other);
+
+private:
+    template <size_t... Is>
+    void push_back_impl(const value_type& row, std::index_sequence<Is...>);
+    template <size_t... Is>
+    value_type load_row(size_t index, std::index_sequence<Is...>) const;
+    template <size_t... Is>
+    void store_row(size_t index, const value_type& row, std::index_sequence<Is...>);
+    template <size_t... Is>
+    void swap_columns(soa_vector& other, std::index_sequence<Is...>);
+
+    template <class F>
+    void for_each_column(F f);
+    void check_index(size_t index) const;
+};
+
+template <class... Ts>
+const size_t soa_vector<Ts...>::COLUMN_ALIGN;
+
+//行代理：保存容器指针和下标，读取时按列取值
+template <class... Ts>
+class soa_vector<Ts...>::row_reference
+{
+private:
+    soa_vector* m_owner;
+    size_t m_index;
+
+    friend class soa_vector;
+    row_reference(soa_vector* owner, size_t index) : m_owner(owner), m_index(index) {}
+
+public:
+    template <size_t I>
+    column_type<I>& get() const { return std::get<I>(m_owner->m_columns)[m_index]; }
+
+    operator value_type() const {
+        return m_owner->load_row(m_index, std::index_sequence_for<Ts...>());
+    }
+    const row_reference& operator=(const value_type& row) const {
+        m_owner->store_row(m_index, row, std::index_sequence_for<Ts...>());
+        return *this;
+    }
+    const row_reference& operator=(const row_reference& other) const {
+        return *this = static_cast<value_type>(other);
+    }
+};
+
+template <class... Ts>
+class soa_vector<Ts...>::const_row_reference
+{
+private:
+    const soa_vector* m_owner;
+    size_t m_index;
+
+    friend class soa_vector;
+    const_row_reference(const soa_vector* owner, size_t index) : m_owner(owner), m_index(index) {}
+
+public:
+    template <size_t I>
+    const column_type<I>& get() const { return std::get<I>(m_owner->m_columns)[m_index]; }
+
+    operator value_type() const {
+        return m_owner->load_row(m_index, std::index_sequence_for<Ts...>());
+    }
+};
+
+
+//尾插
+template <class... Ts>
+void soa_vector<Ts...>::push_back(const Ts&... vals)
+{
+    push_back_impl(value_type(vals...), std::index_sequence_for<Ts...>());
+}
+
+template <class... Ts>
+void soa_vector<Ts...>::push_back(const value_type& row)
+{
+    push_back_impl(row, std::index_sequence_for<Ts...>());
+}
+
+//先为所有列预留空间，之后逐列追加时不会再因分配失败而出现各列长度不一致
+template <class... Ts>
+template <size_t... Is>
+void soa_vector<Ts...>::push_back_impl(const value_type& row, std::index_sequence<Is...>)
+{
+    if (m_size == capacity()) {
+        reserve(m_size == 0 ? 16 : m_size * 2);
+    }
+    (std::get<Is>(m_columns).push_back(std::get<Is>(row)), ...);
+    ++m_size;
+}
+
+//尾删
+template <class... Ts>
+void soa_vector<Ts...>::pop_back()
+{
+    if (m_size == 0) {
+        return;
+    }
+    for_each_column([](auto& column) { column.pop_back(); });
+    --m_size;
+}
+
+//容量和大小
+template <class... Ts>
+void soa_vector<Ts...>::reserve(size_t n)
+{
+    for_each_column([n](auto& column) { column.reserve(n); });
+}
+
+template <class... Ts>
+void soa_vector<Ts...>::resize(size_t n)
+{
+    reserve(n);
+    for_each_column([n](auto& column) { column.resize(n); });
+    m_size = n;
+}
+
+template <class... Ts>
+void soa_vector<Ts...>::clear()
+{
+    for_each_column([](auto& column) { column.clear(); });
+    m_size = 0;
+}
+
+//按行访问
+template <class... Ts>
+typename soa_vector<Ts...>::row_reference soa_vector<Ts...>::at(size_t index)
+{
+    check_index(index);
+    return row_reference(this, index);
+}
+
+template <class... Ts>
+typename soa_vector<Ts...>::const_row_reference soa_vector<Ts...>::at(size_t index) const
+{
+    check_index(index);
+    return const_row_reference(this, index);
+}
+
+//交换
+template <class... Ts>
+void soa_vector<Ts...>::swap(soa_vector& other)
+{
+    swap_columns(other, std::index_sequence_for<Ts...>());
+    std::swap(m_size, other.m_size);
+}
+
+//辅助函数实现
+template <class... Ts>
+template <size_t... Is>
+typename soa_vector<Ts...>::value_type
+soa_vector<Ts...>::load_row(size_t index, std::index_sequence<Is...>) const
+{
+    return value_type(std::get<Is>(m_columns)[index]...);
+}
+
+template <class... Ts>
+template <size_t... Is>
+void soa_vector<Ts...>::store_row(size_t index, const value_type& row, std::index_sequence<Is...>)
+{
+    ((std::get<Is>(m_columns)[index] = std::get<Is>(row)), ...);
+}
+
+template <class... Ts>
+template <size_t... Is>
+void soa_vector<Ts...>::swap_columns(soa_vector& other, std::index_sequence<Is...>)
+{
+    (std::get<Is>(m_columns).swap(std::get<Is>(other.m_columns)), ...);
+}
+
+template <class... Ts>
+template <class F>
+void soa_vector<Ts...>::for_each_column(F f)
+{
+    std::apply([&f](auto&... columns) { (f(columns), ...); }, m_columns);
+}
+
+template <class... Ts>
+void soa_vector<Ts...>::check_index(size_t index) const
+{
+    if (index >= m_size) {
+        throw std::out_of_range("soa_vector::at: index out of range");
+    }
+}
@@ -0,0 +1,720 @@
+#pragma once
+#include<iostream>
+#include <stdexcept>
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <unistd.h>
+#include "check_policy.hpp"
+#include "block_map.hpp"
+
+// 内存有上限的双端队列：冷的中间块换出到临时文件。
+// 元素必须可平凡拷贝。两端各 hot_blocks 块加上 readahead_blocks 块的预读窗口始终驻留，
+// 驻留块数超过 max_resident_blocks 时，把离两端最远的驻留块写到文件，块指针数组里记下文件位置；
+// 头（尾）跨进新块时，后台线程把接下来 readahead_blocks 块异步读回，出队追上时通常已经在内存里。
+//     spill_deque<event> backlog(256);          //最多驻留 256 块（每块 64 KB），约 16 MB
+//     backlog.push_back(e); ... backlog.front(); backlog.pop_front();
+// 注意：
+//   - 非 const 的 operator[] / at / front / back 会把所在块读回内存（同步），可能因此换出别的块；
+//     只想读一个元素而不改变驻留状态时用 read(i)，换出的块直接从文件里读这一个元素；
+//   - 任何可能换入换出的操作（push、非 const 访问）之后，之前拿到的元素引用都可能失效；
+//   - 换出文件在 dir（默认 $TMPDIR 或 /tmp）下用 mkstemp 创建后立即 unlink，进程退出即消失；
+//   - 不支持拷贝和中间插入删除；同一个对象不能并发访问。
+
+//换出文件：按固定块大小分配文件空间，读回后的空间放进空闲表复用；
+//异步读由一个后台线程按提交顺序执行
+class spill_file
+{
+public:
+    struct request
+    {
+        void* buffer;
+        off_t offset;
+        bool done = false;
+        int error = 0;
+    };
+
+private:
+    int m_fd = -1;
+    size_t m_block_bytes;
+    off_t m_file_end = 0;
+    std::vector<off_t> m_free;
+
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::deque<request*> m_queue;
+    std::thread m_worker;
+    bool m_stop = false;
+
+    void worker_loop();
+    static void fail(const std::string& what, int err);
+    static int transfer(int fd, void* buffer, size_t bytes, off_t offset, bool writing);
+
+public:
+    spill_file(const std::string& dir, size_t block_bytes);
+    ~spill_file();
+    spill_file(const spill_file&) = delete;
+    spill_file& operator=(const spill_file&) = delete;
+
+    //写出一块，返回它在文件中的位置
+    off_t write(const void* data);
+    //同步读：整块，或块内 [skip, skip + bytes) 的一段
+    void read(off_t offset, void* buffer) const;
+    void read(off_t offset, void* buffer, size_t skip, size_t bytes) const;
+    //提交异步读，返回的请求必须交给 wait()
+    request* read_async(off_t offset, void* buffer);
+    //等待异步读完成并回收请求，读失败时抛出异常
+    void wait(request* req);
+    //归还一块文件空间
+    void release(off_t offset);
+
+    //文件中仍在使用的字节数
+    size_t bytes_in_use() const { return static_cast<size_t>(m_file_end) - m_free.size() * m_block_bytes; }
+};
+
+inline spill_file::spill_file(const std::string& dir, size_t block_bytes) : m_block_bytes(block_bytes)
+{
+    std::string pattern = dir + "/stl_spill_XXXXXX";
+    std::vector<char> path(pattern.begin(), pattern.end());
+    path.push_back('\0');
+    m_fd = mkstemp(path.data());
+    if (m_fd < 0) {
+        fail("spill_file: cannot create temp file in " + dir, errno);
+    }
+    unlink(path.data());
+    m_worker = std::thread(&spill_file::worker_loop, this);
+}
+
+inline spill_file::~spill_file()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_cv.notify_all();
+    m_worker.join();
+    close(m_fd);
+}
+
+inline void spill_file::fail(const std::string& what, int err)
+{
+    throw std::runtime_error(what + ": " + std::string(std::strerror(err)));
+}
+
+//pread / pwrite 直到传完，成功返回 0，否则返回 errno
+inline int spill_file::transfer(int fd, void* buffer, size_t bytes, off_t offset, bool writing)
+{
+    char* p = static_cast<char*>(buffer);
+    while (bytes > 0) {
+        ssize_t n = writing ? pwrite(fd, p, bytes, offset) : pread(fd, p, bytes, offset);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return n == 0 ? EIO : errno;
+        }
+        p += n;
+        bytes -= static_cast<size_t>(n);
+        offset += n;
+    }
+    return 0;
+}
+
+inline off_t spill_file::write(const void* data)
+{
+    off_t offset;
+    if (!m_free.empty()) {
+        offset = m_free.back();
+        m_free.pop_back();
+    } else {
+        offset = m_file_end;
+        m_file_end += static_cast<off_t>(m_block_bytes);
+    }
+    int err = transfer(m_fd, const_cast<void*>(data), m_block_bytes, offset, true);
+    if (err != 0) {
+        m_free.push_back(offset);
+        fail("spill_file::write", err);
+    }
+    return offset;
+}
+
+inline void spill_file::read(off_t offset, void* buffer) const
+{
+    read(offset, buffer, 0, m_block_bytes);
+}
+
+inline void spill_file::read(off_t offset, void* buffer, size_t skip, size_t bytes) const
+{
+    int err = transfer(m_fd, buffer, bytes, offset + static_cast<off_t>(skip), false);
+    if (err != 0) {
+        fail("spill_file::read", err);
+    }
+}
+
+inline spill_file::request* spill_file::read_async(off_t offset, void* buffer)
+{
+    request* req = new request;
+    req->buffer = buffer;
+    req->offset = offset;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_queue.push_back(req);
+    }
+    m_cv.notify_all();
+    return req;
+}
+
+inline void spill_file::wait(request* req)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_cv.wait(lock, [req]() { return req->done; });
+    int err = req->error;
+    lock.unlock();
+    delete req;
+    if (err != 0) {
+        fail("spill_file::wait", err);
+    }
+}
+
+inline void spill_file::release(off_t offset)
+{
+    m_free.push_back(offset);
+}
+
+inline void spill_file::worker_loop()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (;;) {
+        m_cv.wait(lock, [this]() { return m_stop || !m_queue.empty(); });
+        if (m_queue.empty()) {
+            return;
+        }
+        request* req = m_queue.front();
+        m_queue.pop_front();
+        lock.unlock();
+        int err = transfer(m_fd, req->buffer, m_block_bytes, req->offset, false);
+        lock.lock();
+        req->error = err;
+        req->done = true;
+        m_cv.notify_all();
+    }
+}
+
+
+//块指针数组的槽位：驻留、已换出、读回中三种状态，全空表示没有块
+template <class T>
+struct spill_deque_slot
+{
+    T* data = nullptr;                        //驻留（或正在读回）时的块
+    off_t offset = -1;                        //已换出时在文件中的位置
+    spill_file::request* pending = nullptr;   //异步读回中
+};
+
+//每块 64 KB，换出和读回都以块为单位
+template <class T>
+constexpr size_t spill_deque_block_size()
+{
+    return sizeof(T) >= 64 * 1024 ? 1 : 64 * 1024 / sizeof(T);
+}
+
+template <class T>
+class spill_deque : private block_map<spill_deque_slot<T>, spill_deque_block_size<T>()>
+{
+    static_assert(std::is_trivially_copyable<T>::value, "spill_deque: 元素必须可平凡拷贝");
+
+    typedef spill_deque_slot<T> slot;
+    typedef block_map<slot, spill_deque_block_size<T>()> base;
+
+public:
+    using base::BLOCK_SIZE;
+
+private:
+    static const size_t NPOS = size_t(-1);
+
+    using base::m_map;
+    using base::m_map_size;
+    using base::m_start_block;
+    using base::m_start_index;
+    using base::m_size;
+    using base::last_block;
+
+    size_t m_max_resident;
+    size_t m_hot_blocks;
+    size_t m_readahead;
+    std::string m_dir;
+    std::vector<size_t> m_resident;       //驻留（含读回中）块的槽位
+    size_t m_spilled = 0;                 //已换出且不在读回中的块数
+    std::unique_ptr<spill_file> m_file;   //第一次换出时创建
+
+public:
+    //max_resident_blocks：驻留块数上限，不能小于 2 * (hot_blocks + readahead_blocks)
+    explicit spill_deque(size_t max_resident_blocks = 64, size_t hot_blocks = 2,
+                         size_t readahead_blocks = 2, const std::string& dir = std::string());
+    spill_deque(spill_deque&& other) noexcept;
+    spill_deque& operator=(spill_deque&& other) noexcept;
+    spill_deque(const spill_deque&) = delete;
+    spill_deque& operator=(const spill_deque&) = delete;
+    ~spill_deque();
+
+    //两端增删
+    void push_back(const T& val);
+    void push_front(const T& val);
+    void pop_back();
+    void pop_front();
+    void clear();
+
+    bool empty() const { return m_size == 0; }
+    size_t size() const { return m_size; }
+
+    //访问：所在块已换出时先同步读回
+    T& operator[](size_t index);
+    T& at(size_t index);
+    T& front();
+    T& back();
+    //只读一个元素的副本，不改变驻留状态
+    T read(size_t index) const;
+
+    //驻留块数（含读回中）、已换出块数（不含读回中）、换出文件占用字节数
+    size_t resident_blocks() const { return m_resident.size(); }
+    size_t spilled_blocks() const { return m_spilled; }
+    size_t spilled_bytes() const { return m_file ? m_file->bytes_in_use() : 0; }
+
+    void swap(spill_deque& other) noexcept;
+
+private:
+    bool slot_empty(size_t i) const { return m_map[i].data == nullptr && m_map[i].offset < 0; }
+
+    spill_file& file();
+    T* new_block(size_t i);
+    //保证块驻留并返回块数据，keep 之外的冷块可能因此被换出
+    T* page_in(size_t i);
+    void finish_load(size_t i);
+    void start_load(size_t i);
+    void spill(size_t resident_pos);
+    //放弃未完成的读回：等后台线程用完缓冲区后释放，块回到已换出状态（文件里的内容还在）
+    void cancel_load(size_t resident_pos);
+    void release_slot(size_t i);
+    void forget_resident(size_t i);
+    //驻留块超过上限时换出离两端最远、且不在两端窗口内的块；
+    //被推出窗口的读回中的块同样可以被选中，直接放弃读回
+    void enforce_cap(size_t keep);
+    void readahead_front();
+    void readahead_back();
+    //block_map 扩大或重新居中指针数组后，驻留表里的槽位跟着平移
+    void remap_resident(size_t old_start_block);
+};
+template <class T>
+const size_t spill_deque<T>::NPOS;
+
+
+//构造
+template <class T>
+spill_deque<T>::spill_deque(size_t max_resident_blocks, size_t hot_blocks, size_t readahead_blocks,
+                            const std::string& dir)
+: m_max_resident(max_resident_blocks),
+  m_hot_blocks(hot_blocks),
+  m_readahead(readahead_blocks),
+  m_dir(dir)
+{
+    if (hot_blocks == 0 || max_resident_blocks < 2 * (hot_blocks + readahead_blocks)) {
+        throw std::invalid_argument("spill_deque: max_resident_blocks must cover both hot and read-ahead windows");
+    }
+    if (m_dir.empty()) {
+        const char* tmp = std::getenv("TMPDIR");
+        m_dir = (tmp != nullptr && *tmp != '\0') ? tmp : "/tmp";
+    }
+}
+
+template <class T>
+spill_deque<T>::spill_deque(spill_deque&& other) noexcept
+: m_max_resident(other.m_max_resident),
+  m_hot_blocks(other.m_hot_blocks),
+  m_readahead(other.m_readahead)
+{
+    swap(other);
+}
+
+template <class T>
+spill_deque<T>& spill_deque<T>::operator=(spill_deque&& other) noexcept
+{
+    if (this != &other) {
+        spill_deque temp(std::move(other));
+        swap(temp);
+    }
+    return *this;
+}
+
+//指针数组由 block_map 释放
+template <class T>
+spill_deque<T>::~spill_deque()
+{
+    clear();
+}
+
+template <class T>
+void spill_deque<T>::swap(spill_deque& other) noexcept
+{
+    this->swap_map(other);
+    std::swap(m_max_resident, other.m_max_resident);
+    std::swap(m_hot_blocks, other.m_hot_blocks);
+    std::swap(m_readahead, other.m_readahead);
+    m_dir.swap(other.m_dir);
+    m_resident.swap(other.m_resident);
+    std::swap(m_spilled, other.m_spilled);
+    m_file.swap(other.m_file);
+}
+
+
+//两端增删
+template <class T>
+void spill_deque<T>::push_back(const T& val)
+{
+    //val 可能就是本容器里的元素，换入换出之前先复制
+    const T copy = val;
+    size_t old_start_block = m_start_block;
+    size_t index;
+    size_t i = this->back_slot(index);
+    remap_resident(old_start_block);
+    T* data = slot_empty(i) ? new_block(i) : page_in(i);
+    data[index] = copy;
+    ++m_size;
+    enforce_cap(i);
+}
+
+template <class T>
+void spill_deque<T>::push_front(const T& val)
+{
+    const T copy = val;
+    size_t old_start_block = m_start_block;
+    size_t index;
+    size_t i = this->front_slot(index);
+    remap_resident(old_start_block);
+    T* data = slot_empty(i) ? new_block(i) : page_in(i);
+    data[index] = copy;
+    this->commit_front(i, index);
+    enforce_cap(i);
+}
+
+//出队不需要读回元素；块空了就直接释放（内存或文件空间）
+template <class T>
+void spill_deque<T>::pop_back()
+{
+    if (empty()) {
+        throw std::out_of_range("spill_deque::pop_back: spill_deque is empty");
+    }
+    size_t i = last_block();
+    --m_size;
+    if (m_size == 0 || last_block() != i) {
+        release_slot(i);
+        readahead_back();
+    }
+}
+
+template <class T>
+void spill_deque<T>::pop_front()
+{
+    if (empty()) {
+        throw std::out_of_range("spill_deque::pop_front: spill_deque is empty");
+    }
+    size_t i = m_start_block;
+    --m_size;
+    if (++m_start_index == BLOCK_SIZE) {
+        m_start_index = 0;
+        ++m_start_block;
+    }
+    if (m_size == 0 || m_start_block != i) {
+        release_slot(i);
+        readahead_front();
+    }
+}
+
+template <class T>
+void spill_deque<T>::clear()
+{
+    if (m_size == 0) {
+        return;
+    }
+    for (size_t i = m_start_block; i <= last_block(); ++i) {
+        release_slot(i);
+    }
+    this->reset_position();
+}
+
+
+//访问
+template <class T>
+T& spill_deque<T>::operator[](size_t index)
+{
+    STL_ACCESS_CHECK(index < m_size, "spill_deque::operator[]: index out of range");
+    size_t pos = m_start_index + index;
+    return page_in(m_start_block + pos / BLOCK_SIZE)[pos % BLOCK_SIZE];
+}
+
+template <class T>
+T& spill_deque<T>::at(size_t index)
+{
+    if (index >= m_size) {
+        throw std::out_of_range("spill_deque::at: index out of range");
+    }
+    return (*this)[index];
+}
+
+template <class T>
+T& spill_deque<T>::front()
+{
+    STL_ACCESS_CHECK(m_size > 0, "spill_deque::front: spill_deque is empty");
+    return (*this)[0];
+}
+
+template <class T>
+T& spill_deque<T>::back()
+{
+    STL_ACCESS_CHECK(m_size > 0, "spill_deque::back: spill_deque is empty");
+    return (*this)[m_size - 1];
+}
+
+template <class T>
+T spill_deque<T>::read(size_t index) const
+{
+    if (index >= m_size) {
+        throw std::out_of_range("spill_deque::read: index out of range");
+    }
+    size_t pos = m_start_index + index;
+    const slot& s = m_map[m_start_block + pos / BLOCK_SIZE];
+    if (s.data != nullptr && s.pending == nullptr) {
+        return s.data[pos % BLOCK_SIZE];
+    }
+    //已换出或正在读回：文件里的内容在读回完成前一直有效
+    T val;
+    m_file->read(s.offset, &val, (pos % BLOCK_SIZE) * sizeof(T), sizeof(T));
+    return val;
+}
+
+
+//辅助函数
+template <class T>
+spill_file& spill_deque<T>::file()
+{
+    if (!m_file) {
+        m_file.reset(new spill_file(m_dir, BLOCK_SIZE * sizeof(T)));
+    }
+    return *m_file;
+}
+
+template <class T>
+T* spill_deque<T>::new_block(size_t i)
+{
+    m_resident.reserve(m_resident.size() + 1);
+    m_map[i].data = std::allocator<T>().allocate(BLOCK_SIZE);
+    m_resident.push_back(i);
+    return m_map[i].data;
+}
+
+template <class T>
+T* spill_deque<T>::page_in(size_t i)
+{
+    slot& s = m_map[i];
+    if (s.pending != nullptr) {
+        finish_load(i);
+    } else if (s.data == nullptr) {
+        m_resident.reserve(m_resident.size() + 1);
+        T* buffer = std::allocator<T>().allocate(BLOCK_SIZE);
+        try {
+            m_file->read(s.offset, buffer);
+        } catch (...) {
+            std::allocator<T>().deallocate(buffer, BLOCK_SIZE);
+            throw;
+        }
+        m_file->release(s.offset);
+        s.offset = -1;
+        s.data = buffer;
+        --m_spilled;
+        m_resident.push_back(i);
+        enforce_cap(i);
+    }
+    return m_map[i].data;
+}
+
+//读失败时块退回已换出状态，下次访问会同步重试
+template <class T>
+void spill_deque<T>::finish_load(size_t i)
+{
+    slot& s = m_map[i];
+    spill_file::request* req = s.pending;
+    s.pending = nullptr;
+    try {
+        m_file->wait(req);
+    } catch (...) {
+        std::allocator<T>().deallocate(s.data, BLOCK_SIZE);
+        s.data = nullptr;
+        forget_resident(i);
+        ++m_spilled;
+        throw;
+    }
+    m_file->release(s.offset);
+    s.offset = -1;
+}
+
+template <class T>
+void spill_deque<T>::start_load(size_t i)
+{
+    slot& s = m_map[i];
+    m_resident.reserve(m_resident.size() + 1);
+    s.data = std::allocator<T>().allocate(BLOCK_SIZE);
+    s.pending = m_file->read_async(s.offset, s.data);
+    m_resident.push_back(i);
+    --m_spilled;
+}
+
+template <class T>
+void spill_deque<T>::spill(size_t resident_pos)
+{
+    size_t i = m_resident[resident_pos];
+    slot& s = m_map[i];
+    s.offset = file().write(s.data);
+    std::allocator<T>().deallocate(s.data, BLOCK_SIZE);
+    s.data = nullptr;
+    ++m_spilled;
+    m_resident[resident_pos] = m_resident.back();
+    m_resident.pop_back();
+}
+
+template <class T>
+void spill_deque<T>::cancel_load(size_t resident_pos)
+{
+    size_t i = m_resident[resident_pos];
+    slot& s = m_map[i];
+    //读失败也无所谓，下次访问会从文件同步重读
+    try {
+        m_file->wait(s.pending);
+    } catch (...) {
+    }
+    s.pending = nullptr;
+    std::allocator<T>().deallocate(s.data, BLOCK_SIZE);
+    s.data = nullptr;
+    ++m_spilled;
+    m_resident[resident_pos] = m_resident.back();
+    m_resident.pop_back();
+}
+
+template <class T>
+void spill_deque<T>::release_slot(size_t i)
+{
+    slot& s = m_map[i];
+    if (s.pending != nullptr) {
+        //缓冲区还在被后台线程写入，必须等它完成；块已经不要了，读失败也无所谓
+        try {
+            m_file->wait(s.pending);
+        } catch (...) {
+        }
+        s.pending = nullptr;
+    }
+    if (s.data != nullptr) {
+        std::allocator<T>().deallocate(s.data, BLOCK_SIZE);
+        forget_resident(i);
+    } else if (s.offset >= 0) {
+        --m_spilled;
+    }
+    if (s.offset >= 0) {
+        m_file->release(s.offset);
+    }
+    s = slot();
+}
+
+template <class T>
+void spill_deque<T>::forget_resident(size_t i)
+{
+    for (size_t k = 0; k < m_resident.size(); ++k) {
+        if (m_resident[k] == i) {
+            m_resident[k] = m_resident.back();
+            m_resident.pop_back();
+            return;
+        }
+    }
+}
+
+template <class T>
+void spill_deque<T>::enforce_cap(size_t keep)
+{
+    size_t window = m_hot_blocks + m_readahead;
+    while (m_resident.size() > m_max_resident) {
+        size_t first = m_start_block;
+        size_t last = last_block();
+        size_t victim = NPOS;
+        size_t victim_distance = 0;
+        for (size_t k = 0; k < m_resident.size(); ++k) {
+            size_t i = m_resident[k];
+            if (i == keep) {
+                continue;
+            }
+            size_t distance = std::min(i - first, last - i);
+            if (distance >= window && (victim == NPOS || distance > victim_distance)) {
+                victim = k;
+                victim_distance = distance;
+            }
+        }
+        if (victim == NPOS) {
+            return;
+        }
+        if (m_map[m_resident[victim]].pending != nullptr) {
+            cancel_load(victim);
+        } else {
+            spill(victim);
+        }
+    }
+}
+
+template <class T>
+void spill_deque<T>::readahead_front()
+{
+    if (m_size == 0 || m_spilled == 0) {
+        return;
+    }
+    size_t end = std::min(last_block() + 1, m_start_block + m_hot_blocks + m_readahead);
+    for (size_t i = m_start_block; i < end; ++i) {
+        if (m_map[i].data == nullptr) {
+            start_load(i);
+        }
+    }
+    enforce_cap(NPOS);
+}
+
+template <class T>
+void spill_deque<T>::readahead_back()
+{
+    if (m_size == 0 || m_spilled == 0) {
+        return;
+    }
+    size_t last = last_block();
+    size_t window = m_hot_blocks + m_readahead;
+    size_t begin = last - m_start_block + 1 > window ? last + 1 - window : m_start_block;
+    for (size_t i = last + 1; i-- > begin;) {
+        if (m_map[i].data == nullptr) {
+            start_load(i);
+        }
+    }
+    enforce_cap(NPOS);
+}
+
+template <class T>
+void spill_deque<T>::remap_resident(size_t old_start_block)
+{
+    if (m_start_block == old_start_block) {
+        return;
+    }
+    for (size_t& i : m_resident) {
+        i = i - old_start_block + m_start_block;
+    }
+}
@@ -0,0 +1,448 @@
+#pragma once
+#include<iostream>
+#include <stdexcept>
+#include <initializer_list>
+#include <type_traits>
+#include <utility>
+#include "check_policy.hpp"
+#include <new>
+
+// 固定容量的 vector：元素全部存放在对象内部，永不分配内存，容量满时 push_back 抛出 length_error。
+// 接口与 vector 保持一致。
+// 对于平凡类型（平凡默认构造 + 平凡拷贝赋值 + 平凡析构），存储是一个普通数组，
+// 所有操作都可以在常量表达式中使用，可以在编译期构建查找表：
+//     constexpr auto table = build_table();   // build_table 返回 static_vector<int, 256>
+// 元素类型平凡析构时，容器本身也是平凡析构的。
+
+//存储层：按元素类型选择普通数组或原始内存
+template <class T, size_t N,
+          bool LITERAL = std::is_trivially_default_constructible<T>::value &&
+                         std::is_trivially_copy_assignable<T>::value &&
+                         std::is_trivially_destructible<T>::value,
+          bool TRIVIAL_DTOR = std::is_trivially_destructible<T>::value>
+class static_vector_storage;
+
+//平凡类型：普通数组，可用于常量表达式
+template <class T, size_t N>
+class static_vector_storage<T, N, true, true>
+{
+protected:
+    T m_data[N];
+    size_t m_size;
+
+    constexpr static_vector_storage() : m_data{}, m_size(0) {}
+
+    constexpr T* storage() { return m_data; }
+    constexpr const T* storage() const { return m_data; }
+
+    template <class... Args>
+    constexpr void construct(size_t index, Args&&... args) { m_data[index] = T(std::forward<Args>(args)...); }
+    constexpr void destroy(size_t) {}
+};
+
+//非平凡类型：原始内存 + placement new
+template <class T, size_t N>
+class static_vector_storage<T, N, false, true>
+{
+protected:
+    alignas(T) unsigned char m_buffer[N * sizeof(T)];
+    size_t m_size = 0;
+
+    T* storage() { return reinterpret_cast<T*>(m_buffer); }
+    const T* storage() const { return reinterpret_cast<const T*>(m_buffer); }
+
+    template <class... Args>
+    void construct(size_t index, Args&&... args) { new (storage() + index) T(std::forward<Args>(args)...); }
+    void destroy(size_t) {}
+};
+
+template <class T, size_t N>
+class static_vector_storage<T, N, false, false>
+{
+protected:
+    alignas(T) unsigned char m_buffer[N * sizeof(T)];
+    size_t m_size = 0;
+
+    static_vector_storage() = default;
+    ~static_vector_storage() {
+        for (size_t i = 0; i < m_size; ++i) {
+            storage()[i].~T();
+        }
+    }
+
+    T* storage() { return reinterpret_cast<T*>(m_buffer); }
+    const T* storage() const { return reinterpret_cast<const T*>(m_buffer); }
+
+    template <class... Args>
+    void construct(size_t index, Args&&... args) { new (storage() + index) T(std::forward<Args>(args)...); }
+    void destroy(size_t index) { storage()[index].~T(); }
+};
+
+
+template <class T, size_t N>
+class static_vector : private static_vector_storage<T, N>
+{
+    static_assert(N > 0, "static_vector: 容量至少为 1");
+
+private:
+    typedef static_vector_storage<T, N> base;
+    using base::m_size;
+    using base::storage;
+    using base::construct;
+    using base::destroy;
+
+public:
+
+    //构造
+    constexpr static_vector() = default;
+    constexpr static_vector(size_t n, const T& val);   //（数量，数据）
+    constexpr static_vector(std::initializer_list<T> init);
+
+    //拷贝构造和移动构造
+    constexpr static_vector(const static_vector& other);
+    constexpr static_vector(static_vector&& other);
+
+    //赋值
+    constexpr static_vector& operator=(const static_vector& other);
+    constexpr static_vector& operator=(static_vector&& other);
+
+    //尾插和尾删
+    constexpr void push_back(const T& val);
+    constexpr void push_back(T&& val);
+    template <class... Args>
+    constexpr T& emplace_back(Args&&... args);
+    constexpr void pop_back();
+
+    //容量和大小
+    constexpr bool empty() const { return m_size == 0; }
+    constexpr size_t capacity() const { return N; }
+    constexpr size_t max_size() const { return N; }
+    constexpr size_t size() const { return m_size; }
+    constexpr bool full() const { return m_size == N; }
+    constexpr void resize(size_t size);
+    constexpr void resize(size_t size, const T& val);
+
+    //插入和删除
+    constexpr void insert(T* insert_begin_ptr, const T& val);
+    constexpr T* erase(T* erase_ptr);
+    constexpr T* erase(T* erase_begin_ptr, T* erase_end_ptr);
+    constexpr void clear();
+
+    //数据存取
+    constexpr const T& operator[](size_t index) const {
+        STL_ACCESS_CHECK(index < m_size, "static_vector::operator[]: index out of range");
+        return storage()[index];
+    }
+    constexpr T& operator[](size_t index) {
+        STL_ACCESS_CHECK(index < m_size, "static_vector::operator[]: index out of range");
+        return storage()[index];
+    }
+    constexpr const T& at(size_t index) const;
+    constexpr T& at(size_t index);
+
+    constexpr const T& front() const;
+    constexpr const T& back() const;
+    constexpr T& front();
+    constexpr T& back();
+
+    constexpr T* data() { return storage(); }
+    constexpr const T* data() const { return storage(); }
+
+    //互换容器
+    constexpr void swap(static_vector& other);
+
+    //预留空间：容量固定，超过 N 时抛出 length_error
+    constexpr void reserve(size_t size);
+
+    // 迭代器
+    constexpr T* begin() { return storage(); }
+    constexpr const T* begin() const { return storage(); }
+    constexpr T* end() { return storage() + m_size; }
+    constexpr const T* end() const { return storage() + m_size; }
+
+private:
+    constexpr void check_room(size_t n, const char* what) const {
+        if (n > N) {
+            throw std::length_error(what);
+        }
+    }
+};
+
+
+//构造
+template <class T, size_t N>
+constexpr static_vector<T, N>::static_vector(size_t n, const T& val)
+: base()
+{
+    check_room(n, "static_vector: size exceeds capacity");
+    for (size_t i = 0; i < n; ++i) {
+        construct(i, val);
+        ++m_size;
+    }
+}
+
+template <class T, size_t N>
+constexpr static_vector<T, N>::static_vector(std::initializer_list<T> init)
+: base()
+{
+    check_room(init.size(), "static_vector: size exceeds capacity");
+    for (const T* p = init.begin(); p != init.end(); ++p) {
+        construct(m_size, *p);
+        ++m_size;
+    }
+}
+
+//拷贝构造
+template <class T, size_t N>
+constexpr static_vector<T, N>::static_vector(const static_vector& other)
+: base()
+{
+    for (size_t i = 0; i < other.m_size; ++i) {
+        construct(i, other[i]);
+        ++m_size;
+    }
+}
+
+//移动构造：逐个移动元素，other 的大小不变
+template <class T, size_t N>
+constexpr static_vector<T, N>::static_vector(static_vector&& other)
+: base()
+{
+    for (size_t i = 0; i < other.m_size; ++i) {
+        construct(i, std::move(other[i]));
+        ++m_size;
+    }
+}
+
+//赋值
+template <class T, size_t N>
+constexpr static_vector<T, N>& static_vector<T, N>::operator=(const static_vector& other)
+{
+    if (this == &other) {
+        return *this;
+    }
+    clear();
+    for (size_t i = 0; i < other.m_size; ++i) {
+        construct(i, other[i]);
+        ++m_size;
+    }
+    return *this;
+}
+
+template <class T, size_t N>
+constexpr static_vector<T, N>& static_vector<T, N>::operator=(static_vector&& other)
+{
+    if (this == &other) {
+        return *this;
+    }
+    clear();
+    for (size_t i = 0; i < other.m_size; ++i) {
+        construct(i, std::move(other[i]));
+        ++m_size;
+    }
+    return *this;
+}
+
+//尾插
+template <class T, size_t N>
+constexpr void static_vector<T, N>::push_back(const T& val)
+{
+    check_room(m_size + 1, "static_vector::push_back: container is full");
+    construct(m_size, val);
+    ++m_size;
+}
+
+template <class T, size_t N>
+constexpr void static_vector<T, N>::push_back(T&& val)
+{
+    check_room(m_size + 1, "static_vector::push_back: container is full");
+    construct(m_size, std::move(val));
+    ++m_size;
+}
+
+template <class T, size_t N>
+template <class... Args>
+constexpr T& static_vector<T, N>::emplace_back(Args&&... args)
+{
+    check_room(m_size + 1, "static_vector::emplace_back: container is full");
+    construct(m_size, std::forward<Args>(args)...);
+    ++m_size;
+    return storage()[m_size - 1];
+}
+
+//尾删
+template <class T, size_t N>
+constexpr void static_vector<T, N>::pop_back()
+{
+    if (m_size == 0) {
+        return;
+    }
+    destroy(m_size - 1);
+    --m_size;
+}
+
+//重新设置大小
+template <class T, size_t N>
+constexpr void static_vector<T, N>::resize(size_t n)
+{
+    check_room(n, "static_vector::resize: size exceeds capacity");
+    while (m_size < n) {
+        construct(m_size);
+        ++m_size;
+    }
+    while (m_size > n) {
+        pop_back();
+    }
+}
+
+template <class T, size_t N>
+constexpr void static_vector<T, N>::resize(size_t n, const T& val)
+{
+    check_room(n, "static_vector::resize: size exceeds capacity");
+    while (m_size < n) {
+        construct(m_size, val);
+        ++m_size;
+    }
+    while (m_size > n) {
+        pop_back();
+    }
+}
+
+//插入元素
+template <class T, size_t N>
+constexpr void static_vector<T, N>::insert(T* insert_begin_ptr, const T& val)
+{
+    if (insert_begin_ptr < begin() || insert_begin_ptr > end()) {
+        return;
+    }
+    check_room(m_size + 1, "static_vector::insert: container is full");
+    size_t insert_pos = insert_begin_ptr - begin();
+    T copy(val);
+
+    if (insert_pos == m_size) {
+        construct(m_size, std::move(copy));
+    } else {
+        construct(m_size, std::move(storage()[m_size - 1]));
+        for (size_t i = m_size - 1; i > insert_pos; --i) {
+            storage()[i] = std::move(storage()[i - 1]);
+        }
+        storage()[insert_pos] = std::move(copy);
+    }
+    ++m_size;
+}
+
+//删除指定位置的一个元素
+template <class T, size_t N>
+constexpr T* static_vector<T, N>::erase(T* erase_ptr)
+{
+    if (m_size == 0 || erase_ptr < begin() || erase_ptr >= end()) {
+        return nullptr;
+    }
+    return erase(erase_ptr, erase_ptr + 1);
+}
+
+//删除指定范围的元素
+template <class T, size_t N>
+constexpr T* static_vector<T, N>::erase(T* erase_begin_ptr, T* erase_end_ptr)
+{
+    if (m_size == 0 || erase_begin_ptr < begin() || erase_end_ptr > end()
+        || erase_begin_ptr >= erase_end_ptr) {
+        return erase_begin_ptr;
+    }
+    T* dst = erase_begin_ptr;
+    for (T* src = erase_end_ptr; src != end(); ++src, ++dst) {
+        *dst = std::move(*src);
+    }
+    size_t new_size = dst - begin();
+    while (m_size > new_size) {
+        pop_back();
+    }
+    return erase_begin_ptr;
+}
+
+//清空元素
+template <class T, size_t N>
+constexpr void static_vector<T, N>::clear()
+{
+    while (m_size > 0) {
+        pop_back();
+    }
+}
+
+//at()
+template <class T, size_t N>
+constexpr const T& static_vector<T, N>::at(size_t index) const
+{
+    if (index >= m_size) {
+        throw std::out_of_range("static_vector::at: index out of range");
+    }
+    return storage()[index];
+}
+
+template <class T, size_t N>
+constexpr T& static_vector<T, N>::at(size_t index)
+{
+    if (index >= m_size) {
+        throw std::out_of_range("static_vector::at: index out of range");
+    }
+    return storage()[index];
+}
+
+template <class T, size_t N>
+constexpr const T& static_vector<T, N>::front() const
+{
+    STL_ACCESS_CHECK(m_size != 0, "static_vector::front(): empty container");
+    return storage()[0];
+}
+
+template <class T, size_t N>
+constexpr const T& static_vector<T, N>::back() const
+{
+    STL_ACCESS_CHECK(m_size != 0, "static_vector::back(): empty container");
+    return storage()[m_size - 1];
+}
+
+template <class T, size_t N>
+constexpr T& static_vector<T, N>::front()
+{
+    STL_ACCESS_CHECK(m_size != 0, "static_vector::front(): empty container");
+    return storage()[0];
+}
+
+template <class T, size_t N>
+constexpr T& static_vector<T, N>::back()
+{
+    STL_ACCESS_CHECK(m_size != 0, "static_vector::back(): empty container");
+    return storage()[m_size - 1];
+}
+
+//互换容器：元素存放在对象内部，只能逐个交换，多出来的部分搬到较短的一方
+template <class T, size_t N>
+constexpr void static_vector<T, N>::swap(static_vector& other)
+{
+    if (this == &other) {
+        return;
+    }
+    static_vector& shorter = (m_size < other.m_size) ? *this : other;
+    static_vector& longer = (m_size < other.m_size) ? other : *this;
+    size_t common = shorter.m_size;
+    for (size_t i = 0; i < common; ++i) {
+        T tmp(std::move(shorter[i]));
+        shorter[i] = std::move(longer[i]);
+        longer[i] = std::move(tmp);
+    }
+    for (size_t i = common; i < longer.m_size; ++i) {
+        shorter.construct(i, std::move(longer[i]));
+        ++shorter.m_size;
+    }
+    while (longer.m_size > common) {
+        longer.pop_back();
+    }
+}
+
+//预留空间
+template <class T, size_t N>
+constexpr void static_vector<T, N>::reserve(size_t new_capacity)
+{
+    check_room(new_capacity, "static_vector::reserve: capacity is fixed");
+}
@@ -0,0 +1,410 @@
+#pragma once
+#include<iostream>
+#include <stdexcept>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+// 容器操作轨迹（trace）的录制与读取
+// trace_recorder<C> 包装一个 vector / deque（或接口相同的容器），把经过它的
+// push / pop / insert / erase / 下标访问 / clear 依次写进 trace_writer，得到紧凑的二进制轨迹文件；
+// bench/trace_replay 读取轨迹，在不同容器实现上重放，对比吞吐、延迟分位数和内存峰值。
+//     trace_writer writer("jobs.trace", sizeof(job));
+//     trace_recorder<deque<job>> jobs(writer);
+//     jobs.push_back(j); jobs.pop_front(); ...
+// 文件格式：8 字节魔数 "STLTRC01"，4 字节小端元素大小，之后每个操作一条记录：
+// 1 字节操作码，insert / erase / index 后面再跟一个 LEB128 变长整数（位置或下标）。
+// 只记录操作序列和位置，不记录元素内容，重放时用同样大小的占位元素。
+// 录制不加锁，一个 trace_writer 同一时间只能由一个线程使用。
+
+enum class trace_op : uint8_t
+{
+    push_back = 1,
+    push_front,
+    pop_back,
+    pop_front,
+    insert,     //参数：插入位置
+    erase,      //参数：删除位置
+    index,      //参数：访问的下标
+    clear
+};
+
+struct trace_event
+{
+    trace_op op;
+    uint64_t arg;
+};
+
+inline bool trace_op_has_arg(trace_op op)
+{
+    return op == trace_op::insert || op == trace_op::erase || op == trace_op::index;
+}
+
+inline const char* trace_op_name(trace_op op)
+{
+    switch (op) {
+    case trace_op::push_back:  return "push_back";
+    case trace_op::push_front: return "push_front";
+    case trace_op::pop_back:   return "pop_back";
+    case trace_op::pop_front:  return "pop_front";
+    case trace_op::insert:     return "insert";
+    case trace_op::erase:      return "erase";
+    case trace_op::index:      return "index";
+    case trace_op::clear:      return "clear";
+    }
+    return "unknown";
+}
+
+static const char TRACE_MAGIC[8] = {'S', 'T', 'L', 'T', 'R', 'C', '0', '1'};
+
+
+//写轨迹：记录先进缓冲区，满了或 flush() / 析构时写到流里
+class trace_writer
+{
+private:
+    static const size_t BUFFER_SIZE = 64 * 1024;
+
+    std::ofstream m_file;
+    std::ostream* m_out;
+    std::unique_ptr<char[]> m_buffer;
+    size_t m_used = 0;
+    size_t m_elem_size;
+    uint64_t m_events = 0;
+
+    void write_header();
+
+public:
+    trace_writer(const std::string& path, size_t elem_size);
+    trace_writer(std::ostream& out, size_t elem_size);
+    ~trace_writer();
+    trace_writer(const trace_writer&) = delete;
+    trace_writer& operator=(const trace_writer&) = delete;
+
+    void record(trace_op op, uint64_t arg = 0);
+    void flush();
+
+    size_t elem_size() const { return m_elem_size; }
+    uint64_t events() const { return m_events; }
+};
+
+inline trace_writer::trace_writer(const std::string& path, size_t elem_size)
+: m_file(path.c_str(), std::ios::binary | std::ios::trunc),
+  m_out(&m_file),
+  m_buffer(new char[BUFFER_SIZE]),
+  m_elem_size(elem_size)
+{
+    if (!m_file) {
+        throw std::runtime_error("trace_writer: cannot open " + path);
+    }
+    write_header();
+}
+
+inline trace_writer::trace_writer(std::ostream& out, size_t elem_size)
+: m_out(&out),
+  m_buffer(new char[BUFFER_SIZE]),
+  m_elem_size(elem_size)
+{
+    write_header();
+}
+
+inline trace_writer::~trace_writer()
+{
+    //析构里不能抛异常，写失败只能丢掉剩余记录
+    try {
+        flush();
+    } catch (...) {
+    }
+}
+
+inline void trace_writer::write_header()
+{
+    for (size_t i = 0; i < sizeof(TRACE_MAGIC); ++i) {
+        m_buffer[m_used++] = TRACE_MAGIC[i];
+    }
+    for (int i = 0; i < 4; ++i) {
+        m_buffer[m_used++] = static_cast<char>((m_elem_size >> (8 * i)) & 0xff);
+    }
+}
+
+inline void trace_writer::record(trace_op op, uint64_t arg)
+{
+    //一条记录最多 1 + 10 字节
+    if (BUFFER_SIZE - m_used < 11) {
+        flush();
+    }
+    m_buffer[m_used++] = static_cast<char>(op);
+    if (trace_op_has_arg(op)) {
+        do {
+            unsigned char byte = arg & 0x7f;
+            arg >>= 7;
+            m_buffer[m_used++] = static_cast<char>(arg != 0 ? (byte | 0x80) : byte);
+        } while (arg != 0);
+    }
+    ++m_events;
+}
+
+inline void trace_writer::flush()
+{
+    if (m_used == 0) {
+        return;
+    }
+    m_out->write(m_buffer.get(), static_cast<std::streamsize>(m_used));
+    m_out->flush();
+    m_used = 0;
+    if (!*m_out) {
+        throw std::runtime_error("trace_writer: write failed");
+    }
+}
+
+
+//读轨迹
+class trace_reader
+{
+private:
+    static const size_t BUFFER_SIZE = 64 * 1024;
+
+    std::ifstream m_file;
+    std::istream* m_in;
+    std::unique_ptr<char[]> m_buffer;
+    size_t m_pos = 0;
+    size_t m_end = 0;
+    size_t m_elem_size = 0;
+
+    bool fill();
+    bool get(unsigned char& byte);
+    void read_header();
+
+public:
+    explicit trace_reader(const std::string& path);
+    explicit trace_reader(std::istream& in);
+    trace_reader(const trace_reader&) = delete;
+    trace_reader& operator=(const trace_reader&) = delete;
+
+    size_t elem_size() const { return m_elem_size; }
+
+    //读出下一条记录；轨迹结束返回 false，文件损坏抛 runtime_error
+    bool next(trace_event& e);
+};
+
+inline trace_reader::trace_reader(const std::string& path)
+: m_file(path.c_str(), std::ios::binary),
+  m_in(&m_file),
+  m_buffer(new char[BUFFER_SIZE])
+{
+    if (!m_file) {
+        throw std::runtime_error("trace_reader: cannot open " + path);
+    }
+    read_header();
+}
+
+inline trace_reader::trace_reader(std::istream& in)
+: m_in(&in),
+  m_buffer(new char[BUFFER_SIZE])
+{
+    read_header();
+}
+
+inline bool trace_reader::fill()
+{
+    m_in->read(m_buffer.get(), static_cast<std::streamsize>(BUFFER_SIZE));
+    m_pos = 0;
+    m_end = static_cast<size_t>(m_in->gcount());
+    return m_end != 0;
+}
+
+inline bool trace_reader::get(unsigned char& byte)
+{
+    if (m_pos == m_end && !fill()) {
+        return false;
+    }
+    byte = static_cast<unsigned char>(m_buffer[m_pos++]);
+    return true;
+}
+
+inline void trace_reader::read_header()
+{
+    unsigned char byte;
+    for (size_t i = 0; i < sizeof(TRACE_MAGIC); ++i) {
+        if (!get(byte) || byte != static_cast<unsigned char>(TRACE_MAGIC[i])) {
+            throw std::runtime_error("trace_reader: not a trace file");
+        }
+    }
+    for (int i = 0; i < 4; ++i) {
+        if (!get(byte)) {
+            throw std::runtime_error("trace_reader: truncated header");
+        }
+        m_elem_size |= size_t(byte) << (8 * i);
+    }
+}
+
+inline bool trace_reader::next(trace_event& e)
+{
+    unsigned char byte;
+    if (!get(byte)) {
+        return false;
+    }
+    if (byte < static_cast<unsigned char>(trace_op::push_back) || byte > static_cast<unsigned char>(trace_op::clear)) {
+        throw std::runtime_error("trace_reader: unknown operation code");
+    }
+    e.op = static_cast<trace_op>(byte);
+    e.arg = 0;
+    if (trace_op_has_arg(e.op)) {
+        int shift = 0;
+        do {
+            if (!get(byte) || shift > 63) {
+                throw std::runtime_error("trace_reader: truncated or malformed record");
+            }
+            e.arg |= uint64_t(byte & 0x7f) << shift;
+            shift += 7;
+        } while (byte & 0x80);
+    }
+    return true;
+}
+
+
+//录制包装：接口与被包装容器一致，但插入删除用下标表示位置。
+//读写经过包装时记录；container() 返回底层容器，通过它做的访问不记录
+template <class C>
+class trace_recorder
+{
+public:
+    typedef typename std::remove_reference<decltype(std::declval<C&>()[0])>::type value_type;
+
+private:
+    C m_container;
+    trace_writer& m_trace;
+
+public:
+    explicit trace_recorder(trace_writer& trace);
+
+    void push_back(const value_type& val);
+    void push_back(value_type&& val);
+    void push_front(const value_type& val);
+    void push_front(value_type&& val);
+    void pop_back();
+    void pop_front();
+
+    void insert(size_t pos, const value_type& val);
+    void erase(size_t pos);
+    void clear();
+
+    value_type& operator[](size_t index);
+    value_type& at(size_t index);
+    value_type& front();
+    value_type& back();
+
+    bool empty() const { return m_container.empty(); }
+    size_t size() const { return m_container.size(); }
+
+    const C& container() const { return m_container; }
+    C& container() { return m_container; }
+};
+
+template <class C>
+trace_recorder<C>::trace_recorder(trace_writer& trace) : m_trace(trace)
+{
+    if (trace.elem_size() != sizeof(value_type)) {
+        throw std::invalid_argument("trace_recorder: element size does not match the trace");
+    }
+}
+
+template <class C>
+void trace_recorder<C>::push_back(const value_type& val)
+{
+    m_container.push_back(val);
+    m_trace.record(trace_op::push_back);
+}
+
+template <class C>
+void trace_recorder<C>::push_back(value_type&& val)
+{
+    m_container.push_back(std::move(val));
+    m_trace.record(trace_op::push_back);
+}
+
+template <class C>
+void trace_recorder<C>::push_front(const value_type& val)
+{
+    m_container.push_front(val);
+    m_trace.record(trace_op::push_front);
+}
+
+template <class C>
+void trace_recorder<C>::push_front(value_type&& val)
+{
+    m_container.push_front(std::move(val));
+    m_trace.record(trace_op::push_front);
+}
+
+template <class C>
+void trace_recorder<C>::pop_back()
+{
+    m_container.pop_back();
+    m_trace.record(trace_op::pop_back);
+}
+
+template <class C>
+void trace_recorder<C>::pop_front()
+{
+    m_container.pop_front();
+    m_trace.record(trace_op::pop_front);
+}
+
+template <class C>
+void trace_recorder<C>::insert(size_t pos, const value_type& val)
+{
+    if (pos > m_container.size()) {
+        throw std::out_of_range("trace_recorder::insert: position out of range");
+    }
+    m_container.insert(m_container.begin() + pos, val);
+    m_trace.record(trace_op::insert, pos);
+}
+
+template <class C>
+void trace_recorder<C>::erase(size_t pos)
+{
+    if (pos >= m_container.size()) {
+        throw std::out_of_range("trace_recorder::erase: position out of range");
+    }
+    m_container.erase(m_container.begin() + pos);
+    m_trace.record(trace_op::erase, pos);
+}
+
+template <class C>
+void trace_recorder<C>::clear()
+{
+    m_container.clear();
+    m_trace.record(trace_op::clear);
+}
+
+template <class C>
+typename trace_recorder<C>::value_type& trace_recorder<C>::operator[](size_t index)
+{
+    m_trace.record(trace_op::index, index);
+    return m_container[index];
+}
+
+template <class C>
+typename trace_recorder<C>::value_type& trace_recorder<C>::at(size_t index)
+{
+    value_type& val = m_container.at(index);
+    m_trace.record(trace_op::index, index);
+    return val;
+}
+
+template <class C>
+typename trace_recorder<C>::value_type& trace_recorder<C>::front()
+{
+    m_trace.record(trace_op::index, 0);
+    return m_container.front();
+}
+
+template <class C>
+typename trace_recorder<C>::value_type& trace_recorder<C>::back()
+{
+    m_trace.record(trace_op::index, m_container.size() - 1);
+    return m_container.back();
+}
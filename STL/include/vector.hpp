@@ -1,8 +1,169 @@
 #pragma once
 #include<iostream>
 #include <stdexcept>
+#include <type_traits>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include "check_policy.hpp"
+#include "instrument.hpp"
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+//增长策略：next_capacity(当前容量, 至少需要的容量, 元素大小) 返回扩容后的容量
+
+//2倍增长（默认）
+struct growth_double
+{
+    static size_t next_capacity(size_t capacity, size_t required, size_t)
+    {
+        return std::max(required, capacity == 0 ? size_t(1) : capacity * 2);
+    }
+};
+
+//1.5倍增长：释放的旧块之和有机会被后续分配复用
+struct growth_one_and_half
+{
+    static size_t next_capacity(size_t capacity, size_t required, size_t)
+    {
+        return std::max(required, capacity + capacity / 2 + 1);
+    }
+};
 
+//按分配器尺寸等级取整：1.5倍增长后，把字节数向上取整到 malloc 实际会给出的块大小，
+//小块每个 2 的幂区间分 4 档，4KB 以上按页取整，2MB 以上按大页取整，避免申请到的块尾部浪费
+struct growth_size_class
+{
+    static size_t round_bytes(size_t bytes)
+    {
+        const size_t page = 4096;
+        const size_t huge_page = 2 * 1024 * 1024;
+        if (bytes <= 16) {
+            return 16;
+        }
+        if (bytes <= page) {
+            size_t pow2 = 16;
+            while (pow2 < bytes) {
+                pow2 *= 2;
+            }
+            size_t step = std::max(pow2 / 4, size_t(16));
+            return (bytes + step - 1) / step * step;
+        }
+        if (bytes <= huge_page) {
+            return (bytes + page - 1) / page * page;
+        }
+        return (bytes + huge_page - 1) / huge_page * huge_page;
+    }
+
+    static size_t next_capacity(size_t capacity, size_t required, size_t elem_size)
+    {
+        size_t wanted = std::max(required, capacity + capacity / 2 + 1);
+        return round_bytes(wanted * elem_size) / elem_size;
+    }
+};
+
+//可平凡重定位：对象可以按字节搬到新地址而不调用移动构造和析构。
+//默认等同于可平凡拷贝，自定义类型（例如持有堆指针但没有自引用的类型）可以特化为 true_type
 template <class T>
+struct is_trivially_relocatable : std::is_trivially_copyable<T> {};
+
+//存储后端：负责原始内存的申请、按字节搬移式扩容、释放，以及把不再使用的页还给系统
+//默认后端使用 malloc / realloc / free；mmap_storage.hpp 提供基于匿名 mmap 的大页后端
+struct heap_storage
+{
+    static void* allocate(size_t bytes)
+    {
+        if(bytes == 0)
+        {
+            return nullptr;
+        }
+        void* p = std::malloc(bytes);
+        if(p == nullptr)
+        {
+            throw std::bad_alloc();
+        }
+        return p;
+    }
+
+    //只用于可平凡重定位的元素：realloc 能原地延长时不需要任何拷贝，
+    //glibc 对 mmap 出来的大块会走 mremap，只改页表而不拷贝数据
+    static void* reallocate(void* p, size_t, size_t new_bytes)
+    {
+        void* new_p = std::realloc(p, new_bytes);
+        if(new_p == nullptr)
+        {
+            throw std::bad_alloc();
+        }
+        return new_p;
+    }
+
+    static void deallocate(void* p, size_t)
+    {
+        std::free(p);
+    }
+
+    //malloc 分配的块可能比申请的大
+    static size_t usable_size(void* p, size_t bytes)
+    {
+#if defined(__GLIBC__)
+        if(p != nullptr)
+        {
+            return std::max(bytes, malloc_usable_size(p));
+        }
+#endif
+        (void)p;
+        return bytes;
+    }
+
+    //[used_bytes, bytes) 部分已不再存放元素
+    static void release_unused(void*, size_t, size_t) {}
+};
+
+//按 ALIGN 字节对齐的堆内存，供需要对齐 SIMD 加载的列式数组使用
+//aligned_alloc 没有对应的 realloc，扩容总是申请新块后拷贝
+template <size_t ALIGN>
+struct aligned_heap_storage
+{
+    static_assert(ALIGN >= sizeof(void*) && (ALIGN & (ALIGN - 1)) == 0,
+                  "aligned_heap_storage: 对齐必须是 2 的幂");
+
+    static void* allocate(size_t bytes)
+    {
+        if(bytes == 0)
+        {
+            return nullptr;
+        }
+        void* p = std::aligned_alloc(ALIGN, (bytes + ALIGN - 1) / ALIGN * ALIGN);
+        if(p == nullptr)
+        {
+            throw std::bad_alloc();
+        }
+        return p;
+    }
+
+    static void* reallocate(void* p, size_t old_bytes, size_t new_bytes)
+    {
+        void* new_p = allocate(new_bytes);
+        if(p != nullptr)
+        {
+            std::memcpy(new_p, p, std::min(old_bytes, new_bytes));
+            std::free(p);
+        }
+        return new_p;
+    }
+
+    static void deallocate(void* p, size_t)
+    {
+        std::free(p);
+    }
+
+    static size_t usable_size(void*, size_t bytes) { return bytes; }
+    static void release_unused(void*, size_t, size_t) {}
+};
+
+template <class T, class GrowthPolicy = growth_double, class Storage = heap_storage>
 class vector
 {
 private:
@@ -11,6 +172,9 @@ private:
     size_t m_size = 0;
     size_t m_capacity = 0;
 
+    //可平凡重定位的类型扩容时交给 Storage::reallocate 按字节搬移（常常可以原地延长）
+    static const bool RELOCATABLE = is_trivially_relocatable<T>::value;
+
 public:
 
     //构造
@@ -25,10 +189,11 @@ public:
     //析构函数
     ~vector();
     //赋值
-    vector<T>& operator=(const vector & other);
+    vector& operator=(const vector & other);
     
     //尾插和尾删
     void push_back(const T&val);
+    void push_back(T&& val);
     void pop_back();
 
     //容量和大小
@@ -36,6 +201,13 @@ public:
     size_t capacity() const { return m_capacity; };
     size_t size() const { return m_size; };
     void resize(size_t size);
+    //不做值初始化的扩容：新元素默认初始化，对平凡类型即保持未初始化，
+    //供 read()、解压等直接写入缓冲区的场景使用
+    void resize_default_init(size_t size);
+    void resize_uninitialized(size_t size);
+    //在尾部预留 n 个元素的空间交给 f(T* dst, size_t n) 填充，f 返回实际写入的个数，只提交这部分
+    template <class F>
+    size_t append_with(size_t n, F f);
 
     //插入和删除
     void insert(T * insert_begin_ptr , const T&val );
@@ -54,11 +226,16 @@ public:
     T& front();
     T& back();
 
+    T* data() { return m_data; }
+    const T* data() const { return m_data; }
+
     //互换容器
     void swap(vector & v);
 
     //预留空间
     void reserve(size_t size);
+    //把容量收缩到 size()，多余的内存还给系统
+    void shrink_to_fit();
 
     // 迭代器
     T* begin() { return m_data; }
@@ -66,13 +243,47 @@ public:
     T* end() { return m_data + m_size; }
     const T* end() const { return m_data + m_size; }
 
+private:
+    //内存管理辅助函数
+    static T* allocate(size_t n) {
+        T* p = static_cast<T*>(Storage::allocate(n * sizeof(T)));
+        if (p) {
+            STL_INSTRUMENT_EVENT(vector, on_allocate(n * sizeof(T)));
+        }
+        return p;
+    }
+    static void deallocate(T* p, size_t n) {
+        if (p) {
+            STL_INSTRUMENT_EVENT(vector, on_free(n * sizeof(T)));
+        }
+        Storage::deallocate(p, n * sizeof(T));
+    }
+    //插桩：按字节重新分配记作一次释放加一次分配
+    void note_reallocate(size_t old_capacity) const {
+        if (old_capacity != 0) {
+            STL_INSTRUMENT_EVENT(vector, on_free(old_capacity * sizeof(T)));
+        }
+        STL_INSTRUMENT_EVENT(vector, on_allocate(m_capacity * sizeof(T)));
+    }
+    //实际可用的容量（分配的块可能比申请的大）
+    static size_t usable_capacity(T* p, size_t requested) {
+        return Storage::usable_size(p, requested * sizeof(T)) / sizeof(T);
+    }
+    //把 [m_size, m_capacity) 对应的整页还给系统
+    void release_tail() {
+        Storage::release_unused(m_data, m_size * sizeof(T), m_capacity * sizeof(T));
+    }
+    size_t next_capacity(size_t required) const {
+        return GrowthPolicy::next_capacity(m_capacity, required, sizeof(T));
+    }
+
 };
 
 
 //构造
-template <typename T>
-vector<T>::vector (size_t n):
- m_data(static_cast<T*>(::operator new(n * sizeof(T)))), 
+template <class T, class GrowthPolicy, class Storage>
+vector<T, GrowthPolicy, Storage>::vector (size_t n):
+ m_data(allocate(n)), 
  m_size(0), 
  m_capacity(n) 
 {
@@ -80,11 +291,11 @@ vector<T>::vector (size_t n):
 }
 
 //有参构造
-template <typename T>
-vector<T>::vector (size_t n,const T& val ):
- m_data(static_cast<T*>(::operator new(n * sizeof(T)))), 
+template <class T, class GrowthPolicy, class Storage>
+vector<T, GrowthPolicy, Storage>::vector (size_t n,const T& val ):
+ m_data(allocate(n)), 
  m_size(n), 
- m_capacity(2*n) 
+ m_capacity(n) 
 {
     for (size_t i = 0; i < n; ++i) {
         new (m_data + i) T(val); 
@@ -92,11 +303,11 @@ vector<T>::vector (size_t n,const T& val ):
 }
 
 //拷贝构造
-template<typename T>
-vector<T>::vector (const vector & other)
-: m_data(static_cast<T*>(::operator new(other.m_size* sizeof(T)))),
+template <class T, class GrowthPolicy, class Storage>
+vector<T, GrowthPolicy, Storage>::vector (const vector & other)
+: m_data(allocate(other.m_size)),
  m_size(other.m_size),
- m_capacity(other.m_capacity)
+ m_capacity(other.m_size)
 {
     for(size_t i = 0; i < other.m_size; ++i)
     {
@@ -104,18 +315,20 @@ vector<T>::vector (const vector & other)
     }
 }
 //析构函数(待验证)
-template<class T>
-vector <T>::~vector()
+template <class T, class GrowthPolicy, class Storage>
+vector<T, GrowthPolicy, Storage>::~vector()
 {
-    ::operator delete(m_data);
+    STL_INSTRUMENT_EVENT(vector, on_retire(m_size * sizeof(T), m_capacity * sizeof(T)));
+    clear();
+    deallocate(m_data, m_capacity);
     m_data = nullptr;
     m_size = 0;
     m_capacity = 0;
 }
 
 //赋值：重载“=”
-template<typename T>
-vector<T>& vector<T>::operator=(const vector & other)
+template <class T, class GrowthPolicy, class Storage>
+vector<T, GrowthPolicy, Storage>& vector<T, GrowthPolicy, Storage>::operator=(const vector & other)
 {
     if (this == &other) {
         return *this;
@@ -128,21 +341,32 @@ vector<T>& vector<T>::operator=(const vector & other)
 }
 
 //尾插
-template<class T>
-void vector<T>:: push_back(const T&val)
+template <class T, class GrowthPolicy, class Storage>
+void vector<T, GrowthPolicy, Storage>:: push_back(const T&val)
 {
     if(m_size == m_capacity)
     {
-        size_t new_capacity = (m_capacity==0)? 1 : m_capacity*2;
-        reserve(new_capacity);
+        reserve(next_capacity(m_size + 1));
     }
     new (m_data+m_size) T(val);
 
     m_size++;
 }
+
+template <class T, class GrowthPolicy, class Storage>
+void vector<T, GrowthPolicy, Storage>:: push_back(T&& val)
+{
+    if(m_size == m_capacity)
+    {
+        reserve(next_capacity(m_size + 1));
+    }
+    new (m_data+m_size) T(std::move(val));
+
+    m_size++;
+}
 //尾删
-template<class T>
-void vector<T>:: pop_back()
+template <class T, class GrowthPolicy, class Storage>
+void vector<T, GrowthPolicy, Storage>:: pop_back()
 {
     if(m_size == 0)
     {
@@ -153,24 +377,14 @@ void vector<T>:: pop_back()
 }    
 
 //重新设置大小
-template<typename T>
-void vector<T>::resize(size_t n) 
+template <class T, class GrowthPolicy, class Storage>
+void vector<T, GrowthPolicy, Storage>::resize(size_t n) 
 {
     if(m_size<n)
     {
         if(m_capacity < n)
         {
-            size_t new_capacity = std::max(n, m_capacity * 2);
-            T*new_data = static_cast<T*>(::operator new(new_capacity* sizeof(T)));
-            for(size_t i=0; i < m_size; ++i )
-            {
-                new(new_data+i) T(std::move(m_data[i])); 
-                m_data[i].~T();
-            }
-
-            ::operator delete (m_data);
-            m_data=new_data;
-            m_capacity = new_capacity;
+            reserve(next_capacity(n));
         }
         
         size_t addNum = n-m_size;
@@ -189,12 +403,67 @@ void vector<T>::resize(size_t n)
             m_data[i].~T();
        }
        m_size =n; 
+       release_tail();
     }
 }
 
+//不做值初始化的扩容
+template <class T, class GrowthPolicy, class Storage>
+void vector<T, GrowthPolicy, Storage>::resize_default_init(size_t n)
+{
+    if(n <= m_size)
+    {
+        resize(n);
+        return;
+    }
+    if(m_capacity < n)
+    {
+        reserve(next_capacity(n));
+    }
+    for(size_t i = m_size; i < n; ++i)
+    {
+        new(m_data + i) T;
+    }
+    m_size = n;
+}
+
+template <class T, class GrowthPolicy, class Storage>
+void vector<T, GrowthPolicy, Storage>::resize_uninitialized(size_t n)
+{
+    static_assert(std::is_trivially_default_constructible<T>::value &&
+                  std::is_trivially_destructible<T>::value,
+                  "vector::resize_uninitialized: 只支持平凡类型");
+    if(m_capacity < n)
+    {
+        reserve(next_capacity(n));
+    }
+    m_size = n;
+}
+
+//回调式追加
+template <class T, class GrowthPolicy, class Storage>
+template <class F>
+size_t vector<T, GrowthPolicy, Storage>::append_with(size_t n, F f)
+{
+    static_assert(std::is_trivially_default_constructible<T>::value &&
+                  std::is_trivially_destructible<T>::value,
+                  "vector::append_with: 只支持平凡类型");
+    if(m_capacity - m_size < n)
+    {
+        reserve(next_capacity(m_size + n));
+    }
+    size_t filled = f(m_data + m_size, n);
+    if(filled > n)
+    {
+        throw std::length_error("vector::append_with: callback wrote more than requested");
+    }
+    m_size += filled;
+    return filled;
+}
+
 //插入元素
-template<class T>
-void vector<T>::insert(T * insert_begin_ptr , const T&val)
+template <class T, class GrowthPolicy, class Storage>
+void vector<T, GrowthPolicy, Storage>::insert(T * insert_begin_ptr , const T&val)
 {
     if (insert_begin_ptr < m_data || insert_begin_ptr > m_data + m_size) {
 
@@ -204,8 +473,20 @@ void vector<T>::insert(T * insert_begin_ptr , const T&val)
     
     if(m_size==m_capacity)
     {
-        size_t new_capacity = (m_capacity == 0) ? 1 : m_capacity * 2;
-        T*new_data = static_cast<T*>(::operator new(new_capacity* sizeof(T)));
+        if(RELOCATABLE)
+        {
+            //先原地扩容，再整体后移
+            T copy(val);
+            reserve(next_capacity(m_size + 1));
+            std::memmove(static_cast<void*>(m_data + insert_pos + 1), m_data + insert_pos,
+                         (m_size - insert_pos) * sizeof(T));
+            new(m_data + insert_pos)T(std::move(copy));
+            m_size++;
+            return;
+        }
+        size_t new_capacity = next_capacity(m_size + 1);
+        STL_INSTRUMENT_EVENT(vector, on_grow(m_size));
+        T*new_data = allocate(new_capacity);
         for (size_t i = 0; i < insert_pos; ++i) {
             new (new_data + i) T(std::move(m_data[i]));
             m_data[i].~T(); // 析构原元素
@@ -216,7 +497,7 @@ void vector<T>::insert(T * insert_begin_ptr , const T&val)
             new(new_data+i+1) T(std::move(m_data[i]));
             m_data[i].~T();
         }
-        ::operator delete(m_data);
+        deallocate(m_data, m_capacity);
         m_data = new_data;
         m_capacity = new_capacity;
 
@@ -234,8 +515,8 @@ void vector<T>::insert(T * insert_begin_ptr , const T&val)
 }
 
 //删除指定位置的一个元素；
-template <class T>
-T* vector<T>::erase(T * erase_ptr )
+template <class T, class GrowthPolicy, class Storage>
+T* vector<T, GrowthPolicy, Storage>::erase(T * erase_ptr )
 {
     size_t erase_pos = erase_ptr-m_data;
     if(m_size==0||erase_ptr<m_data||erase_ptr>=m_data+m_size)
@@ -258,8 +539,8 @@ T* vector<T>::erase(T * erase_ptr )
 }
 
 //删除指定范围的元素；
-template <class T>
-T* vector<T>::erase(T* erase_begin_ptr, T* erase_end_ptr)
+template <class T, class GrowthPolicy, class Storage>
+T* vector<T, GrowthPolicy, Storage>::erase(T* erase_begin_ptr, T* erase_end_ptr)
 {
     size_t erase_begin_pos =erase_begin_ptr-m_data;
     size_t erase_end_pos =erase_end_ptr-m_data;
@@ -285,32 +566,35 @@ T* vector<T>::erase(T* erase_begin_ptr, T* erase_end_ptr)
 }
 
 //清空元素
-template<class T>
-void vector<T>::clear()
+template <class T, class GrowthPolicy, class Storage>
+void vector<T, GrowthPolicy, Storage>::clear()
 {
     for(size_t i=0; i<m_size; ++i)
     {
         m_data[i].~T();
     }
     m_size = 0;
+    release_tail();
 }
 
 //读取数据，重载[]
-template<class T>
-T & vector<T>::operator[](size_t index)
+template <class T, class GrowthPolicy, class Storage>
+T & vector<T, GrowthPolicy, Storage>::operator[](size_t index)
 {
+    STL_ACCESS_CHECK(index < m_size, "vector::operator[]: index out of range");
     return m_data[index];
 }
 
-template<class T>
-const T & vector<T>::operator[](size_t index)const
+template <class T, class GrowthPolicy, class Storage>
+const T & vector<T, GrowthPolicy, Storage>::operator[](size_t index)const
 {
+    STL_ACCESS_CHECK(index < m_size, "vector::operator[]: index out of range");
     return m_data[index];
 }
 
 //at()
-template<class T>
-const T & vector<T>:: at(size_t index) const
+template <class T, class GrowthPolicy, class Storage>
+const T & vector<T, GrowthPolicy, Storage>:: at(size_t index) const
 {
     if(index>=m_size||index<0)
     {
@@ -319,8 +603,8 @@ const T & vector<T>:: at(size_t index) const
     return m_data[index];
 }
 
-template<class T>
-T& vector<T>::at(size_t index)
+template <class T, class GrowthPolicy, class Storage>
+T& vector<T, GrowthPolicy, Storage>::at(size_t index)
 {
     if (index >= m_size) {
         throw std::out_of_range("vector::at: index out of range");
@@ -328,61 +612,64 @@ T& vector<T>::at(size_t index)
     return m_data[index];
 }
 
-template<class T>
-const T & vector<T>:: front() const
+template <class T, class GrowthPolicy, class Storage>
+const T & vector<T, GrowthPolicy, Storage>:: front() const
 {
-    if (m_size == 0) {
-        throw std::out_of_range("vector::front(): empty container");
-    }
+    STL_ACCESS_CHECK(m_size != 0, "vector::front(): empty container");
     return m_data[0];
 }
-template<class T>
-const T & vector<T>::back() const
+template <class T, class GrowthPolicy, class Storage>
+const T & vector<T, GrowthPolicy, Storage>::back() const
 {
-    if (m_size == 0) {
-        throw std::out_of_range("vector::back(): empty container");
-    }
+    STL_ACCESS_CHECK(m_size != 0, "vector::back(): empty container");
     return m_data[m_size-1];
 }
 
-template<class T>
-T& vector<T>:: front()
+template <class T, class GrowthPolicy, class Storage>
+T& vector<T, GrowthPolicy, Storage>:: front()
 {
-    if (m_size == 0) {
-        throw std::out_of_range("vector::front(): empty container");
-    }
+    STL_ACCESS_CHECK(m_size != 0, "vector::front(): empty container");
     return m_data[0];
 }
-template<class T>
-T& vector<T>::back()
+template <class T, class GrowthPolicy, class Storage>
+T& vector<T, GrowthPolicy, Storage>::back()
 {   
-    if (m_size == 0) {
-        throw std::out_of_range("vector::back(): empty container");
-    }
+    STL_ACCESS_CHECK(m_size != 0, "vector::back(): empty container");
     return m_data[m_size-1];
 }
 
-template<class T>
-void vector<T>::swap(vector & v)
+template <class T, class GrowthPolicy, class Storage>
+void vector<T, GrowthPolicy, Storage>::swap(vector & v)
 {
-    vector temp(v);
-    //判断两容器的大小，如果大小不够应该对容器进行扩容
-    //完成容器的互换
+    //只交换指针和计数，不拷贝元素
     std::swap(m_data, v.m_data);
     std::swap(m_size, v.m_size);
     std::swap(m_capacity, v.m_capacity);
 
 }
 
-template<class T>
-void vector<T>::reserve(size_t new_capacity)
+template <class T, class GrowthPolicy, class Storage>
+void vector<T, GrowthPolicy, Storage>::reserve(size_t new_capacity)
 {
     if(new_capacity<=m_capacity)
     {
         return ;
     }
 
-    T*new_data = static_cast<T*>(::operator new(new_capacity*sizeof(T)));
+    //可平凡重定位：由存储后端按字节搬移，能原地延长时不需要任何拷贝
+    if(RELOCATABLE)
+    {
+        size_t old_capacity = m_capacity;
+        m_data = static_cast<T*>(Storage::reallocate(m_data, m_capacity * sizeof(T),
+                                                     new_capacity * sizeof(T)));
+        m_capacity = usable_capacity(m_data, new_capacity);
+        STL_INSTRUMENT_EVENT(vector, on_grow(0));
+        note_reallocate(old_capacity);
+        return;
+    }
+
+    STL_INSTRUMENT_EVENT(vector, on_grow(m_size));
+    T*new_data = allocate(new_capacity);
     size_t constructed = 0;
     try{
         for(size_t i = 0; i < m_size; ++i){
@@ -394,14 +681,47 @@ void vector<T>::reserve(size_t new_capacity)
         {
             new_data[i].~T();
         }
-        ::operator delete(new_data);
+        deallocate(new_data, new_capacity);
         throw;
     }
     
     for(size_t i = 0;i<m_size;i++){
         m_data[i].~T();
     }
-    ::operator delete(m_data);
+    deallocate(m_data, m_capacity);
     m_data = new_data;
     m_capacity = new_capacity;
-}
\ No newline at end of file
+}
+
+//收缩容量
+template <class T, class GrowthPolicy, class Storage>
+void vector<T, GrowthPolicy, Storage>::shrink_to_fit()
+{
+    if(m_size == m_capacity)
+    {
+        return;
+    }
+    if(m_size == 0)
+    {
+        deallocate(m_data, m_capacity);
+        m_data = nullptr;
+        m_capacity = 0;
+        return;
+    }
+    if(RELOCATABLE)
+    {
+        size_t old_capacity = m_capacity;
+        m_data = static_cast<T*>(Storage::reallocate(m_data, m_capacity * sizeof(T),
+                                                     m_size * sizeof(T)));
+        m_capacity = m_size;
+        note_reallocate(old_capacity);
+        return;
+    }
+    vector temp;
+    temp.reserve(m_size);
+    for(size_t i = 0; i < m_size; ++i)
+    {
+        temp.push_back(std::move(m_data[i]));
+    }
+    swap(temp);
+}
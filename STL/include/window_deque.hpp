@@ -0,0 +1,346 @@
+#pragma once
+#include<iostream>
+#include <stdexcept>
+#include <algorithm>
+#include <chrono>
+#include <utility>
+#include "deque.hpp"
+
+// 滑动窗口：尾部进、头部出，随时 O(1) 查询窗口内所有元素的聚合值（最小、最大、和，或任意满足结合律的运算）。
+// 采用“双栈”聚合：元素按顺序存在 deque 里，逻辑上分成前后两段——
+//   - 后段只记录一个累积值 m_back = 后段所有元素按顺序合并的结果，push_back 时 O(1) 更新；
+//   - 前段为每个位置保存后缀聚合 m_front[i] = 前段 [i, 末尾] 的合并结果，pop_front 时直接丢掉一个；
+//   - 前段弹空时把后段整体翻转成前段，从后往前重算一遍后缀聚合。每个元素只会被翻转一次，
+//     所以 push / pop 均摊 O(1)，查询是 combine(m_front.front(), m_back)。
+// 只要求 combine 满足结合律，不要求交换律，也不要求可逆（所以 min / max 也适用）。
+//     window_deque<double, window_stats<double>> latency(1000);   //只保留最近 1000 个样本
+//     latency.push_back(x);
+//     auto s = latency.aggregate();   //s.min, s.max, s.sum, s.count
+// Agg 需要提供：
+//     typedef ... value_type;                                          //聚合值类型，需可默认构造
+//     static value_type lift(const T& x);                              //单个元素的聚合值
+//     static value_type combine(const value_type& a, const value_type& b);   //a 在前，b 在后
+// 元素只能只读访问：原地修改会让已缓存的聚合值失效。
+
+//常用聚合
+template <class T>
+struct window_sum
+{
+    typedef T value_type;
+    static value_type lift(const T& x) { return x; }
+    static value_type combine(const value_type& a, const value_type& b) { return a + b; }
+};
+
+template <class T>
+struct window_min
+{
+    typedef T value_type;
+    static value_type lift(const T& x) { return x; }
+    static value_type combine(const value_type& a, const value_type& b) { return b < a ? b : a; }
+};
+
+template <class T>
+struct window_max
+{
+    typedef T value_type;
+    static value_type lift(const T& x) { return x; }
+    static value_type combine(const value_type& a, const value_type& b) { return a < b ? b : a; }
+};
+
+//一次得到最小、最大、和与个数
+template <class T>
+struct window_stats
+{
+    struct value_type
+    {
+        T min = T();
+        T max = T();
+        T sum = T();
+        size_t count = 0;
+    };
+    static value_type lift(const T& x)
+    {
+        value_type v;
+        v.min = x;
+        v.max = x;
+        v.sum = x;
+        v.count = 1;
+        return v;
+    }
+    static value_type combine(const value_type& a, const value_type& b)
+    {
+        value_type v;
+        v.min = b.min < a.min ? b.min : a.min;
+        v.max = a.max < b.max ? b.max : a.max;
+        v.sum = a.sum + b.sum;
+        v.count = a.count + b.count;
+        return v;
+    }
+};
+
+
+template <class T, class Agg>
+class window_deque
+{
+public:
+    typedef typename Agg::value_type aggregate_type;
+    typedef typename deque<T>::const_iterator const_iterator;
+
+private:
+    deque<T> m_items;                   //窗口内的元素，按进入顺序
+    deque<aggregate_type> m_front;      //前段每个位置的后缀聚合，前段长度 = m_front.size()
+    aggregate_type m_back = aggregate_type();   //后段的聚合，后段为空时无意义
+    size_t m_capacity;                  //按个数限制的窗口大小，0 表示不限
+
+public:
+    //capacity：窗口最多保留的元素个数，超过时 push_back 自动弹出最早的元素；0 表示不限
+    explicit window_deque(size_t capacity = 0) : m_capacity(capacity) {}
+
+    //尾部进入，头部离开
+    void push_back(const T& val);
+    void push_back(T&& val);
+    void pop_front();
+    //从头部依次弹出满足 pred(front()) 的元素，返回弹出个数
+    template <class Pred>
+    size_t evict_while(Pred pred);
+    void clear();
+
+    //整个窗口的聚合值，窗口为空时抛出 out_of_range
+    aggregate_type aggregate() const;
+
+    //大小
+    bool empty() const { return m_items.empty(); }
+    size_t size() const { return m_items.size(); }
+    size_t capacity() const { return m_capacity; }
+    //调小容量时立即弹出多余的最早元素
+    void set_capacity(size_t capacity);
+
+    //只读访问
+    const T& front() const { return m_items.front(); }
+    const T& back() const { return m_items.back(); }
+    const T& operator[](size_t index) const { return m_items[index]; }
+    const_iterator begin() const { return m_items.begin(); }
+    const_iterator end() const { return m_items.end(); }
+
+    void swap(window_deque& other) noexcept;
+
+private:
+    size_t back_count() const { return m_items.size() - m_front.size(); }
+    //加入一个元素后的后段聚合；先算好再改容器，combine 抛异常时对象不变
+    aggregate_type extend_back(const T& val) const;
+    void trim_to_capacity();
+    //前段为空时把后段翻转成前段
+    void flip();
+};
+
+
+template <class T, class Agg>
+typename window_deque<T, Agg>::aggregate_type window_deque<T, Agg>::extend_back(const T& val) const
+{
+    if (back_count() == 0) {
+        return Agg::lift(val);
+    }
+    return Agg::combine(m_back, Agg::lift(val));
+}
+
+template <class T, class Agg>
+void window_deque<T, Agg>::push_back(const T& val)
+{
+    aggregate_type back = extend_back(val);
+    m_items.push_back(val);
+    m_back = std::move(back);
+    trim_to_capacity();
+}
+
+template <class T, class Agg>
+void window_deque<T, Agg>::push_back(T&& val)
+{
+    aggregate_type back = extend_back(val);
+    m_items.push_back(std::move(val));
+    m_back = std::move(back);
+    trim_to_capacity();
+}
+
+template <class T, class Agg>
+void window_deque<T, Agg>::pop_front()
+{
+    if (m_items.empty()) {
+        throw std::out_of_range("window_deque::pop_front: window is empty");
+    }
+    if (m_front.empty()) {
+        flip();
+    }
+    m_items.pop_front();
+    m_front.pop_front();
+}
+
+template <class T, class Agg>
+template <class Pred>
+size_t window_deque<T, Agg>::evict_while(Pred pred)
+{
+    size_t evicted = 0;
+    while (!m_items.empty() && pred(m_items.front())) {
+        pop_front();
+        ++evicted;
+    }
+    return evicted;
+}
+
+template <class T, class Agg>
+void window_deque<T, Agg>::clear()
+{
+    m_items.clear();
+    m_front.clear();
+}
+
+template <class T, class Agg>
+typename window_deque<T, Agg>::aggregate_type window_deque<T, Agg>::aggregate() const
+{
+    if (m_items.empty()) {
+        throw std::out_of_range("window_deque::aggregate: window is empty");
+    }
+    if (m_front.empty()) {
+        return m_back;
+    }
+    if (back_count() == 0) {
+        return m_front.front();
+    }
+    return Agg::combine(m_front.front(), m_back);
+}
+
+template <class T, class Agg>
+void window_deque<T, Agg>::set_capacity(size_t capacity)
+{
+    m_capacity = capacity;
+    trim_to_capacity();
+}
+
+template <class T, class Agg>
+void window_deque<T, Agg>::swap(window_deque& other) noexcept
+{
+    m_items.swap(other.m_items);
+    m_front.swap(other.m_front);
+    std::swap(m_back, other.m_back);
+    std::swap(m_capacity, other.m_capacity);
+}
+
+template <class T, class Agg>
+void window_deque<T, Agg>::trim_to_capacity()
+{
+    while (m_capacity != 0 && m_items.size() > m_capacity) {
+        pop_front();
+    }
+}
+
+template <class T, class Agg>
+void window_deque<T, Agg>::flip()
+{
+    //先在临时 deque 里算好，combine 抛异常时对象不变
+    deque<aggregate_type> front;
+    size_t n = m_items.size();
+    for (size_t i = n; i-- > 0;) {
+        if (i + 1 == n) {
+            front.push_front(Agg::lift(m_items[i]));
+        } else {
+            front.push_front(Agg::combine(Agg::lift(m_items[i]), front.front()));
+        }
+    }
+    m_front.swap(front);
+}
+
+
+// 按时间淘汰的窗口：只保留时间戳在 (now - horizon, now] 内的样本，可以同时限制个数。
+// 时间戳必须单调不减（默认用 Clock::now()）。每次 push 和查询都会先淘汰过期样本，
+// 均摊 O(1)；中间长时间没有调用时，第一次调用要一次性淘汰积压的过期样本。
+//     timed_window<double, window_max<double>> peak(std::chrono::seconds(10));
+//     peak.push(x);
+//     double m = peak.aggregate();   //最近 10 秒内的最大值
+template <class T, class Agg, class Clock = std::chrono::steady_clock>
+class timed_window
+{
+public:
+    typedef typename Agg::value_type aggregate_type;
+    typedef typename Clock::time_point time_point;
+    typedef typename Clock::duration duration;
+
+private:
+    window_deque<T, Agg> m_window;
+    deque<time_point> m_times;          //与 m_window 中的元素一一对应
+    duration m_horizon;
+    size_t m_capacity;
+
+public:
+    //capacity：最多保留的样本个数，0 表示不限
+    explicit timed_window(duration horizon, size_t capacity = 0);
+
+    //加入时间戳为 now 的样本，并淘汰过期（以及超出个数）的样本
+    void push(const T& val, time_point now = Clock::now());
+    //淘汰时间戳 <= now - horizon 的样本，返回淘汰个数
+    size_t expire(time_point now = Clock::now());
+    void clear();
+
+    //先按 now 淘汰，再返回剩余样本的聚合值；没有样本时抛出 out_of_range
+    aggregate_type aggregate(time_point now = Clock::now());
+    //不淘汰，直接返回当前样本的聚合值
+    aggregate_type aggregate_unexpired() const { return m_window.aggregate(); }
+
+    bool empty() const { return m_window.empty(); }
+    size_t size() const { return m_window.size(); }
+    duration horizon() const { return m_horizon; }
+    const window_deque<T, Agg>& window() const { return m_window; }
+};
+
+template <class T, class Agg, class Clock>
+timed_window<T, Agg, Clock>::timed_window(duration horizon, size_t capacity)
+: m_horizon(horizon), m_capacity(capacity)
+{
+    if (horizon <= duration::zero()) {
+        throw std::invalid_argument("timed_window: horizon must be positive");
+    }
+}
+
+template <class T, class Agg, class Clock>
+void timed_window<T, Agg, Clock>::push(const T& val, time_point now)
+{
+    if (!m_times.empty() && now < m_times.back()) {
+        throw std::invalid_argument("timed_window::push: timestamps must not go backwards");
+    }
+    expire(now);
+    if (m_capacity != 0 && m_window.size() == m_capacity) {
+        m_window.pop_front();
+        m_times.pop_front();
+    }
+    m_times.push_back(now);
+    try {
+        m_window.push_back(val);
+    } catch (...) {
+        m_times.pop_back();
+        throw;
+    }
+}
+
+template <class T, class Agg, class Clock>
+size_t timed_window<T, Agg, Clock>::expire(time_point now)
+{
+    size_t expired = 0;
+    while (!m_times.empty() && m_times.front() <= now - m_horizon) {
+        m_window.pop_front();
+        m_times.pop_front();
+        ++expired;
+    }
+    return expired;
+}
+
+template <class T, class Agg, class Clock>
+void timed_window<T, Agg, Clock>::clear()
+{
+    m_window.clear();
+    m_times.clear();
+}
+
+template <class T, class Agg, class Clock>
+typename timed_window<T, Agg, Clock>::aggregate_type timed_window<T, Agg, Clock>::aggregate(time_point now)
+{
+    expire(now);
+    return m_window.aggregate();
+}
@@ -0,0 +1,323 @@
+#include <iostream>
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <map>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include "vector.hpp"
+#include "deque.hpp"
+#include "queue.hpp"
+#include "small_vector.hpp"
+#include "static_vector.hpp"
+#include "mapped_vector.hpp"
+#include "concurrent_vector.hpp"
+#include "byte_buffer.hpp"
+#include "test_check.hpp"
+
+// 其余容器的行为检查：priority_queue / indexed_priority_queue、small_vector、static_vector、
+// mapped_vector、concurrent_vector、byte_buffer，各自与标准库模型或已知结果对照。
+
+//priority_queue 的出队顺序等于排序结果
+static void test_priority_queue()
+{
+    std::mt19937 rng(1);
+    priority_queue<int> max_heap;
+    priority_queue<int, std::greater<int>, 2> min_heap;
+    std::vector<int> ref;
+    for (int i = 0; i < 5000; ++i) {
+        int v = static_cast<int>(rng() % 1000);
+        max_heap.push(v);
+        min_heap.push(v);
+        ref.push_back(v);
+    }
+    std::vector<int> sorted = ref;
+    std::sort(sorted.begin(), sorted.end());
+    for (size_t i = 0; i < sorted.size(); ++i) {
+        TEST_CHECK(max_heap.top() == sorted[sorted.size() - 1 - i]);
+        TEST_CHECK(min_heap.top() == sorted[i]);
+        max_heap.pop();
+        min_heap.pop();
+    }
+    TEST_CHECK(max_heap.empty() && min_heap.empty());
+
+    priority_queue<int> built(ref.begin(), ref.end());
+    TEST_CHECK(built.size() == ref.size() && built.top() == sorted.back());
+}
+
+//indexed_priority_queue：update / erase 之后与 std::multimap 模型一致
+static void test_indexed_priority_queue()
+{
+    std::mt19937 rng(2);
+    indexed_priority_queue<int, std::greater<int> > q;
+    std::map<size_t, int> live;   //handle -> 优先级
+    for (int step = 0; step < 20000; ++step) {
+        int op = rng() % 10;
+        if (op < 4 || live.empty()) {
+            int v = static_cast<int>(rng() % 10000);
+            size_t h = q.push(v);
+            TEST_CHECK(live.find(h) == live.end());
+            live[h] = v;
+        } else if (op < 6) {
+            auto it = std::next(live.begin(), rng() % live.size());
+            int v = static_cast<int>(rng() % 10000);
+            q.update(it->first, v);
+            it->second = v;
+        } else if (op < 8) {
+            auto it = std::next(live.begin(), rng() % live.size());
+            q.erase(it->first);
+            TEST_CHECK(!q.contains(it->first));
+            live.erase(it);
+        } else {
+            int best = live.begin()->second;
+            for (auto& kv : live) {
+                best = std::min(best, kv.second);
+            }
+            TEST_CHECK(q.top() == best);
+            size_t h = q.top_handle();
+            TEST_CHECK(live.at(h) == best && q.get(h) == best);
+            q.pop();
+            live.erase(h);
+        }
+        TEST_CHECK(q.size() == live.size());
+    }
+}
+
+//small_vector：内联和堆两种模式下都与 std::vector 一致
+static void test_small_vector()
+{
+    std::mt19937 rng(3);
+    small_vector<std::string, 4> v;
+    std::vector<std::string> ref;
+    for (int step = 0; step < 5000; ++step) {
+        std::string s = std::to_string(rng());
+        int op = rng() % 10;
+        if (op < 4) {
+            v.push_back(s);
+            ref.push_back(s);
+        } else if (op < 6) {
+            if (!ref.empty()) {
+                v.pop_back();
+                ref.pop_back();
+            }
+        } else if (op < 7) {
+            size_t pos = rng() % (ref.size() + 1);
+            v.insert(v.begin() + pos, s);
+            ref.insert(ref.begin() + pos, s);
+        } else if (op < 8) {
+            if (!ref.empty()) {
+                size_t pos = rng() % ref.size();
+                v.erase(v.begin() + pos);
+                ref.erase(ref.begin() + pos);
+            }
+        } else if (op < 9) {
+            size_t n = rng() % 12;
+            v.resize(n);
+            ref.resize(n);
+        } else {
+            //拷贝、移动、交换都要覆盖内联和堆两种状态
+            small_vector<std::string, 4> copy(v);
+            small_vector<std::string, 4> other;
+            other.push_back(s);
+            other.swap(copy);
+            v = std::move(other);
+        }
+        TEST_CHECK(v.size() == ref.size());
+        TEST_CHECK(std::equal(v.begin(), v.end(), ref.begin(), ref.end()));
+    }
+    v.clear();
+    TEST_CHECK(v.empty());
+    TEST_THROWS(v.at(0), std::out_of_range);
+}
+
+//编译期构建的查找表
+constexpr static_vector<int, 16> squares()
+{
+    static_vector<int, 16> t;
+    for (int i = 0; i < 10; ++i) {
+        t.push_back(i * i);
+    }
+    t.erase(t.begin() + 3);
+    return t;
+}
+
+static void test_static_vector()
+{
+    constexpr static_vector<int, 16> table = squares();
+    static_assert(table.size() == 9, "static_vector: 编译期 erase 后应剩 9 个");
+    static_assert(table[3] == 16, "static_vector: 编译期下标访问");
+
+    static_vector<std::string, 3> v;
+    v.push_back("a");
+    v.push_back("b");
+    v.insert(v.begin(), "c");
+    TEST_CHECK(v.full() && v[0] == "c" && v[2] == "b");
+    TEST_THROWS(v.push_back("d"), std::length_error);
+    TEST_CHECK(v.size() == 3);
+    static_vector<std::string, 3> moved(std::move(v));
+    TEST_CHECK(moved.size() == 3 && moved[1] == "a");
+    moved.erase(moved.begin(), moved.end());
+    TEST_CHECK(moved.empty());
+}
+
+struct sample
+{
+    uint64_t id;
+    double value;
+};
+
+//mapped_vector：写入、关闭、只读重新打开后内容和校验和一致
+static void test_mapped_vector()
+{
+    const char* tmp = std::getenv("TMPDIR");
+    std::string path = std::string((tmp != nullptr && *tmp != '\0') ? tmp : "/tmp") +
+                       "/stl_mapped_vector_test_" + std::to_string(getpid());
+    {
+        mapped_vector<sample> w(path, mapped_vector<sample>::truncate);
+        for (uint64_t i = 0; i < 10000; ++i) {
+            w.push_back(sample{i, i * 0.5});
+        }
+        w.pop_back();
+        //直接写入元素之后要 mark_dirty，关闭时才会重算校验和
+        w[0].value = -1.0;
+        w.mark_dirty();
+    }
+    {
+        mapped_vector<const sample> r(path, mapped_vector<const sample>::read_only, true);
+        TEST_CHECK(r.size() == 9999 && r.verify());
+        TEST_CHECK(r[0].value == -1.0);
+        for (uint64_t i = 1; i < r.size(); ++i) {
+            TEST_CHECK(r[i].id == i && r[i].value == i * 0.5);
+        }
+        TEST_THROWS(r.at(r.size()), std::out_of_range);
+    }
+    {
+        //只读类型不能以读写模式打开
+        mapped_vector<const sample> r;
+        TEST_THROWS(r.open(path, mapped_vector<const sample>::read_write), std::logic_error);
+    }
+    {
+        mapped_vector<sample> w(path);
+        w.resize(10);
+        w.sync();
+        TEST_CHECK(w.size() == 10 && w.verify());
+    }
+    std::remove(path.c_str());
+}
+
+//concurrent_vector：多线程追加后每个下标恰好出现一次，引用在扩容后仍然有效
+static void test_concurrent_vector()
+{
+    const size_t threads = 4;
+    const size_t per_thread = 50000;
+    concurrent_vector<uint64_t> v;
+    const uint64_t* first = &v[v.push_back(uint64_t(-1))];
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&v, t, per_thread]() {
+            for (size_t i = 0; i < per_thread; ++i) {
+                v.push_back(t * per_thread + i);
+            }
+        });
+    }
+    for (auto& w : workers) {
+        w.join();
+    }
+    TEST_CHECK(v.size() == threads * per_thread + 1);
+    TEST_CHECK(first == &v[0] && *first == uint64_t(-1));
+    std::vector<bool> seen(threads * per_thread);
+    for (size_t i = 1; i < v.size(); ++i) {
+        TEST_CHECK(v.ready(i));
+        TEST_CHECK(!seen[v[i]]);
+        seen[v[i]] = true;
+    }
+    v.clear();
+    TEST_CHECK(v.size() == 0);
+}
+
+//byte_buffer：与 std::string 模型对照，并经管道做一次 writev / readv
+static void test_byte_buffer()
+{
+    std::mt19937 rng(4);
+    byte_buffer<64> buf;
+    std::string ref;
+    for (int step = 0; step < 20000; ++step) {
+        int op = rng() % 10;
+        if (op < 4) {
+            std::string s(rng() % 200, static_cast<char>('a' + rng() % 26));
+            buf.append(s.data(), s.size());
+            ref += s;
+        } else if (op < 6) {
+            //prepare / commit 写入一部分可写区域
+            iovec iov[8];
+            size_t want = rng() % 150;
+            size_t k = buf.prepare(want, iov, 8);
+            size_t left = want;
+            for (size_t i = 0; i < k && left > 0; ++i) {
+                size_t n = std::min(left, iov[i].iov_len);
+                std::fill_n(static_cast<char*>(iov[i].iov_base), n, 'Z');
+                left -= n;
+            }
+            TEST_CHECK(left == 0);
+            buf.commit(want);
+            ref.append(want, 'Z');
+        } else if (op < 8) {
+            size_t n = ref.empty() ? 0 : rng() % (ref.size() + 1);
+            std::string out(n, '\0');
+            TEST_CHECK(buf.read(&out[0], n) == n);
+            TEST_CHECK(out == ref.substr(0, n));
+            ref.erase(0, n);
+        } else if (op < 9) {
+            size_t n = ref.empty() ? 0 : rng() % (ref.size() + 1);
+            buf.consume(n);
+            ref.erase(0, n);
+        } else if (!ref.empty()) {
+            size_t offset = rng() % ref.size();
+            std::string out(ref.size() - offset, '\0');
+            TEST_CHECK(buf.copy_out(&out[0], out.size(), offset) == out.size());
+            TEST_CHECK(out == ref.substr(offset));
+            TEST_CHECK(buf[offset] == ref[offset]);
+        }
+        TEST_CHECK(buf.size() == ref.size());
+    }
+
+    int fds[2];
+    TEST_CHECK(pipe(fds) == 0);
+    std::string payload(3000, 'x');
+    for (size_t i = 0; i < payload.size(); ++i) {
+        payload[i] = static_cast<char>('A' + i % 26);
+    }
+    byte_buffer<64> out;
+    out.append(payload.data(), payload.size());
+    while (!out.empty()) {
+        TEST_CHECK(out.write_to(fds[1]) > 0);
+    }
+    close(fds[1]);
+    byte_buffer<64> in;
+    while (in.read_from(fds[0]) > 0) {
+    }
+    close(fds[0]);
+    std::string got(in.size(), '\0');
+    in.copy_out(&got[0], got.size());
+    TEST_CHECK(got == payload);
+}
+
+
+int main()
+{
+    static const test_case tests[] = {
+        {"priority_queue", test_priority_queue},
+        {"indexed_priority_queue", test_indexed_priority_queue},
+        {"small_vector", test_small_vector},
+        {"static_vector", test_static_vector},
+        {"mapped_vector", test_mapped_vector},
+        {"concurrent_vector", test_concurrent_vector},
+        {"byte_buffer", test_byte_buffer},
+    };
+    return run_tests(tests);
+}
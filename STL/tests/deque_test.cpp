@@ -0,0 +1,317 @@
+#include <iostream>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <random>
+#include <string>
+#include <utility>
+#include "vector.hpp"
+#include "deque.hpp"
+#include "cow_deque.hpp"
+#include "spill_deque.hpp"
+#include "test_check.hpp"
+
+// deque / cow_deque / spill_deque 与 std::deque 对照：随机执行同一串操作，每一步比较大小，
+// 定期比较全部内容。操作次数足够让块指针数组在两端多次扩大、重新居中，块被反复释放和复用。
+
+template <class D>
+static void check_same(const D& d, const std::deque<std::string>& ref)
+{
+    TEST_CHECK(d.size() == ref.size());
+    size_t i = 0;
+    for (auto it = d.begin(); it != d.end(); ++it, ++i) {
+        TEST_CHECK(*it == ref[i]);
+    }
+    TEST_CHECK(i == ref.size());
+}
+
+//带随机操作的模型对照
+template <class Policy>
+static void deque_against_std(unsigned seed)
+{
+    std::mt19937 rng(seed);
+    deque<std::string, Policy> d;
+    std::deque<std::string> ref;
+    for (int step = 0; step < 20000; ++step) {
+        std::string v = std::to_string(rng());
+        int op = rng() % 100;
+        if (op < 25) {
+            d.push_back(v);
+            ref.push_back(v);
+        } else if (op < 45) {
+            d.push_front(v);
+            ref.push_front(v);
+        } else if (op < 57) {
+            if (!ref.empty()) {
+                TEST_CHECK(d.back() == ref.back());
+                d.pop_back();
+                ref.pop_back();
+            }
+        } else if (op < 69) {
+            if (!ref.empty()) {
+                TEST_CHECK(d.front() == ref.front());
+                d.pop_front();
+                ref.pop_front();
+            }
+        } else if (op < 73) {
+            //成批压入，跨越多个块
+            size_t n = rng() % 2000;
+            for (size_t i = 0; i < n; ++i) {
+                d.push_back(v);
+                ref.push_back(v);
+            }
+        } else if (op < 76) {
+            size_t pos = ref.empty() ? 0 : rng() % (ref.size() + 1);
+            d.insert(d.begin() + pos, v);
+            ref.insert(ref.begin() + pos, v);
+        } else if (op < 79) {
+            if (!ref.empty()) {
+                size_t pos = rng() % ref.size();
+                d.erase(d.begin() + pos);
+                ref.erase(ref.begin() + pos);
+            }
+        } else if (op < 81) {
+            size_t n = rng() % 3000;
+            d.resize(n, v);
+            ref.resize(n, v);
+        } else if (op < 83) {
+            d.reserve_front(rng() % 2000);
+            d.reserve_back(rng() % 2000);
+        } else if (op < 85) {
+            d.shrink_to_fit();
+        } else if (op < 86) {
+            d.clear();
+            ref.clear();
+        } else if (op < 88) {
+            //拆开再按原顺序拼回
+            size_t k = ref.empty() ? 0 : rng() % (ref.size() + 1);
+            deque<std::string, Policy> tail = d.split_at(k);
+            TEST_CHECK(d.size() == k && tail.size() == ref.size() - k);
+            if (rng() % 2) {
+                d.splice_back(std::move(tail));
+            } else {
+                tail.splice_front(std::move(d));
+                d = tail;
+            }
+        } else if (op < 90) {
+            deque<std::string, Policy> copy(d);
+            check_same(copy, ref);
+            copy.push_back(v);
+            d = copy;
+            d.pop_back();
+        } else if (!ref.empty()) {
+            size_t i = rng() % ref.size();
+            TEST_CHECK(d[i] == ref[i]);
+            TEST_CHECK(d.at(i) == ref[i]);
+        }
+        TEST_CHECK(d.size() == ref.size());
+        if (step % 1000 == 0) {
+            check_same(d, ref);
+        }
+    }
+    check_same(d, ref);
+    TEST_THROWS(d.at(d.size()), std::out_of_range);
+}
+
+static void test_deque()
+{
+    for (unsigned seed = 1; seed <= 3; ++seed) {
+        deque_against_std<deque_spare_policy<2> >(seed);
+        deque_against_std<deque_spare_policy<0> >(seed);
+        deque_against_std<deque_spare_policy<3, 2> >(seed);
+    }
+}
+
+//可平凡拷贝的元素走按块 memcpy 的路径
+static void test_deque_trivial()
+{
+    std::mt19937 rng(11);
+    deque<uint64_t> d;
+    std::deque<uint64_t> ref;
+    for (int round = 0; round < 200; ++round) {
+        size_t n = rng() % 5000;
+        for (size_t i = 0; i < n; ++i) {
+            uint64_t v = rng();
+            if (v & 1) {
+                d.push_back(v);
+                ref.push_back(v);
+            } else {
+                d.push_front(v);
+                ref.push_front(v);
+            }
+        }
+        deque<uint64_t> copy(d);
+        deque<uint64_t> assigned;
+        assigned = d;
+        TEST_CHECK(copy.size() == ref.size() && assigned.size() == ref.size());
+        for (size_t i = 0; i < ref.size(); ++i) {
+            TEST_CHECK(d[i] == ref[i] && copy[i] == ref[i] && assigned[i] == ref[i]);
+        }
+        size_t drop = ref.empty() ? 0 : rng() % ref.size();
+        for (size_t i = 0; i < drop; ++i) {
+            d.pop_front();
+            ref.pop_front();
+        }
+    }
+}
+
+//快照之间互不影响：修改任何一方都不能改变另一方看到的内容
+static void test_cow_deque()
+{
+    std::mt19937 rng(5);
+    cow_deque<std::string> d;
+    std::deque<std::string> ref;
+    std::vector<std::pair<cow_deque<std::string>, std::deque<std::string> > > snapshots;
+    for (int step = 0; step < 20000; ++step) {
+        std::string v = std::to_string(rng());
+        int op = rng() % 100;
+        if (op < 25) {
+            d.push_back(v);
+            ref.push_back(v);
+        } else if (op < 45) {
+            d.push_front(v);
+            ref.push_front(v);
+        } else if (op < 60) {
+            if (!ref.empty()) {
+                TEST_CHECK(d.back() == ref.back());
+                d.pop_back();
+                ref.pop_back();
+            }
+        } else if (op < 75) {
+            if (!ref.empty()) {
+                TEST_CHECK(d.front() == ref.front());
+                d.pop_front();
+                ref.pop_front();
+            }
+        } else if (op < 80) {
+            size_t n = rng() % 1500;
+            for (size_t i = 0; i < n; ++i) {
+                d.push_back(v);
+                ref.push_back(v);
+            }
+        } else if (op < 85) {
+            if (!ref.empty()) {
+                size_t i = rng() % ref.size();
+                d[i] = v;
+                ref[i] = v;
+            }
+        } else if (op < 88) {
+            snapshots.emplace_back(d, ref);
+            if (snapshots.size() > 4) {
+                snapshots.erase(snapshots.begin());
+            }
+        } else if (op < 91 && !snapshots.empty()) {
+            //修改快照本身，同样不能影响 d
+            auto& s = snapshots[rng() % snapshots.size()];
+            s.first.push_front(v);
+            s.second.push_front(v);
+            s.first[0] = v + "x";
+            s.second[0] = v + "x";
+        } else if (op < 92) {
+            cow_deque<std::string> moved(std::move(d));
+            d.swap(moved);
+        } else if (op < 93) {
+            d.clear();
+            ref.clear();
+        } else if (!ref.empty()) {
+            size_t i = rng() % ref.size();
+            const cow_deque<std::string>& cd = d;
+            TEST_CHECK(cd[i] == ref[i]);
+        }
+        TEST_CHECK(d.size() == ref.size());
+        if (step % 1000 == 0) {
+            check_same(d, ref);
+            for (auto& s : snapshots) {
+                check_same(s.first, s.second);
+            }
+        }
+    }
+    check_same(d, ref);
+    for (auto& s : snapshots) {
+        check_same(s.first, s.second);
+    }
+}
+
+//spill_deque：驻留块数不超过上限，换出的块读回后内容不变
+template <class T>
+static void spill_against_std(unsigned seed, size_t steps)
+{
+    const size_t max_resident = 8;
+    std::mt19937 rng(seed);
+    spill_deque<T> d(max_resident, 1, 2);
+    std::deque<T> ref;
+    const size_t B = spill_deque<T>::BLOCK_SIZE;
+    auto make = [&rng]() {
+        T v{};
+        uint64_t x = rng();
+        std::memcpy(&v, &x, std::min(sizeof(v), sizeof(x)));
+        return v;
+    };
+    auto same = [](const T& a, const T& b) { return std::memcmp(&a, &b, sizeof(T)) == 0; };
+    for (size_t step = 0; step < steps; ++step) {
+        int op = rng() % 10;
+        size_t n = rng() % (3 * B);
+        if (op < 3) {
+            for (size_t i = 0; i < n; ++i) {
+                T v = make();
+                d.push_back(v);
+                ref.push_back(v);
+            }
+        } else if (op < 5) {
+            for (size_t i = 0; i < n; ++i) {
+                T v = make();
+                d.push_front(v);
+                ref.push_front(v);
+            }
+        } else if (op < 7) {
+            for (size_t i = 0; i < n && !ref.empty(); ++i) {
+                TEST_CHECK(same(d.front(), ref.front()));
+                d.pop_front();
+                ref.pop_front();
+            }
+        } else if (op < 9) {
+            for (size_t i = 0; i < n && !ref.empty(); ++i) {
+                TEST_CHECK(same(d.back(), ref.back()));
+                d.pop_back();
+                ref.pop_back();
+            }
+        } else if (!ref.empty()) {
+            size_t k = rng() % ref.size();
+            TEST_CHECK(same(d.read(k), ref[k]));
+            TEST_CHECK(same(d[k], ref[k]));
+        }
+        TEST_CHECK(d.size() == ref.size());
+        TEST_CHECK(d.resident_blocks() <= max_resident + 1);
+    }
+    for (size_t k = 0; k < ref.size(); ++k) {
+        TEST_CHECK(same(d.read(k), ref[k]));
+    }
+    d.clear();
+    TEST_CHECK(d.empty() && d.resident_blocks() == 0 && d.spilled_blocks() == 0);
+}
+
+struct page
+{
+    char bytes[4096];
+};
+
+static void test_spill_deque()
+{
+    for (unsigned seed = 1; seed <= 3; ++seed) {
+        spill_against_std<uint64_t>(seed, 1500);
+        spill_against_std<page>(seed, 1500);
+    }
+}
+
+
+int main()
+{
+    static const test_case tests[] = {
+        {"deque", test_deque},
+        {"deque_trivial", test_deque_trivial},
+        {"cow_deque", test_cow_deque},
+        {"spill_deque", test_spill_deque},
+    };
+    return run_tests(tests);
+}
@@ -0,0 +1,196 @@
+#include <iostream>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <fcntl.h>
+#include <unistd.h>
+#include "vector.hpp"
+#include "deque.hpp"
+#include "serialize.hpp"
+#include "test_check.hpp"
+
+// serialize / deserialize：往返一致、vector 与 deque 互读、截断与损坏的文件被拒绝且目标容器不变。
+// 文件写在 $TMPDIR（默认 /tmp）下，测试结束删除。
+
+struct record
+{
+    uint64_t key;
+    uint32_t value;
+    uint32_t flags;
+};
+
+static record make_record(size_t i)
+{
+    record r;
+    r.key = i * 2654435761u;
+    r.value = static_cast<uint32_t>(i);
+    r.flags = static_cast<uint32_t>(i ^ 0x5a5a);
+    return r;
+}
+
+static bool same(const record& a, const record& b)
+{
+    return a.key == b.key && a.value == b.value && a.flags == b.flags;
+}
+
+static std::string temp_path(const char* name)
+{
+    const char* tmp = std::getenv("TMPDIR");
+    std::string dir = (tmp != nullptr && *tmp != '\0') ? tmp : "/tmp";
+    return dir + "/stl_serialize_test_" + std::to_string(getpid()) + "_" + name;
+}
+
+static std::string read_bytes(const std::string& path)
+{
+    std::ifstream in(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+static void write_bytes(const std::string& path, const std::string& bytes)
+{
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+}
+
+//文件读失败时目标容器必须保持原样
+template <class C>
+static void check_rejected(const std::string& path)
+{
+    C target;
+    target.push_back(make_record(7));
+    TEST_THROWS(load_file(path, target), std::runtime_error);
+    TEST_CHECK(target.size() == 1 && same(target[0], make_record(7)));
+}
+
+static void test_round_trip()
+{
+    std::string path = temp_path("round_trip");
+    //0 个、不满一块、跨多块（deque 每块 512 个）
+    for (size_t n : {size_t(0), size_t(1), size_t(511), size_t(513), size_t(100000)}) {
+        vector<record> v;
+        deque<record> d;
+        for (size_t i = 0; i < n; ++i) {
+            v.push_back(make_record(i));
+            //deque 从头部也压一些，让第一块从中间开始
+            if (i % 2) {
+                d.push_back(make_record(i));
+            } else {
+                d.push_front(make_record(i));
+            }
+        }
+
+        save_file(path, v);
+        vector<record> v2;
+        load_file(path, v2);
+        deque<record> from_vector;
+        load_file(path, from_vector);
+        TEST_CHECK(v2.size() == n && from_vector.size() == n);
+        for (size_t i = 0; i < n; ++i) {
+            TEST_CHECK(same(v2[i], v[i]) && same(from_vector[i], v[i]));
+        }
+
+        save_file(path, d);
+        deque<record> d2;
+        load_file(path, d2);
+        vector<record> from_deque;
+        load_file(path, from_deque);
+        TEST_CHECK(d2.size() == n && from_deque.size() == n);
+        for (size_t i = 0; i < n; ++i) {
+            TEST_CHECK(same(d2[i], d[i]) && same(from_deque[i], d[i]));
+        }
+
+        //不带校验和同样能读回
+        serialize_options options;
+        options.checksum = false;
+        save_file(path, d, options);
+        vector<record> unchecked;
+        load_file(path, unchecked);
+        TEST_CHECK(unchecked.size() == n);
+    }
+    std::remove(path.c_str());
+}
+
+static void test_truncated()
+{
+    std::string path = temp_path("truncated");
+    vector<record> v;
+    for (size_t i = 0; i < 3000; ++i) {
+        v.push_back(make_record(i));
+    }
+    save_file(path, v);
+    std::string full = read_bytes(path);
+    //截在文件头内、刚好截掉文件头之后的全部数据、截掉最后一个字节
+    for (size_t keep : {size_t(0), size_t(10), sizeof(serial_header), sizeof(serial_header) + 100, full.size() - 1}) {
+        write_bytes(path, full.substr(0, keep));
+        check_rejected<vector<record> >(path);
+        check_rejected<deque<record> >(path);
+    }
+
+    //管道读不到文件大小，只能读到末尾才发现截断
+    std::string cut = full.substr(0, full.size() - sizeof(record) / 2);
+    int fds[2];
+    TEST_CHECK(pipe(fds) == 0);
+    size_t written = 0;
+    while (written < cut.size()) {
+        ssize_t n = write(fds[1], cut.data() + written, cut.size() - written);
+        TEST_CHECK(n > 0);
+        written += static_cast<size_t>(n);
+    }
+    close(fds[1]);
+    deque<record> target;
+    target.push_back(make_record(7));
+    TEST_THROWS(deserialize(fds[0], target), std::runtime_error);
+    close(fds[0]);
+    TEST_CHECK(target.size() == 1 && same(target[0], make_record(7)));
+    std::remove(path.c_str());
+}
+
+static void test_corrupted()
+{
+    std::string path = temp_path("corrupted");
+    deque<record> d;
+    for (size_t i = 0; i < 2000; ++i) {
+        d.push_back(make_record(i));
+    }
+    save_file(path, d);
+    std::string full = read_bytes(path);
+
+    //数据区任意位置翻转一位都应被校验和发现
+    for (size_t offset : {sizeof(serial_header), full.size() / 2, full.size() - 1}) {
+        std::string bad = full;
+        bad[offset] ^= 0x10;
+        write_bytes(path, bad);
+        check_rejected<vector<record> >(path);
+        check_rejected<deque<record> >(path);
+    }
+
+    //魔数错误
+    std::string bad_magic = full;
+    bad_magic[0] ^= 0xff;
+    write_bytes(path, bad_magic);
+    check_rejected<vector<record> >(path);
+
+    //元素大小不符
+    write_bytes(path, full);
+    vector<uint64_t> wrong_type;
+    TEST_THROWS(load_file(path, wrong_type), std::runtime_error);
+    TEST_CHECK(wrong_type.empty());
+
+    //文件不存在
+    std::remove(path.c_str());
+    check_rejected<deque<record> >(path);
+}
+
+
+int main()
+{
+    static const test_case tests[] = {
+        {"round_trip", test_round_trip},
+        {"truncated", test_truncated},
+        {"corrupted", test_corrupted},
+    };
+    return run_tests(tests);
+}
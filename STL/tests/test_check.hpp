@@ -0,0 +1,53 @@
+#pragma once
+#include<iostream>
+#include <stdexcept>
+#include <string>
+
+// 测试用的最小断言：失败时抛出异常，由 run_tests 打印位置并让进程返回非零，ctest 记为失败。
+//     TEST_CHECK(d.size() == ref.size());
+//     TEST_THROWS(d.at(d.size()), std::out_of_range);
+
+#define TEST_CHECK(cond)                                                                       \
+    do {                                                                                       \
+        if (!(cond)) {                                                                         \
+            throw std::logic_error(std::string(__FILE__) + ":" + std::to_string(__LINE__) +    \
+                                   ": check failed: " #cond);                                  \
+        }                                                                                      \
+    } while (0)
+
+#define TEST_THROWS(expr, exception)                                                           \
+    do {                                                                                       \
+        bool thrown = false;                                                                   \
+        try {                                                                                  \
+            expr;                                                                              \
+        } catch (const exception&) {                                                           \
+            thrown = true;                                                                     \
+        }                                                                                      \
+        if (!thrown) {                                                                         \
+            throw std::logic_error(std::string(__FILE__) + ":" + std::to_string(__LINE__) +    \
+                                   ": expected " #exception " from " #expr);                   \
+        }                                                                                      \
+    } while (0)
+
+struct test_case
+{
+    const char* name;
+    void (*run)();
+};
+
+//依次运行，全部通过返回 0
+template <size_t N>
+int run_tests(const test_case (&tests)[N])
+{
+    int failed = 0;
+    for (const test_case& t : tests) {
+        try {
+            t.run();
+            std::cout << "[ ok ] " << t.name << std::endl;
+        } catch (const std::exception& e) {
+            std::cout << "[FAIL] " << t.name << ": " << e.what() << std::endl;
+            ++failed;
+        }
+    }
+    return failed == 0 ? 0 : 1;
+}
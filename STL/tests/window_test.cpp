@@ -0,0 +1,231 @@
+#include <iostream>
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+#include "vector.hpp"
+#include "deque.hpp"
+#include "ring_buffer.hpp"
+#include "window_deque.hpp"
+#include "test_check.hpp"
+
+// ring_buffer 与 window_deque 与暴力模型对照：
+// ring_buffer 的模型是“只保留最后 capacity 个”的 std::vector，window_deque 的聚合值每次对整个窗口重新计算。
+
+template <class Ring>
+static void check_ring(const Ring& r, const std::vector<int>& ref)
+{
+    TEST_CHECK(r.size() == ref.size());
+    for (size_t i = 0; i < ref.size(); ++i) {
+        TEST_CHECK(r[i] == ref[i]);
+    }
+    //两段连续内存按时间顺序拼起来就是全部元素
+    auto s = r.spans();
+    TEST_CHECK(s.first_size + s.second_size == ref.size());
+    for (size_t i = 0; i < s.first_size; ++i) {
+        TEST_CHECK(s.first[i] == ref[i]);
+    }
+    for (size_t i = 0; i < s.second_size; ++i) {
+        TEST_CHECK(s.second[i] == ref[s.first_size + i]);
+    }
+    std::vector<int> out(ref.size() + 1);
+    TEST_CHECK(r.copy_to(out.data(), out.size()) == ref.size());
+    TEST_CHECK(std::equal(ref.begin(), ref.end(), out.begin()));
+    TEST_CHECK(std::equal(r.begin(), r.end(), ref.begin(), ref.end()));
+}
+
+template <class Ring>
+static void ring_against_model(Ring& r, unsigned seed)
+{
+    const size_t cap = r.capacity();
+    std::mt19937 rng(seed);
+    std::vector<int> ref;
+    auto push = [&ref, cap](int v) {
+        ref.push_back(v);
+        if (ref.size() > cap) {
+            ref.erase(ref.begin());
+        }
+    };
+    for (int step = 0; step < 20000; ++step) {
+        int op = rng() % 10;
+        int v = static_cast<int>(rng() % 100000);
+        if (op < 4) {
+            r.push_back(v);
+            push(v);
+        } else if (op < 5) {
+            TEST_CHECK(r.emplace_back(v) == v);
+            push(v);
+        } else if (op < 6) {
+            //批量写入，可能超过容量
+            std::vector<int> src(rng() % (2 * cap + 1));
+            for (int& x : src) {
+                x = static_cast<int>(rng() % 100000);
+            }
+            r.append(src.data(), src.size());
+            for (int x : src) {
+                push(x);
+            }
+        } else if (op < 7) {
+            if (!ref.empty()) {
+                TEST_CHECK(r.front() == ref.front());
+                r.pop_front();
+                ref.erase(ref.begin());
+            }
+        } else if (op < 8) {
+            if (!ref.empty()) {
+                TEST_CHECK(r.back() == ref.back());
+                r.pop_back();
+                ref.pop_back();
+            }
+        } else if (op < 9) {
+            size_t n = ref.empty() ? 0 : rng() % (ref.size() + 1);
+            r.pop_front(n);
+            ref.erase(ref.begin(), ref.begin() + n);
+        } else if (rng() % 50 == 0) {
+            r.clear();
+            ref.clear();
+        }
+        TEST_CHECK(r.size() == ref.size());
+        TEST_CHECK(r.full() == (ref.size() == cap));
+        if (step % 97 == 0) {
+            check_ring(r, ref);
+        }
+    }
+    check_ring(r, ref);
+    TEST_THROWS(r.pop_front(r.size() + 1), std::out_of_range);
+    TEST_THROWS(r.at(r.size()), std::out_of_range);
+
+    //拷贝和移动之后内容不变
+    Ring copy(r);
+    check_ring(copy, ref);
+    Ring moved(std::move(copy));
+    check_ring(moved, ref);
+}
+
+static void test_ring_buffer()
+{
+    ring_buffer<int, 16> fixed;
+    ring_against_model(fixed, 1);
+    //运行时容量向上取整到 2 的幂
+    ring_buffer<int> dynamic(100);
+    TEST_CHECK(dynamic.capacity() == 128);
+    ring_against_model(dynamic, 2);
+
+    ring_buffer<int> empty;
+    TEST_CHECK(empty.capacity() == 0);
+    TEST_THROWS(empty.push_back(1), std::length_error);
+}
+
+//非平凡元素：覆盖和弹出时正确析构
+static void test_ring_buffer_strings()
+{
+    ring_buffer<std::string, 8> r;
+    for (int i = 0; i < 100; ++i) {
+        r.push_back(std::string(40, static_cast<char>('a' + i % 26)));
+    }
+    TEST_CHECK(r.size() == 8);
+    for (size_t i = 0; i < r.size(); ++i) {
+        TEST_CHECK(r[i] == std::string(40, static_cast<char>('a' + (92 + i) % 26)));
+    }
+}
+
+//window_deque：任意时刻的聚合值等于对窗口内全部元素重新计算的结果
+static void test_window_deque()
+{
+    for (size_t capacity : {size_t(0), size_t(1), size_t(7), size_t(100)}) {
+        std::mt19937 rng(static_cast<unsigned>(capacity) + 3);
+        window_deque<int64_t, window_min<int64_t> > wmin(capacity);
+        window_deque<int64_t, window_max<int64_t> > wmax(capacity);
+        window_deque<int64_t, window_stats<int64_t> > wstats(capacity);
+        std::vector<int64_t> ref;
+        for (int step = 0; step < 20000; ++step) {
+            int op = rng() % 10;
+            if (op < 6 || ref.empty()) {
+                int64_t v = static_cast<int64_t>(rng() % 2001) - 1000;
+                wmin.push_back(v);
+                wmax.push_back(v);
+                wstats.push_back(v);
+                ref.push_back(v);
+                if (capacity != 0 && ref.size() > capacity) {
+                    ref.erase(ref.begin());
+                }
+            } else if (op < 9) {
+                wmin.pop_front();
+                wmax.pop_front();
+                wstats.pop_front();
+                ref.erase(ref.begin());
+            } else {
+                //按值淘汰头部
+                int64_t limit = static_cast<int64_t>(rng() % 2001) - 1000;
+                auto below = [limit](int64_t x) { return x < limit; };
+                size_t n = 0;
+                while (n < ref.size() && below(ref[n])) {
+                    ++n;
+                }
+                TEST_CHECK(wmin.evict_while(below) == n);
+                wmax.evict_while(below);
+                wstats.evict_while(below);
+                ref.erase(ref.begin(), ref.begin() + n);
+            }
+            TEST_CHECK(wmin.size() == ref.size() && wstats.size() == ref.size());
+            if (ref.empty()) {
+                TEST_THROWS(wmin.aggregate(), std::out_of_range);
+                continue;
+            }
+            int64_t lo = *std::min_element(ref.begin(), ref.end());
+            int64_t hi = *std::max_element(ref.begin(), ref.end());
+            int64_t sum = 0;
+            for (int64_t x : ref) {
+                sum += x;
+            }
+            TEST_CHECK(wmin.aggregate() == lo);
+            TEST_CHECK(wmax.aggregate() == hi);
+            auto s = wstats.aggregate();
+            TEST_CHECK(s.min == lo && s.max == hi && s.sum == sum && s.count == ref.size());
+            TEST_CHECK(wmin.front() == ref.front() && wmin.back() == ref.back());
+        }
+    }
+}
+
+//不满足交换律的聚合：按顺序拼接字符串
+struct window_concat
+{
+    typedef std::string value_type;
+    static value_type lift(const char& c) { return std::string(1, c); }
+    static value_type combine(const value_type& a, const value_type& b) { return a + b; }
+};
+
+static void test_window_order()
+{
+    window_deque<char, window_concat> w(5);
+    std::string ref;
+    for (int i = 0; i < 200; ++i) {
+        char c = static_cast<char>('a' + (i * 7) % 26);
+        w.push_back(c);
+        ref.push_back(c);
+        if (ref.size() > 5) {
+            ref.erase(ref.begin());
+        }
+        if (i % 3 == 0) {
+            w.pop_front();
+            ref.erase(ref.begin());
+        }
+        TEST_CHECK(ref.empty() ? w.empty() : w.aggregate() == ref);
+    }
+    w.set_capacity(2);
+    TEST_CHECK(w.size() <= 2);
+    TEST_CHECK(w.empty() || w.aggregate() == ref.substr(ref.size() - w.size()));
+}
+
+
+int main()
+{
+    static const test_case tests[] = {
+        {"ring_buffer", test_ring_buffer},
+        {"ring_buffer_strings", test_ring_buffer_strings},
+        {"window_deque", test_window_deque},
+        {"window_order", test_window_order},
+    };
+    return run_tests(tests);
+}